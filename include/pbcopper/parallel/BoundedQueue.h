@@ -0,0 +1,263 @@
+#ifndef PBCOPPER_PARALLEL_BOUNDEDQUEUE_H
+#define PBCOPPER_PARALLEL_BOUNDEDQUEUE_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <pbcopper/parallel/internal/EventCount.h>
+
+namespace PacBio {
+namespace Parallel {
+namespace internal {
+
+inline void CpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+}  // namespace internal
+
+///
+/// Lock-free bounded multi-producer multi-consumer FIFO queue.
+///
+/// The queue is a ring buffer of 'capacity' cells, rounded up to a power of
+/// two. Every cell carries a sequence number telling producers and consumers
+/// whose turn it is, so that pushing or popping costs one CAS on the shared
+/// position and never takes a lock (D. Vyukov's bounded MPMC queue).
+///
+/// Blocking and timed operations spin briefly, then park the calling thread
+/// on an EventCount; notifying is free while nobody is parked.
+///
+/// Close() makes all further pushes fail, while pops drain the remaining
+/// items. Items pushed concurrently with Close() may or may not be accepted.
+///
+/// T must be default-constructible and move-assignable.
+///
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(const size_t capacity)
+        : mask_{RoundUpToPowerOfTwo(capacity) - 1}, cells_{new Cell[mask_ + 1]}
+    {
+        for (size_t i = 0; i <= mask_; ++i)
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    ~BoundedQueue()
+    {
+        T item;
+        while (TryPop(item)) {
+        }
+    }
+
+    /// \returns maximum number of items in the queue
+    size_t Capacity() const { return mask_ + 1; }
+
+    /// \returns number of items in the queue, which may be outdated as soon
+    ///          as it is returned
+    size_t Size() const
+    {
+        const size_t tail = dequeuePos_.load(std::memory_order_relaxed);
+        const size_t head = enqueuePos_.load(std::memory_order_relaxed);
+        return (head > tail) ? (head - tail) : 0;
+    }
+
+    ///
+    /// Appends 'item' if there is a free cell; 'item' is left untouched
+    /// otherwise.
+    ///
+    /// \returns false if the queue is full or closed
+    ///
+    template <typename U>
+    bool TryPush(U&& item)
+    {
+        if (closed_.load(std::memory_order_acquire)) return false;
+
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            const size_t seq = cell->seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;  // the cell still holds an item from one lap ago
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        ::new (static_cast<void*>(&cell->storage)) T(std::forward<U>(item));
+        cell->seq.store(pos + 1, std::memory_order_release);
+        notEmpty_.NotifyOne();
+        return true;
+    }
+
+    ///
+    /// Moves the oldest item into 'item', if there is one.
+    ///
+    /// \returns false if the queue is empty
+    ///
+    bool TryPop(T& item)
+    {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & mask_];
+            const size_t seq = cell->seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;  // the cell has not been written in this lap yet
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        T* stored = reinterpret_cast<T*>(&cell->storage);
+        item = std::move(*stored);
+        stored->~T();
+        cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+        notFull_.NotifyOne();
+        return true;
+    }
+
+    ///
+    /// Appends 'item', blocking while the queue is full.
+    ///
+    /// \returns false if the queue is closed
+    ///
+    bool Push(T item)
+    {
+        return Await(notFull_, [&item, this]() { return TryPush(std::move(item)); }, nullptr);
+    }
+
+    ///
+    /// Pops the oldest item, blocking while the queue is empty.
+    ///
+    /// \returns false if the queue is closed and all items have been popped
+    ///
+    bool Pop(T& item)
+    {
+        return Await(notEmpty_, [&item, this]() { return TryPop(item); }, nullptr);
+    }
+
+    ///
+    /// Like Push, but gives up after 'timeout'.
+    ///
+    /// \returns false if the queue is closed or still full after 'timeout';
+    ///          'item' is left untouched in that case
+    ///
+    template <typename U, typename Rep, typename Period>
+    bool TryPushFor(U&& item, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        return Await(notFull_, [&item, this]() { return TryPush(std::forward<U>(item)); },
+                     &deadline);
+    }
+
+    ///
+    /// Like Pop, but gives up after 'timeout'.
+    ///
+    /// \returns false if the queue is still empty after 'timeout', or closed
+    ///          and drained
+    ///
+    template <typename Rep, typename Period>
+    bool TryPopFor(T& item, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        return Await(notEmpty_, [&item, this]() { return TryPop(item); }, &deadline);
+    }
+
+    /// Rejects all further pushes and wakes all blocked threads.
+    void Close()
+    {
+        closed_.store(true, std::memory_order_release);
+        notEmpty_.NotifyAll();
+        notFull_.NotifyAll();
+    }
+
+    bool IsClosed() const { return closed_.load(std::memory_order_acquire); }
+
+private:
+    // Number of attempts before a blocking operation parks the thread
+    static constexpr int SpinCount = 64;
+    static constexpr size_t CacheLineSize = 64;
+
+    struct Cell
+    {
+        std::atomic<size_t> seq;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    static size_t RoundUpToPowerOfTwo(const size_t n)
+    {
+        size_t result = 2;
+        while (result < n)
+            result <<= 1;
+        return result;
+    }
+
+    template <typename Attempt>
+    bool Await(internal::EventCount& event, Attempt attempt,
+               const std::chrono::steady_clock::time_point* deadline)
+    {
+        for (int spin = 0; spin < SpinCount; ++spin) {
+            if (attempt()) return true;
+            if (IsClosed()) return false;
+            internal::CpuRelax();
+        }
+
+        while (true) {
+            const auto key = event.PrepareWait();
+            if (attempt()) {
+                event.CancelWait();
+                return true;
+            }
+            if (IsClosed()) {
+                event.CancelWait();
+                return false;
+            }
+            if (deadline) {
+                if (!event.WaitUntil(key, *deadline)) return attempt();
+            } else {
+                event.Wait(key);
+            }
+        }
+    }
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    // Keep producers and consumers apart from each other's cache line
+    char pad0_[CacheLineSize];
+    std::atomic<size_t> enqueuePos_{0};
+    char pad1_[CacheLineSize - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> dequeuePos_{0};
+    char pad2_[CacheLineSize - sizeof(std::atomic<size_t>)];
+    std::atomic_bool closed_{false};
+    internal::EventCount notEmpty_;
+    internal::EventCount notFull_;
+};
+
+}  // namespace Parallel
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PARALLEL_BOUNDEDQUEUE_H
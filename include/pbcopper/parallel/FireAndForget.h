@@ -6,125 +6,198 @@
 #include <pbcopper/PbcopperConfig.h>
 
 #include <atomic>
-#include <condition_variable>
 #include <cstddef>
 #include <exception>
-#include <future>
+#include <memory>
 #include <mutex>
-#include <queue>
 
-#include <boost/optional.hpp>
+#include <pbcopper/parallel/BoundedQueue.h>
+#include <pbcopper/parallel/QueueMetrics.h>
+#include <pbcopper/parallel/Task.h>
+#include <pbcopper/parallel/ThreadPool.h>
+#include <pbcopper/parallel/internal/EventCount.h>
+#include <pbcopper/parallel/internal/RunnerGroup.h>
 
 namespace PacBio {
 namespace Parallel {
 
+///
+/// Executes tasks on a ThreadPool, either its own pool of 'size' threads, or
+/// a shared pool, e.g. SharedThreadPool(), of which it occupies at most
+/// 'maxConcurrency' workers at a time.
+///
+/// At most 'size * mul' tasks are in flight; ProduceWith blocks until a slot
+/// frees up. Tasks are started in submission order. The first exception
+/// thrown by a task aborts the queue: pending tasks are skipped, and the
+/// exception is rethrown by the next ProduceWith or by Finalize.
+///
+/// Call EnableMetrics() before producing to collect QueueMetrics.
+///
 class FireAndForget
 {
-private:
-    typedef boost::optional<std::packaged_task<void()>> TTask;
-
 public:
     FireAndForget(const size_t size, const size_t mul = 2)
-        : exc{nullptr}, sz{size * mul}, abort{false}
+        : FireAndForget{std::make_unique<ThreadPool>(size), nullptr, size, mul}
+    {
+    }
+
+    FireAndForget(ThreadPool& pool, const size_t maxConcurrency, const size_t mul = 2)
+        : FireAndForget{nullptr, &pool, maxConcurrency, mul}
     {
-        for (size_t i = 0; i < size; ++i) {
-            threads.emplace_back(std::thread([this]() {
-                // Get the first task per thread
-                TTask task = PopTask();
-                do {
-                    try {
-                        // Check if queue should be aborted and
-                        // if there is a task
-                        if (!abort && task) {
-                            // Execute task
-                            (*task)();
-                            // Check for the return value / exception
-                            task->get_future().get();
-                        };
-                    } catch (...) {
-                        std::lock_guard<std::mutex> g(m);
-                        // If there is an exception, signal to abort queue
-                        abort = true;
-                        // And store exception
-                        exc = std::current_exception();
-                        popped.notify_one();
-                    }
-                    task = PopTask();
-                } while (!abort && task);  // Stop if there are no tasks or abort has been signaled
-            }));
-        }
     }
 
     template <typename F, typename... Args>
     void ProduceWith(F&& f, Args&&... args)
     {
-        std::packaged_task<void()> task{std::bind(std::forward<F>(f), std::forward<Args>(args)...)};
-
-        {
-            std::unique_lock<std::mutex> lk(m);
-            popped.wait(lk, [&task, this]() {
-                if (exc) std::rethrow_exception(exc);
-
-                if (head.size() < sz) {
-                    head.emplace(std::move(task));
-                    return true;
-                }
+        Push(TTask{internal::Bind(std::forward<F>(f), std::forward<Args>(args)...)});
+    }
 
-                return false;
-            });
-        }
-        pushed.notify_one();
+    ///
+    /// Starts collecting metrics, one worker per concurrently running task.
+    /// Must be called before the first task is produced.
+    ///
+    QueueMetrics& EnableMetrics()
+    {
+        if (!metrics) metrics = std::make_unique<QueueMetrics>(runners.Limit());
+        return *metrics;
     }
 
+    /// \returns metrics, or nullptr if EnableMetrics() has not been called
+    const QueueMetrics* Metrics() const { return metrics.get(); }
+
     void Finalize()
     {
-        {
-            std::lock_guard<std::mutex> g(m);
-            // Push boost::none to signal that there are no further tasks
-            head.emplace(boost::none);
-        }
-        // Let all workers know that they should look that there is no further work
-        pushed.notify_all();
-
-        // Wait for all threads to join and do not continue before all tasks
-        // have been finished.
-        for (auto& thread : threads)
-            thread.join();
+        // Do not continue before all tasks have been finished.
+        WaitFor([this]() { return inFlight == 0; });
 
         // Is there a final exception, throw if so..
-        if (exc) std::rethrow_exception(exc);
+        RethrowIfAborted();
     }
 
 private:
-    TTask PopTask()
+    using TTask = Task<void()>;
+
+    struct Item
     {
-        TTask task(boost::none);
+        TTask task;
+        // Only set with metrics enabled
+        QueueMetrics::Clock::time_point produced;
+    };
+
+    FireAndForget(std::unique_ptr<ThreadPool> ownPool, ThreadPool* sharedPool, const size_t size,
+                  const size_t mul)
+        : ownedPool{std::move(ownPool)}
+        , exc{nullptr}
+        , sz{size * mul}
+        , abort{false}
+        , inFlight{0}
+        , pending{size * mul}
+        , runners{ownedPool ? *ownedPool : *sharedPool, size,
+                  [this](const size_t slot) { Drain(slot); }}
+    {
+    }
 
-        {
-            std::unique_lock<std::mutex> lk(m);
-            pushed.wait(lk, [&task, this]() {
-                if (head.empty()) return false;
+    // Runs queued tasks on a worker of the pool, until there are none left
+    void Drain(const size_t slot)
+    {
+        Item item;
+        while (pending.TryPop(item)) {
+            runners.Taken();
+            Execute(item.task, slot, item.produced);
+            item.task = nullptr;
+        }
+    }
 
-                if ((task = std::move(head.front()))) {
-                    head.pop();
-                }
+    // Queues a task, once fewer than 'size * mul' are in flight
+    void Push(TTask task)
+    {
+        const auto start = metrics ? QueueMetrics::Clock::now() : QueueMetrics::Clock::time_point{};
+        if (!AcquireSlot()) RethrowIfAborted();
+        if (metrics) {
+            metrics->ProducerBlocked(QueueMetrics::Clock::now() - start);
+            metrics->Queued(pending.Size());
+        }
+        pending.Push(Item{std::move(task), start});
+        runners.Added();
+    }
+
+    // Runs a task, unless the queue has been aborted, and releases its slot
+    template <typename F>
+    void Execute(F&& f, const size_t worker, const QueueMetrics::Clock::time_point produced)
+    {
+        const auto start = metrics ? QueueMetrics::Clock::now() : QueueMetrics::Clock::time_point{};
+        try {
+            // Check if queue should be aborted
+            if (!abort) f();
+        } catch (...) {
+            std::lock_guard<std::mutex> g(m);
+            // If there is an exception, store it and signal to abort queue
+            exc = std::current_exception();
+            abort = true;
+        }
+        // Record before releasing, so that metrics are complete after Finalize
+        if (metrics) {
+            const auto end = QueueMetrics::Clock::now();
+            metrics->TaskFinished(worker, end - produced, end - start);
+        }
+        ReleaseSlot();
+    }
 
-                return true;
-            });
+    void RethrowIfAborted()
+    {
+        if (abort) {
+            std::lock_guard<std::mutex> g(m);
+            std::rethrow_exception(exc);
         }
-        popped.notify_one();
+    }
+
+    // \returns false if the queue has been aborted instead
+    bool AcquireSlot()
+    {
+        bool acquired = false;
+        WaitFor([&acquired, this]() {
+            if (abort) return true;
+            size_t n = inFlight;
+            while (n < sz) {
+                if (inFlight.compare_exchange_weak(n, n + 1)) return (acquired = true);
+            }
+            return false;
+        });
+        return acquired;
+    }
 
-        return task;
+    void ReleaseSlot()
+    {
+        --inFlight;
+        // Wake a blocked ProduceWith or Finalize
+        released.NotifyAll();
+    }
+
+    template <typename Pred>
+    void WaitFor(Pred pred)
+    {
+        while (!pred()) {
+            const auto key = released.PrepareWait();
+            if (pred()) {
+                released.CancelWait();
+                return;
+            }
+            released.Wait(key);
+        }
     }
 
-    std::vector<std::thread> threads;
-    std::queue<TTask> head;
-    std::condition_variable popped;
-    std::condition_variable pushed;
+    // Destroyed last, after all runners have finished
+    std::unique_ptr<ThreadPool> ownedPool;
     std::exception_ptr exc;
     std::mutex m;
     size_t sz;
     std::atomic_bool abort;
+    std::atomic<size_t> inFlight;
+    internal::EventCount released;
+    BoundedQueue<Item> pending;
+    std::unique_ptr<QueueMetrics> metrics;
+    // Destroyed first, waiting for active runners to access the members above
+    internal::RunnerGroup runners;
 };
 
 }  // namespace Parallel
@@ -5,15 +5,20 @@
 
 #include <pbcopper/PbcopperConfig.h>
 
-#include <condition_variable>
+#include <atomic>
 #include <cstddef>
 #include <exception>
 #include <functional>
-#include <future>
+#include <memory>
 #include <mutex>
-#include <queue>
 
-#include <boost/optional.hpp>
+#include <pbcopper/parallel/BoundedQueue.h>
+#include <pbcopper/parallel/QueueMetrics.h>
+#include <pbcopper/parallel/Task.h>
+#include <pbcopper/parallel/ThreadPlacement.h>
+#include <pbcopper/parallel/ThreadPool.h>
+#include <pbcopper/parallel/internal/EventCount.h>
+#include <pbcopper/parallel/internal/RunnerGroup.h>
 
 namespace PacBio {
 namespace Parallel {
@@ -22,141 +27,218 @@ namespace Parallel {
  Differences from normal FireAndForget:
 
  * ProduceWith expects a function taking Index followed by user-defined Args.
- * The Index is from 0 to size-1.
- * Each thread knows its own Index.
+ * The Index is from 0 to size-1, or to maxConcurrency-1 on a shared pool.
+ * Tasks running at the same time always have distinct Indices.
  * As a result, each task can use its Index to look into a predefined vector (user-controlled).
- * A 'finish' function is called for each thread after Finalize() pushes the sentinel onto the queue.
- 
+ * A 'finish' function is called for each Index once Finalize() has seen all tasks complete.
+
  The 'finish' function is not really needed, but it's helpful for debugging. Or
  to summarize results / close output streams.
 
  Caution: If an exception is thrown by your task, the 'finish' function is not called!
+
+ With a ThreadPlacement, worker i is pinned to a CPU and always runs the tasks
+ with Index i. An 'init' function is called for each Index on its pinned worker
+ before any task runs; memory allocated there, e.g. per-Index scratch buffers,
+ is first touched and thus placed on that worker's local NUMA node.
+
+ Call EnableMetrics() before producing to collect QueueMetrics, with one
+ worker per Index.
 */
 class FireAndForgetIndexed
 {
 public:
     using Index = size_t;
     using TFunc = std::function<void(Index)>;
-    using TPTask = std::packaged_task<void(Index)>;
 
 public:
     FireAndForgetIndexed(const size_t size, const size_t mul = 2,
                          TFunc finish = TFunc{[](Index) {}})
-        : exc{nullptr}, sz{size * mul}, abort{false}
+        : FireAndForgetIndexed{std::make_unique<ThreadPool>(size), nullptr, size, mul,
+                               std::move(finish)}
+    {
+    }
+
+    FireAndForgetIndexed(const size_t size, const ThreadPlacement& placement,
+                         const TFunc& init = TFunc{}, const size_t mul = 2,
+                         TFunc finish = TFunc{[](Index) {}})
+        : FireAndForgetIndexed{std::make_unique<ThreadPool>(size, placement, init), nullptr, size,
+                               mul, std::move(finish)}
+    {
+    }
+
+    FireAndForgetIndexed(ThreadPool& pool, const size_t maxConcurrency, const size_t mul = 2,
+                         TFunc finish = TFunc{[](Index) {}})
+        : FireAndForgetIndexed{nullptr, &pool, maxConcurrency, mul, std::move(finish)}
     {
-        for (Index index = 0; index < size; ++index) {
-            threads.emplace_back(std::thread([this, finish, index]() {
-                // Get the first task per thread
-                TTask task = PopTask();
-                do {
-                    try {
-                        // Check if queue should be aborted and
-                        // if there is a task
-                        if (!abort && task) {
-                            // Execute task
-                            (*task)(index);
-                            // Check for the return value / exception
-                            task->get_future().get();
-                        };
-                    } catch (...) {
-                        std::lock_guard<std::mutex> g(m);
-                        // If there is an exception, signal to abort queue
-                        abort = true;
-                        // And store exception
-                        exc = std::current_exception();
-                        popped.notify_one();
-                    }
-                    task = PopTask();
-                } while (!abort && task);  // Stop if there are no tasks or abort has been signaled
-                try {
-                    if (!abort) finish(index);
-                } catch (...) {
-                    std::lock_guard<std::mutex> g(m);
-                    // If there is an exception, signal to abort queue
-                    abort = true;
-                    // And store exception
-                    exc = std::current_exception();
-                }
-            }));
-        }
     }
 
     template <typename F, typename... Args>
     void ProduceWith(F&& f, Args&&... args)
     {
-        using namespace std::placeholders;  // for _1, _2, _3...
-
         // Create a function taking Index, which delegates to
         // a function taking Index followed by args.
-        TPTask task{std::bind(std::forward<F>(f), _1, std::forward<Args>(args)...)};
-
-        {
-            std::unique_lock<std::mutex> lk(m);
-            popped.wait(lk, [&task, this]() {
-                if (exc) std::rethrow_exception(exc);
-
-                if (head.size() < sz) {
-                    head.emplace(std::move(task));
-                    return true;
-                }
+        TTask task{internal::Bind(std::forward<F>(f), std::forward<Args>(args)...)};
+        Push(std::move(task));
+    }
 
-                return false;
-            });
-        }
-        pushed.notify_one();
+    ///
+    /// Starts collecting metrics, one worker per concurrently running task.
+    /// Must be called before the first task is produced.
+    ///
+    QueueMetrics& EnableMetrics()
+    {
+        if (!metrics) metrics = std::make_unique<QueueMetrics>(runners.Limit());
+        return *metrics;
     }
 
+    /// \returns metrics, or nullptr if EnableMetrics() has not been called
+    const QueueMetrics* Metrics() const { return metrics.get(); }
+
     void Finalize()
     {
-        {
-            std::lock_guard<std::mutex> g(m);
-            // Push boost::none to signal that there are no further tasks
-            head.emplace(boost::none);
-        }
-        // Let all workers know that they should look that there is no further work
-        pushed.notify_all();
-
-        // Wait for all threads to join and do not continue before all tasks
-        // have been finishshed.
-        for (auto& thread : threads)
-            thread.join();
+        // Do not continue before all tasks have been finished.
+        WaitFor([this]() { return inFlight == 0; });
 
         // Is there a final exception, throw if so..
-        if (exc) std::rethrow_exception(exc);
+        RethrowIfAborted();
+
+        // Once all tasks are done, call 'finish' once per Index
+        for (Index index = 0; index < runners.Limit(); ++index)
+            finishFunc(index);
     }
 
 private:
-    using TTask = boost::optional<TPTask>;
+    using TTask = Task<void(Index)>;
+
+    struct Item
+    {
+        TTask task;
+        // Only set with metrics enabled
+        QueueMetrics::Clock::time_point produced;
+    };
+
+    FireAndForgetIndexed(std::unique_ptr<ThreadPool> ownPool, ThreadPool* sharedPool,
+                         const size_t size, const size_t mul, TFunc finish)
+        : ownedPool{std::move(ownPool)}
+        , finishFunc{std::move(finish)}
+        , exc{nullptr}
+        , sz{size * mul}
+        , abort{false}
+        , inFlight{0}
+        , pending{size * mul}
+        , runners{ownedPool ? *ownedPool : *sharedPool, size,
+                  [this](const size_t slot) { Drain(slot); }}
+    {
+    }
 
-    TTask PopTask()
+    // Runs queued tasks on a worker of the pool, until there are none left.
+    // 'slot' is the runner's slot, unique among all active runners. On an
+    // owned pool, which runs nothing but these runners, the worker index is
+    // just as unique and keeps every Index on the same (pinned) thread.
+    void Drain(const size_t slot)
     {
-        TTask task(boost::none);
+        const Index index = ownedPool ? ownedPool->CurrentWorkerIndex() : slot;
+        Item item;
+        while (pending.TryPop(item)) {
+            runners.Taken();
+            auto& task = item.task;
+            Execute([&task, index]() { task(index); }, index, item.produced);
+            task = nullptr;
+        }
+    }
 
-        {
-            std::unique_lock<std::mutex> lk(m);
-            pushed.wait(lk, [&task, this]() {
-                if (head.empty()) return false;
+    // Queues a task, once fewer than 'size * mul' are in flight
+    void Push(TTask task)
+    {
+        const auto start = metrics ? QueueMetrics::Clock::now() : QueueMetrics::Clock::time_point{};
+        if (!AcquireSlot()) RethrowIfAborted();
+        if (metrics) {
+            metrics->ProducerBlocked(QueueMetrics::Clock::now() - start);
+            metrics->Queued(pending.Size());
+        }
+        pending.Push(Item{std::move(task), start});
+        runners.Added();
+    }
 
-                if ((task = std::move(head.front()))) {
-                    head.pop();
-                }
+    // Runs a task, unless the queue has been aborted, and releases its slot
+    template <typename F>
+    void Execute(F&& f, const size_t worker, const QueueMetrics::Clock::time_point produced)
+    {
+        const auto start = metrics ? QueueMetrics::Clock::now() : QueueMetrics::Clock::time_point{};
+        try {
+            // Check if queue should be aborted
+            if (!abort) f();
+        } catch (...) {
+            std::lock_guard<std::mutex> g(m);
+            // If there is an exception, store it and signal to abort queue
+            exc = std::current_exception();
+            abort = true;
+        }
+        // Record before releasing, so that metrics are complete after Finalize
+        if (metrics) {
+            const auto end = QueueMetrics::Clock::now();
+            metrics->TaskFinished(worker, end - produced, end - start);
+        }
+        ReleaseSlot();
+    }
 
-                return true;
-            });
+    void RethrowIfAborted()
+    {
+        if (abort) {
+            std::lock_guard<std::mutex> g(m);
+            std::rethrow_exception(exc);
         }
-        popped.notify_one();
+    }
+
+    // \returns false if the queue has been aborted instead
+    bool AcquireSlot()
+    {
+        bool acquired = false;
+        WaitFor([&acquired, this]() {
+            if (abort) return true;
+            size_t n = inFlight;
+            while (n < sz) {
+                if (inFlight.compare_exchange_weak(n, n + 1)) return (acquired = true);
+            }
+            return false;
+        });
+        return acquired;
+    }
+
+    void ReleaseSlot()
+    {
+        --inFlight;
+        // Wake a blocked ProduceWith or Finalize
+        released.NotifyAll();
+    }
 
-        return task;
+    template <typename Pred>
+    void WaitFor(Pred pred)
+    {
+        while (!pred()) {
+            const auto key = released.PrepareWait();
+            if (pred()) {
+                released.CancelWait();
+                return;
+            }
+            released.Wait(key);
+        }
     }
 
-    std::vector<std::thread> threads;
-    std::queue<TTask> head;
-    std::condition_variable popped;
-    std::condition_variable pushed;
+    // Destroyed last, after all runners have finished
+    std::unique_ptr<ThreadPool> ownedPool;
+    TFunc finishFunc;
     std::exception_ptr exc;
     std::mutex m;
     size_t sz;
     std::atomic_bool abort;
+    std::atomic<size_t> inFlight;
+    internal::EventCount released;
+    BoundedQueue<Item> pending;
+    std::unique_ptr<QueueMetrics> metrics;
+    // Destroyed first, waiting for active runners to access the members above
+    internal::RunnerGroup runners;
 };
 
 }  // namespace Parallel
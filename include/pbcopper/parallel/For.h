@@ -0,0 +1,167 @@
+#ifndef PBCOPPER_PARALLEL_FOR_H
+#define PBCOPPER_PARALLEL_FOR_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <pbcopper/parallel/ThreadPool.h>
+#include <pbcopper/parallel/internal/EventCount.h>
+
+namespace PacBio {
+namespace Parallel {
+namespace internal {
+
+// Shared by the calling thread and the helper tasks of one fork-join call;
+// helpers that start after all chunks have been claimed only touch this.
+struct ForkJoinState
+{
+    explicit ForkJoinState(const size_t n) : numChunks{n} {}
+
+    const size_t numChunks;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    std::atomic_bool abort{false};
+    std::mutex m;
+    std::exception_ptr exc;
+    EventCount finished;
+};
+
+///
+/// Calls 'f(chunk)' for every chunk in [0, numChunks). Chunks are claimed
+/// dynamically by the calling thread and by up to NumThreads() helper tasks
+/// on 'pool'. While waiting for chunks claimed by others, the caller runs
+/// other tasks of the pool; as every caller can process all remaining chunks
+/// on its own, nested calls cannot deadlock, even on a pool of one thread.
+///
+/// The first exception thrown by 'f' skips all chunks not yet started and is
+/// rethrown once the claimed chunks have finished.
+///
+template <typename F>
+void ForEachChunk(ThreadPool& pool, const size_t numChunks, F& f)
+{
+    if (numChunks == 0) return;
+
+    auto state = std::make_shared<ForkJoinState>(numChunks);
+
+    // 'f' is only dereferenced for a successfully claimed chunk, which
+    // implies that the calling thread is still waiting below
+    auto work = [state, &f]() {
+        size_t chunk;
+        while ((chunk = state->next.fetch_add(1)) < state->numChunks) {
+            if (!state->abort) {
+                try {
+                    f(chunk);
+                } catch (...) {
+                    std::lock_guard<std::mutex> g(state->m);
+                    if (!state->exc) state->exc = std::current_exception();
+                    state->abort = true;
+                }
+            }
+            if (state->done.fetch_add(1) + 1 == state->numChunks) state->finished.NotifyAll();
+        }
+    };
+
+    const size_t numHelpers = std::min(pool.NumThreads(), numChunks - 1);
+    for (size_t i = 0; i < numHelpers; ++i)
+        pool.Submit(work);
+    work();
+
+    while (state->done < numChunks) {
+        if (pool.TryRunOne()) continue;
+
+        const auto key = state->finished.PrepareWait();
+        if (state->done == numChunks) {
+            state->finished.CancelWait();
+            break;
+        }
+        state->finished.Wait(key);
+    }
+
+    if (state->abort) std::rethrow_exception(state->exc);
+}
+
+// \returns number of indices per chunk, choosing a grain size that gives
+//          every thread several chunks if 'grain' is 0
+inline size_t GrainSize(const ThreadPool& pool, const size_t size, const size_t grain)
+{
+    if (grain > 0) return grain;
+    const size_t targetChunks = 8 * (pool.NumThreads() + 1);
+    return std::max<size_t>(1, size / targetChunks);
+}
+
+}  // namespace internal
+
+///
+/// Calls 'f(i)' for every i in [begin, end), distributing chunks of 'grain'
+/// consecutive indices over the calling thread and the workers of 'pool'.
+/// A grain of 0 picks a grain size automatically.
+///
+/// May be nested, i.e. called from within 'f' or any other task of 'pool'.
+/// The first exception thrown by 'f' is rethrown, after all chunks that have
+/// already started have finished.
+///
+template <typename F>
+void For(ThreadPool& pool, const size_t begin, const size_t end, const size_t grain, F&& f)
+{
+    if (begin >= end) return;
+
+    const size_t size = end - begin;
+    const size_t chunkSize = internal::GrainSize(pool, size, grain);
+    const size_t numChunks = (size + chunkSize - 1) / chunkSize;
+
+    auto chunkFunc = [&f, begin, end, chunkSize](const size_t chunk) {
+        const size_t first = begin + chunk * chunkSize;
+        const size_t last = std::min(end, first + chunkSize);
+        for (size_t i = first; i < last; ++i)
+            f(i);
+    };
+    internal::ForEachChunk(pool, numChunks, chunkFunc);
+}
+
+///
+/// Computes 'combine(...combine(combine(identity, map(begin)), map(begin + 1))...,
+/// map(end - 1))' in parallel. Every chunk of 'grain' indices is reduced on
+/// its own, then the partial results are combined in index order; 'combine'
+/// must therefore be associative, but need not be commutative.
+///
+/// See For for chunking, nesting and exceptions.
+///
+template <typename T, typename Map, typename Combine>
+T Reduce(ThreadPool& pool, const size_t begin, const size_t end, const size_t grain, T identity,
+         Map&& map, Combine&& combine)
+{
+    if (begin >= end) return identity;
+
+    const size_t size = end - begin;
+    const size_t chunkSize = internal::GrainSize(pool, size, grain);
+    const size_t numChunks = (size + chunkSize - 1) / chunkSize;
+
+    std::vector<T> partials(numChunks, identity);
+    auto chunkFunc = [&](const size_t chunk) {
+        const size_t first = begin + chunk * chunkSize;
+        const size_t last = std::min(end, first + chunkSize);
+        T acc = identity;
+        for (size_t i = first; i < last; ++i)
+            acc = combine(std::move(acc), map(i));
+        partials[chunk] = std::move(acc);
+    };
+    internal::ForEachChunk(pool, numChunks, chunkFunc);
+
+    T result = std::move(identity);
+    for (auto& partial : partials)
+        result = combine(std::move(result), std::move(partial));
+    return result;
+}
+
+}  // namespace Parallel
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PARALLEL_FOR_H
@@ -0,0 +1,393 @@
+#ifndef PBCOPPER_PARALLEL_PIPELINE_H
+#define PBCOPPER_PARALLEL_PIPELINE_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include <pbcopper/parallel/ThreadPool.h>
+#include <pbcopper/parallel/internal/Channel.h>
+#include <pbcopper/parallel/internal/RunnerGroup.h>
+
+namespace PacBio {
+namespace Parallel {
+namespace internal {
+
+template <typename T>
+struct Sequenced
+{
+    size_t seq;
+    T value;
+};
+
+template <typename F, typename T>
+using StageResult = typename std::decay<decltype(std::declval<F&>()(std::declval<T>()))>::type;
+
+struct PipelineState
+{
+    std::mutex m;
+    std::condition_variable window;
+    size_t produced = 0;
+    size_t consumed = 0;
+
+    std::exception_ptr exc;
+    std::atomic_bool abort{false};
+    std::vector<std::function<void()>> aborters;
+
+    template <typename T>
+    void Register(const std::shared_ptr<Channel<T>>& channel)
+    {
+        {
+            std::lock_guard<std::mutex> g(m);
+            aborters.emplace_back([channel]() { channel->Abort(); });
+        }
+        if (abort) channel->Abort();
+    }
+
+    /// Stores the first exception, then aborts all channels.
+    void Fail(std::exception_ptr e)
+    {
+        {
+            std::lock_guard<std::mutex> g(m);
+            if (!exc) exc = std::move(e);
+        }
+        Abort();
+    }
+
+    void Abort()
+    {
+        std::vector<std::function<void()>> toCall;
+        {
+            std::lock_guard<std::mutex> g(m);
+            abort = true;
+            toCall = aborters;
+        }
+        for (const auto& a : toCall)
+            a();
+        window.notify_all();
+    }
+
+    void RethrowIfFailed()
+    {
+        std::lock_guard<std::mutex> g(m);
+        if (exc) std::rethrow_exception(exc);
+    }
+};
+
+class StageBase
+{
+public:
+    virtual ~StageBase() = default;
+    virtual void Join() = 0;
+};
+
+template <typename TIn, typename TOut, typename F>
+class Stage final : public StageBase
+{
+public:
+    Stage(ThreadPool* pool, const size_t numThreads, const F& f,
+          std::shared_ptr<Channel<Sequenced<TIn>>> in,
+          std::shared_ptr<Channel<Sequenced<TOut>>> out, std::shared_ptr<PipelineState> state)
+        : ownedPool_{pool ? nullptr
+                          : std::make_unique<ThreadPool>(numThreads == 0 ? 1 : numThreads)}
+        , pool_{pool ? *pool : *ownedPool_}
+        , in_{std::move(in)}
+        , out_{std::move(out)}
+        , state_{std::move(state)}
+        , fs_(numThreads == 0 ? 1 : numThreads, f)
+        , runners_{pool_, numThreads, [this](const size_t slot) { Drain(slot); }}
+    {
+        in_->SetHooks(
+            [this]() {
+                ++inFlight_;
+                runners_.Added();
+            },
+            [this]() {
+                closed_ = true;
+                if (inFlight_ == 0) Finish();
+            });
+    }
+
+    ~Stage() override { runners_.WaitIdle(); }
+
+    // Waits until the input has been closed and all of it passed on, or
+    // dropped once the pipeline has been aborted
+    void Join() override
+    {
+        {
+            std::unique_lock<std::mutex> lk(m_);
+            finishedCv_.wait(lk, [this]() { return finished_; });
+        }
+        runners_.WaitIdle();
+    }
+
+private:
+    // Runs as a task of the pool, until the input queue is empty
+    void Drain(const size_t slot)
+    {
+        auto& f = fs_[slot];
+        while (auto item = in_->TryPop()) {
+            runners_.Taken();
+            // Drop remaining items once the pipeline has been aborted
+            if (!state_->abort) {
+                try {
+                    out_->Push(Sequenced<TOut>{item->seq, f(std::move(item->value))});
+                } catch (...) {
+                    state_->Fail(std::current_exception());
+                }
+            }
+            if (--inFlight_ == 0 && closed_) Finish();
+        }
+    }
+
+    // The last item lets the next stage drain and stop
+    void Finish()
+    {
+        if (finishing_.exchange(true)) return;
+        out_->Close();
+        {
+            std::lock_guard<std::mutex> g(m_);
+            finished_ = true;
+        }
+        finishedCv_.notify_all();
+    }
+
+    // Destroyed last, after all runners have finished
+    std::unique_ptr<ThreadPool> ownedPool_;
+    ThreadPool& pool_;
+    std::shared_ptr<Channel<Sequenced<TIn>>> in_;
+    std::shared_ptr<Channel<Sequenced<TOut>>> out_;
+    std::shared_ptr<PipelineState> state_;
+    // every runner works on its own copy of the stage function
+    std::vector<F> fs_;
+    // Items pushed into 'in_' and not yet passed on
+    std::atomic<int64_t> inFlight_{0};
+    std::atomic_bool closed_{false};
+    std::atomic_bool finishing_{false};
+    std::mutex m_;
+    std::condition_variable finishedCv_;
+    bool finished_ = false;
+    // Destroyed first, waiting for active runners to access the members above
+    RunnerGroup runners_;
+};
+
+}  // namespace internal
+
+///
+/// Ordered multi-stage streaming pipeline:
+///
+///     auto pipeline = Parallel::Pipeline<Read>{64}
+///                         .Then(8, [](Read r) { return Align(std::move(r)); })
+///                         .Then(2, [](Alignment a) { return Score(a); });
+///
+/// Every stage runs on at most its own number of threads, consecutive stages
+/// are connected by bounded queues of 'capacity' items. Stages run either on
+/// their own pool of that many threads, or all on a shared pool, e.g.
+/// SharedThreadPool():
+///
+///     auto pipeline = Parallel::Pipeline<Read>{SharedThreadPool(), 64}
+///                         .Then(8, [](Read r) { return Align(std::move(r)); });
+///
+/// Stages process items in any order; ConsumeWith emits the final results in
+/// input order, using a reorder buffer of 'window' items. A slow item does not
+/// stall the workers behind it until 'window' items are in flight, at which
+/// point Produce blocks. On a shared pool, the queues after the stages hold up
+/// to 'window' items, the most there can be in flight, so that a stage worker
+/// never waits for room while the next stage waits for a worker of the pool.
+///
+/// The first exception thrown by a stage or by the consumer aborts the
+/// pipeline: Produce rethrows it, ConsumeWith returns false, and Finalize
+/// rethrows it.
+///
+/// To properly shut down the pipeline, call methods in this order:
+///    pipeline.FinalizeWorkers();
+///    consumerThread.wait(); // Shut down the consuming thread!
+///    pipeline.Finalize();
+///
+template <typename TIn, typename TOut = TIn>
+class Pipeline
+{
+public:
+    explicit Pipeline(const size_t capacity, const size_t window = 0)
+        : Pipeline{nullptr, capacity, window}
+    {
+    }
+
+    Pipeline(ThreadPool& pool, const size_t capacity, const size_t window = 0)
+        : Pipeline{&pool, capacity, window}
+    {
+    }
+
+    Pipeline(Pipeline&&) = default;
+    Pipeline& operator=(Pipeline&&) = delete;
+
+    ~Pipeline()
+    {
+        // Unblock all threads, if the pipeline has not been finalized.
+        if (state_) state_->Abort();
+    }
+
+    ///
+    /// Appends a stage of at most 'numThreads' concurrent workers, each calling
+    /// 'f' on a TOut and passing its result on to the next stage.
+    ///
+    /// \param capacity     size of the queue after this stage, defaults to the
+    ///                     capacity of the pipeline; at least 'window' on a
+    ///                     shared pool
+    ///
+    template <typename F>
+    Pipeline<TIn, internal::StageResult<F, TOut>> Then(const size_t numThreads, const F& f,
+                                                       const size_t capacity = 0) &&
+    {
+        using TNext = internal::StageResult<F, TOut>;
+
+        size_t queueSize = (capacity == 0) ? capacity_ : capacity;
+        if (pool_) queueSize = std::max(queueSize, window_);
+        auto next = std::make_shared<internal::Channel<internal::Sequenced<TNext>>>(queueSize);
+        state_->Register(next);
+        stages_.emplace_back(
+            new internal::Stage<TOut, TNext, F>{pool_, numThreads, f, output_, next, state_});
+
+        return Pipeline<TIn, TNext>{
+            pool_,           capacity_,         window_, std::move(state_), std::move(input_),
+            std::move(next), std::move(stages_)};
+    }
+
+    ///
+    /// Feeds an item into the first stage. Blocks while the first queue is
+    /// full or 'window' items are in flight.
+    ///
+    void Produce(TIn item)
+    {
+        size_t seq = 0;
+        {
+            std::unique_lock<std::mutex> lk(state_->m);
+            state_->window.wait(lk, [this]() {
+                return state_->abort || state_->produced - state_->consumed < window_;
+            });
+            if (state_->exc) std::rethrow_exception(state_->exc);
+            seq = state_->produced++;
+        }
+        if (!input_->Push(internal::Sequenced<TIn>{seq, std::move(item)}))
+            state_->RethrowIfFailed();
+    }
+
+    ///
+    /// Blocks until the next result in input order is available, then calls
+    /// 'cont' with it and with all directly following results.
+    ///
+    /// \returns false if all results have been consumed or the pipeline has
+    ///          been aborted
+    ///
+    template <typename F, typename... Args>
+    bool ConsumeWith(F&& cont, Args&&... args)
+    {
+        while (!reorder_[next_ % window_]) {
+            auto item = output_->Pop();
+            if (!item) return false;
+            reorder_[item->seq % window_] = std::move(item->value);
+        }
+
+        size_t n = 0;
+        bool ok = true;
+        try {
+            auto* slot = &reorder_[next_ % window_];
+            while (*slot) {
+                auto result = std::move(**slot);
+                *slot = boost::none;
+                ++next_;
+                ++n;
+                cont(std::forward<Args>(args)..., std::move(result));
+                slot = &reorder_[next_ % window_];
+            }
+        } catch (...) {
+            state_->Fail(std::current_exception());
+            ok = false;
+        }
+
+        {
+            std::lock_guard<std::mutex> g(state_->m);
+            state_->consumed += n;
+        }
+        state_->window.notify_all();
+        return ok;
+    }
+
+    /// Signals that there is no further input.
+    void FinalizeWorkers() { input_->Close(); }
+
+    void Finalize()
+    {
+        FinalizeWorkers();
+        // Do not continue before all items have been processed.
+        for (auto& stage : stages_)
+            stage->Join();
+
+        // Is there a final exception, throw if so..
+        state_->RethrowIfFailed();
+    }
+
+private:
+    template <typename, typename>
+    friend class Pipeline;
+
+    Pipeline(ThreadPool* pool, const size_t capacity, const size_t window)
+        : pool_{pool}
+        , capacity_{capacity == 0 ? 1 : capacity}
+        , window_{window == 0 ? 4 * capacity_ : window}
+        , state_{std::make_shared<internal::PipelineState>()}
+        , input_{std::make_shared<internal::Channel<internal::Sequenced<TIn>>>(capacity_)}
+        , output_{input_}
+        , reorder_(window_)
+    {
+        static_assert(std::is_same<TIn, TOut>::value,
+                      "a Pipeline is created without stages, add them with Then()");
+        state_->Register(input_);
+    }
+
+    Pipeline(ThreadPool* pool, const size_t capacity, const size_t window,
+             std::shared_ptr<internal::PipelineState> state,
+             std::shared_ptr<internal::Channel<internal::Sequenced<TIn>>> input,
+             std::shared_ptr<internal::Channel<internal::Sequenced<TOut>>> output,
+             std::vector<std::unique_ptr<internal::StageBase>> stages)
+        : pool_{pool}
+        , capacity_{capacity}
+        , window_{window}
+        , state_{std::move(state)}
+        , input_{std::move(input)}
+        , output_{std::move(output)}
+        , reorder_(window_)
+        , stages_{std::move(stages)}
+    {
+    }
+
+    // Shared by all stages, or nullptr for a pool per stage
+    ThreadPool* pool_;
+    size_t capacity_;
+    size_t window_;
+    std::shared_ptr<internal::PipelineState> state_;
+    std::shared_ptr<internal::Channel<internal::Sequenced<TIn>>> input_;
+    std::shared_ptr<internal::Channel<internal::Sequenced<TOut>>> output_;
+    std::vector<boost::optional<TOut>> reorder_;
+    size_t next_ = 0;
+    // Destroyed first, waiting for the stage workers
+    std::vector<std::unique_ptr<internal::StageBase>> stages_;
+};
+
+}  // namespace Parallel
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PARALLEL_PIPELINE_H
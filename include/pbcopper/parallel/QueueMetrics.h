@@ -0,0 +1,150 @@
+#ifndef PBCOPPER_PARALLEL_QUEUEMETRICS_H
+#define PBCOPPER_PARALLEL_QUEUEMETRICS_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <pbcopper/reports/Report.h>
+
+namespace PacBio {
+namespace Parallel {
+
+///
+/// Counters of a WorkQueue, FireAndForget or FireAndForgetIndexed, enabled
+/// with their EnableMetrics():
+///
+///  * per worker: number of tasks, time spent running them (busy) and the
+///    remaining time since metrics were enabled (idle)
+///  * time producers spent blocked in ProduceWith waiting for room, and time
+///    the consumer spent blocked in ConsumeWith waiting for a result
+///  * histogram of the number of queued tasks, sampled at every push
+///  * task latency, from ProduceWith until the task has finished
+///
+/// All counters are relaxed atomics and may be read at any time while the
+/// queue runs; a queue without metrics does not read the clock at all.
+///
+/// Latencies are kept in logarithmic buckets, 8 per power of two, so that
+/// percentiles are exact to within 12.5%.
+///
+class QueueMetrics
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Bucket 0 counts an empty queue, bucket i > 0 depths in [2^(i-1), 2^i)
+    static constexpr size_t NumDepthBuckets = 65;
+
+public:
+    explicit QueueMetrics(size_t numWorkers);
+
+    QueueMetrics(const QueueMetrics&) = delete;
+    QueueMetrics& operator=(const QueueMetrics&) = delete;
+
+    // recording, called by the queues
+
+    void TaskFinished(const size_t worker, const Clock::duration latency,
+                      const Clock::duration busy)
+    {
+        auto& w = workers_[worker];
+        w.tasks.fetch_add(1, std::memory_order_relaxed);
+        w.busy.fetch_add(Nanoseconds(busy), std::memory_order_relaxed);
+        latency_[LatencyBucket(Nanoseconds(latency))].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void ProducerBlocked(const Clock::duration d)
+    {
+        producerBlocked_.fetch_add(Nanoseconds(d), std::memory_order_relaxed);
+    }
+
+    void ConsumerBlocked(const Clock::duration d)
+    {
+        consumerBlocked_.fetch_add(Nanoseconds(d), std::memory_order_relaxed);
+    }
+
+    void Queued(const size_t depth)
+    {
+        depth_[DepthBucket(depth)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // reading
+
+    size_t NumWorkers() const;
+
+    /// \returns number of finished tasks, over all or of one worker
+    uint64_t NumTasks() const;
+    uint64_t NumTasks(size_t worker) const;
+
+    /// \returns time since these metrics were created
+    std::chrono::nanoseconds Elapsed() const;
+
+    std::chrono::nanoseconds BusyTime(size_t worker) const;
+    std::chrono::nanoseconds IdleTime(size_t worker) const;
+
+    std::chrono::nanoseconds ProducerBlockedTime() const;
+    std::chrono::nanoseconds ConsumerBlockedTime() const;
+
+    /// \returns number of pushes per queue depth bucket, see NumDepthBuckets
+    std::vector<uint64_t> DepthHistogram() const;
+
+    ///
+    /// \returns latency not exceeded by 'percentile' (0-100) percent of all
+    ///          finished tasks, or 0 if no task has finished yet
+    ///
+    std::chrono::nanoseconds LatencyPercentile(double percentile) const;
+
+    ///
+    /// \returns report with the overall counters as attributes, and a
+    ///          'workers' and a 'queue_depth' table
+    ///
+    Reports::Report ToReport(const std::string& id = "queue_metrics") const;
+
+private:
+    static constexpr size_t NumLatencyBuckets = 8 * 62;
+
+    // Padded to a cache line, workers do not share counters
+    struct Worker
+    {
+        std::atomic<uint64_t> tasks{0};
+        std::atomic<uint64_t> busy{0};
+        char padding[64 - 2 * sizeof(std::atomic<uint64_t>)];
+    };
+
+    static uint64_t Nanoseconds(const Clock::duration d)
+    {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+        return ns > 0 ? static_cast<uint64_t>(ns) : 0;
+    }
+
+    static size_t DepthBucket(const size_t depth)
+    {
+        return depth == 0 ? 0 : 64 - __builtin_clzll(depth);
+    }
+
+    static size_t LatencyBucket(const uint64_t ns)
+    {
+        if (ns < 8) return ns;
+        const int msb = 63 - __builtin_clzll(ns);
+        return 8 * (msb - 2) + ((ns >> (msb - 3)) & 7);
+    }
+
+    const Clock::time_point start_;
+    std::unique_ptr<Worker[]> workers_;
+    const size_t numWorkers_;
+    std::atomic<uint64_t> producerBlocked_{0};
+    std::atomic<uint64_t> consumerBlocked_{0};
+    std::array<std::atomic<uint64_t>, NumDepthBuckets> depth_;
+    std::array<std::atomic<uint64_t>, NumLatencyBuckets> latency_;
+};
+
+}  // namespace Parallel
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PARALLEL_QUEUEMETRICS_H
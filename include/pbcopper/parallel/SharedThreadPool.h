@@ -0,0 +1,35 @@
+#ifndef PBCOPPER_PARALLEL_SHAREDTHREADPOOL_H
+#define PBCOPPER_PARALLEL_SHAREDTHREADPOOL_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <cstddef>
+
+#include <pbcopper/parallel/ThreadPool.h>
+
+namespace PacBio {
+namespace Parallel {
+
+///
+/// Sets the number of worker threads of the process-wide ThreadPool returned
+/// by SharedThreadPool(). CLI_v2::Run calls this with Results::NumThreads()
+/// before starting the application.
+///
+/// \returns false if the shared pool has already been started with a
+///          different number of threads, which then stays unchanged
+///
+bool SetSharedThreadPoolSize(size_t numThreads);
+
+///
+/// \returns process-wide ThreadPool, started on first use with the number of
+///          threads set by SetSharedThreadPoolSize(), or one thread per core
+///
+/// Pass it to WorkQueue, FireAndForget, FireAndForgetIndexed, For, etc. to
+/// let them share one set of threads instead of spawning their own.
+///
+ThreadPool& SharedThreadPool();
+
+}  // namespace Parallel
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PARALLEL_SHAREDTHREADPOOL_H
@@ -0,0 +1,170 @@
+#ifndef PBCOPPER_PARALLEL_SORT_H
+#define PBCOPPER_PARALLEL_SORT_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <pbcopper/parallel/For.h>
+#include <pbcopper/parallel/ThreadPool.h>
+
+namespace PacBio {
+namespace Parallel {
+
+///
+/// Sorts [first, last) with 'comp' using the calling thread and the workers
+/// of 'pool': equally sized blocks are sorted in parallel, then merged
+/// pairwise, every round of merges again in parallel. Like std::sort, the
+/// order of equal elements is not preserved.
+///
+/// Short ranges are sorted directly on the calling thread. See For for
+/// nesting and exceptions.
+///
+template <typename RandomIt, typename Compare = std::less<>>
+void Sort(ThreadPool& pool, const RandomIt first, const RandomIt last, Compare comp = Compare{})
+{
+    // Below this, the parallel overhead outweighs the gain
+    static constexpr size_t MinParallelSize = 1 << 14;
+
+    const auto size = static_cast<size_t>(std::distance(first, last));
+    if (size < MinParallelSize || pool.NumThreads() == 0) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    // Power of two number of blocks, at least one per thread
+    size_t numBlocks = 1;
+    while (numBlocks < pool.NumThreads() + 1 && size / (2 * numBlocks) >= MinParallelSize / 2)
+        numBlocks *= 2;
+
+    std::vector<RandomIt> bounds(numBlocks + 1);
+    for (size_t i = 0; i <= numBlocks; ++i)
+        bounds[i] = first + static_cast<std::ptrdiff_t>(i * size / numBlocks);
+
+    For(pool, 0, numBlocks, 1,
+        [&bounds, &comp](const size_t i) { std::sort(bounds[i], bounds[i + 1], comp); });
+
+    for (size_t width = 1; width < numBlocks; width *= 2) {
+        For(pool, 0, numBlocks / (2 * width), 1, [&bounds, &comp, width](const size_t i) {
+            const size_t lo = 2 * i * width;
+            std::inplace_merge(bounds[lo], bounds[lo + width], bounds[lo + 2 * width], comp);
+        });
+    }
+}
+
+namespace internal {
+
+using RadixCounts = std::vector<std::array<size_t, 256>>;
+
+// Calls 'f(chunk)' for every chunk, on the calling thread only if there is one
+template <typename F>
+void ForEachRadixChunk(ThreadPool& pool, const size_t numChunks, F&& f)
+{
+    if (numChunks == 1) {
+        f(0);
+    } else {
+        For(pool, 0, numChunks, 1, f);
+    }
+}
+
+// Stable counting sort of [src, src + size) into 'dst' by the byte of the key
+// at 'shift'. Chunk 'c' covers [c * size / n, (c + 1) * size / n).
+//
+// \returns false, without touching 'dst', if all keys share that byte
+template <typename SrcIt, typename DstIt, typename KeyFunc>
+bool RadixPass(ThreadPool& pool, const SrcIt src, const DstIt dst, const size_t size,
+               RadixCounts& counts, KeyFunc& key, const unsigned int shift)
+{
+    const size_t numChunks = counts.size();
+
+    ForEachRadixChunk(pool, numChunks, [&](const size_t c) {
+        auto& count = counts[c];
+        count.fill(0);
+        for (size_t i = c * size / numChunks; i < (c + 1) * size / numChunks; ++i)
+            ++count[(key(src[i]) >> shift) & 0xFF];
+    });
+
+    // digit-major, chunk-minor offsets keep equal keys in input order
+    size_t offset = 0;
+    for (size_t digit = 0; digit < 256; ++digit) {
+        size_t total = 0;
+        for (const auto& count : counts)
+            total += count[digit];
+        if (total == size) return false;
+
+        for (auto& count : counts) {
+            const size_t n = count[digit];
+            count[digit] = offset;
+            offset += n;
+        }
+    }
+
+    ForEachRadixChunk(pool, numChunks, [&](const size_t c) {
+        auto& next = counts[c];
+        for (size_t i = c * size / numChunks; i < (c + 1) * size / numChunks; ++i) {
+            const size_t digit = (key(src[i]) >> shift) & 0xFF;
+            dst[next[digit]++] = std::move(src[i]);
+        }
+    });
+    return true;
+}
+
+}  // namespace internal
+
+///
+/// Sorts [first, last) by the unsigned integer 'key(element)', using the
+/// calling thread and the workers of 'pool'. This is a stable LSD radix sort
+/// with one pass per key byte: chunks count their digits in parallel, the
+/// counts give every chunk its output offsets, then chunks scatter in
+/// parallel into a buffer of the size of the range. Passes over a byte that
+/// is equal for all elements are skipped.
+///
+/// Short ranges are sorted on the calling thread only. See For for nesting
+/// and exceptions.
+///
+template <typename RandomIt, typename KeyFunc>
+void RadixSort(ThreadPool& pool, const RandomIt first, const RandomIt last, KeyFunc key)
+{
+    using T = typename std::iterator_traits<RandomIt>::value_type;
+    using Key = std::decay_t<decltype(key(*first))>;
+    static_assert(std::is_unsigned<Key>::value, "RadixSort key must be an unsigned integer");
+
+    // Below this, a chunk is not worth a task
+    static constexpr size_t MinChunkSize = 1 << 13;
+
+    const auto size = static_cast<size_t>(std::distance(first, last));
+    if (size < 2) return;
+
+    const size_t numChunks =
+        std::max<size_t>(1, std::min(4 * (pool.NumThreads() + 1), size / MinChunkSize));
+    internal::RadixCounts counts(numChunks);
+    std::vector<T> buffer(size);
+
+    bool inBuffer = false;
+    for (unsigned int shift = 0; shift < 8 * sizeof(Key); shift += 8) {
+        const bool moved =
+            inBuffer ? internal::RadixPass(pool, buffer.begin(), first, size, counts, key, shift)
+                     : internal::RadixPass(pool, first, buffer.begin(), size, counts, key, shift);
+        if (moved) inBuffer = !inBuffer;
+    }
+
+    if (inBuffer) {
+        internal::ForEachRadixChunk(pool, numChunks, [&](const size_t c) {
+            const auto b = static_cast<std::ptrdiff_t>(c * size / numChunks);
+            const auto e = static_cast<std::ptrdiff_t>((c + 1) * size / numChunks);
+            std::move(buffer.begin() + b, buffer.begin() + e, first + b);
+        });
+    }
+}
+
+}  // namespace Parallel
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PARALLEL_SORT_H
@@ -0,0 +1,291 @@
+#ifndef PBCOPPER_PARALLEL_TASK_H
+#define PBCOPPER_PARALLEL_TASK_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <cstddef>
+
+#include <functional>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace PacBio {
+namespace Parallel {
+
+template <typename Signature, size_t InlineSize = 64>
+class Task;
+
+///
+/// Move-only callable wrapper, similar to std::function, but
+///
+///  * stores callables of up to 'InlineSize' bytes inside the Task itself,
+///    so that wrapping a small lambda or bound call never allocates;
+///  * accepts move-only callables, e.g. lambdas capturing a unique_ptr.
+///
+/// Larger callables, or callables that may throw when moved, are stored on
+/// the heap.
+///
+template <typename R, typename... Args, size_t InlineSize>
+class Task<R(Args...), InlineSize>
+{
+public:
+    /// \returns true if a callable of type F is stored without allocating
+    template <typename F>
+    static constexpr bool IsStoredInline()
+    {
+        return sizeof(F) <= InlineSize && alignof(F) <= alignof(Storage) &&
+               std::is_nothrow_move_constructible<F>::value;
+    }
+
+public:
+    Task() noexcept = default;
+    Task(std::nullptr_t) noexcept {}
+
+    template <typename F, typename = typename std::enable_if<
+                              !std::is_same<typename std::decay<F>::type, Task>::value>::type>
+    Task(F&& f)
+    {
+        using Callable = typename std::decay<F>::type;
+        Emplace<Callable>(std::forward<F>(f),
+                          std::integral_constant<bool, IsStoredInline<Callable>()>{});
+    }
+
+    Task(Task&& other) noexcept { MoveFrom(other); }
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other) {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    Task& operator=(std::nullptr_t) noexcept
+    {
+        Reset();
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { Reset(); }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+    R operator()(Args... args) { return ops_->invoke(&storage_, std::forward<Args>(args)...); }
+
+private:
+    using Storage = typename std::aligned_storage<InlineSize, alignof(std::max_align_t)>::type;
+
+    struct Ops
+    {
+        R (*invoke)(void*, Args&&...);
+        void (*move)(void* dst, void* src) noexcept;
+        void (*destroy)(void*) noexcept;
+    };
+
+    // Callable stored in-place
+    template <typename F>
+    struct Inline
+    {
+        static F& Get(void* p) { return *static_cast<F*>(p); }
+
+        static R Invoke(void* p, Args&&... args)
+        {
+            return static_cast<R>(Get(p)(std::forward<Args>(args)...));
+        }
+
+        static void Move(void* dst, void* src) noexcept
+        {
+            ::new (dst) F(std::move(Get(src)));
+            Get(src).~F();
+        }
+
+        static void Destroy(void* p) noexcept { Get(p).~F(); }
+
+        static const Ops* Table()
+        {
+            static const Ops ops{&Invoke, &Move, &Destroy};
+            return &ops;
+        }
+    };
+
+    // Callable stored on the heap, only its pointer is stored in-place
+    template <typename F>
+    struct Heap
+    {
+        static F*& Get(void* p) { return *static_cast<F**>(p); }
+
+        static R Invoke(void* p, Args&&... args)
+        {
+            return static_cast<R>((*Get(p))(std::forward<Args>(args)...));
+        }
+
+        static void Move(void* dst, void* src) noexcept
+        {
+            ::new (dst) F*(Get(src));
+            Get(src) = nullptr;
+        }
+
+        static void Destroy(void* p) noexcept { delete Get(p); }
+
+        static const Ops* Table()
+        {
+            static const Ops ops{&Invoke, &Move, &Destroy};
+            return &ops;
+        }
+    };
+
+    template <typename F, typename G>
+    void Emplace(G&& f, std::true_type /* inline */)
+    {
+        ::new (static_cast<void*>(&storage_)) F(std::forward<G>(f));
+        ops_ = Inline<F>::Table();
+    }
+
+    template <typename F, typename G>
+    void Emplace(G&& f, std::false_type /* inline */)
+    {
+        ::new (static_cast<void*>(&storage_)) F*(new F(std::forward<G>(f)));
+        ops_ = Heap<F>::Table();
+    }
+
+    void MoveFrom(Task& other) noexcept
+    {
+        if (other.ops_) {
+            other.ops_->move(&storage_, &other.storage_);
+            ops_ = other.ops_;
+            other.ops_ = nullptr;
+        }
+    }
+
+    void Reset() noexcept
+    {
+        if (ops_) {
+            ops_->destroy(&storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    const Ops* ops_ = nullptr;
+    Storage storage_;
+};
+
+namespace internal {
+
+// How a stored argument of BoundCall is passed on, as in std::bind
+struct PlainArgTag
+{
+};
+struct NestedBindArgTag
+{
+};
+template <int N>
+struct PlaceholderArgTag
+{
+};
+
+template <typename A>
+using BoundArgTag = typename std::conditional<
+    std::is_bind_expression<A>::value, NestedBindArgTag,
+    typename std::conditional<(std::is_placeholder<A>::value > 0),
+                              PlaceholderArgTag<std::is_placeholder<A>::value>,
+                              PlainArgTag>::type>::type;
+
+template <typename A, typename Front>
+A& BoundArg(A& arg, Front&, PlainArgTag)
+{
+    return arg;
+}
+
+template <typename T, typename Front>
+T& BoundArg(std::reference_wrapper<T>& arg, Front&, PlainArgTag)
+{
+    return arg.get();
+}
+
+template <typename A, typename Front, int N>
+auto BoundArg(A&, Front& front, PlaceholderArgTag<N>) -> decltype(std::get<N - 1>(std::move(front)))
+{
+    return std::get<N - 1>(std::move(front));
+}
+
+template <typename A, typename Front, size_t... I>
+decltype(auto) CallNestedBind(A& arg, Front& front, std::index_sequence<I...>)
+{
+    return arg(std::get<I>(std::move(front))...);
+}
+
+template <typename A, typename Front>
+decltype(auto) BoundArg(A& arg, Front& front, NestedBindArgTag)
+{
+    return CallNestedBind(arg, front, std::make_index_sequence<std::tuple_size<Front>::value>{});
+}
+
+// INVOKE(f, args...), calling pointers to members through std::mem_fn
+template <typename F, typename... Args>
+decltype(auto) Invoke(std::true_type /* member */, F& f, Args&&... args)
+{
+    return std::mem_fn(f)(std::forward<Args>(args)...);
+}
+
+template <typename F, typename... Args>
+decltype(auto) Invoke(std::false_type /* member */, F& f, Args&&... args)
+{
+    return f(std::forward<Args>(args)...);
+}
+
+///
+/// Allocation-free replacement for std::bind(f, args...): stores the callable
+/// and copies of the arguments, and calls 'f(front..., args...)' as std::bind
+/// does. Stored arguments are passed as lvalues, std::reference_wrapper
+/// arguments are unwrapped, placeholders _1, _2, ... pick from 'front', and
+/// pointers to members are called on their first argument.
+///
+template <typename F, typename... Args>
+class BoundCall
+{
+public:
+    template <typename G, typename... A, typename = typename std::enable_if<!std::is_same<
+                                             typename std::decay<G>::type, BoundCall>::value>::type>
+    explicit BoundCall(G&& f, A&&... args) : f_(std::forward<G>(f)), args_(std::forward<A>(args)...)
+    {
+    }
+
+    template <typename... Front>
+    decltype(auto) operator()(Front&&... front)
+    {
+        return Call(std::index_sequence_for<Args...>{}, std::forward<Front>(front)...);
+    }
+
+private:
+    template <size_t... I, typename... Front>
+    decltype(auto) Call(std::index_sequence<I...>, Front&&... front)
+    {
+        auto frontArgs = std::forward_as_tuple(std::forward<Front>(front)...);
+        static_cast<void>(frontArgs);  // unused without stored arguments
+        return Invoke(std::is_member_pointer<F>{}, f_, std::forward<Front>(front)...,
+                      BoundArg(std::get<I>(args_), frontArgs, BoundArgTag<Args>{})...);
+    }
+
+    F f_;
+    std::tuple<Args...> args_;
+};
+
+template <typename F, typename... Args>
+BoundCall<typename std::decay<F>::type, typename std::decay<Args>::type...> Bind(F&& f,
+                                                                                 Args&&... args)
+{
+    return BoundCall<typename std::decay<F>::type, typename std::decay<Args>::type...>{
+        std::forward<F>(f), std::forward<Args>(args)...};
+}
+
+}  // namespace internal
+}  // namespace Parallel
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PARALLEL_TASK_H
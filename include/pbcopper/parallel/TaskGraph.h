@@ -0,0 +1,207 @@
+#ifndef PBCOPPER_PARALLEL_TASKGRAPH_H
+#define PBCOPPER_PARALLEL_TASKGRAPH_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pbcopper/parallel/Task.h>
+#include <pbcopper/parallel/ThreadPool.h>
+
+namespace PacBio {
+namespace Parallel {
+
+///
+/// Runs a directed acyclic graph of tasks on a ThreadPool, either its own
+/// pool of 'size' threads or a shared pool, e.g. SharedThreadPool().
+///
+/// Add() takes a task and the ids of tasks it depends on, which must have
+/// been added before; the task is started as soon as all of them have
+/// finished, independent of any other task. Tasks may be added at any time,
+/// also from within running tasks, e.g. to fan out over results:
+///
+/// \code{.cpp}
+///    TaskGraph graph{SharedThreadPool()};
+///    std::vector<TaskGraph::Id> indices;
+///    for (size_t i = 0; i < chunks.size(); ++i)
+///        indices.push_back(graph.Add([&, i]() { index[i] = BuildIndex(chunks[i]); }));
+///    for (size_t i = 0; i < chunks.size(); ++i)
+///        graph.Add([&, i]() { FindSeeds(index[i], reads); }, {indices[i]});
+///    graph.Wait();
+/// \endcode
+///
+/// As with FireAndForget, the first exception thrown by a task aborts the
+/// graph: tasks not yet started are skipped, and the exception is rethrown by
+/// the next Add or by Wait.
+///
+class TaskGraph
+{
+public:
+    using Id = size_t;
+
+public:
+    explicit TaskGraph(const size_t size)
+        : ownedPool_{std::make_unique<ThreadPool>(size)}, pool_{*ownedPool_}
+    {
+    }
+
+    explicit TaskGraph(ThreadPool& pool) : pool_{pool} {}
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    /// Waits for all tasks, without rethrowing their exceptions.
+    ~TaskGraph() { WaitIdle(); }
+
+    ///
+    /// Adds task 'f', started once all tasks in 'dependencies' have finished.
+    ///
+    /// \returns id of the new task, for use as a dependency
+    ///
+    template <typename F>
+    Id Add(F&& f, const std::vector<Id>& dependencies = {})
+    {
+        RethrowIfAborted();
+
+        std::lock_guard<std::mutex> g(m_);
+        const Id id = firstId_ + nodes_.size();
+        for (const Id dependency : dependencies) {
+            if (dependency >= id) {
+                throw std::invalid_argument{"[pbcopper] task graph ERROR: unknown dependency " +
+                                            std::to_string(dependency)};
+            }
+        }
+
+        nodes_.emplace_back();
+        Node& node = nodes_.back();
+        node.task = NodeTask{std::forward<F>(f)};
+        for (const Id dependency : dependencies) {
+            // released nodes have finished
+            if (dependency < firstId_) continue;
+            Node& input = nodes_[dependency - firstId_];
+            if (!input.finished) {
+                input.dependents.push_back(&node);
+                ++node.waitingOn;
+            }
+        }
+
+        ++unfinished_;
+        if (node.waitingOn == 0) Schedule(node);
+        return id;
+    }
+
+    ///
+    /// Blocks until all tasks added so far, and all tasks they add, have
+    /// finished, running tasks of the pool meanwhile. May be called from
+    /// within a task of the same pool, but not from a task of this graph.
+    ///
+    /// Rethrows the first exception thrown by a task.
+    ///
+    void Wait()
+    {
+        WaitIdle();
+        RethrowIfAborted();
+    }
+
+private:
+    using NodeTask = Task<void()>;
+
+    struct Node
+    {
+        NodeTask task;
+        size_t waitingOn = 0;
+        bool finished = false;
+        std::vector<Node*> dependents;
+    };
+
+    // Requires 'm_' to be held
+    void Schedule(Node& node)
+    {
+        Node* const n = &node;
+        pool_.Submit([this, n]() { Run(*n); });
+        ++events_;
+        changed_.notify_all();
+    }
+
+    void Run(Node& node)
+    {
+        try {
+            // Check if graph should be aborted
+            if (!abort_) node.task();
+        } catch (...) {
+            std::lock_guard<std::mutex> g(m_);
+            if (!exc_) exc_ = std::current_exception();
+            abort_ = true;
+        }
+        node.task = nullptr;
+
+        // Everything is done under the lock, so that a waiting destructor
+        // cannot return while this task still touches any member
+        std::lock_guard<std::mutex> g(m_);
+        node.finished = true;
+        for (Node* dependent : node.dependents) {
+            if (--dependent->waitingOn == 0) Schedule(*dependent);
+        }
+        node.dependents.clear();
+        --unfinished_;
+        ++events_;
+        changed_.notify_all();
+
+        // Release finished nodes from the front, so that a long-lived graph
+        // only keeps those added since its oldest unfinished task
+        while (!nodes_.empty() && nodes_.front().finished) {
+            nodes_.pop_front();
+            ++firstId_;
+        }
+    }
+
+    void WaitIdle()
+    {
+        std::unique_lock<std::mutex> lk(m_);
+        while (unfinished_ > 0) {
+            // Help out, e.g. if this is the only worker of the pool; any task
+            // scheduled or finished from now on wakes the wait below
+            const size_t seen = events_;
+            lk.unlock();
+            const bool ran = pool_.TryRunOne();
+            lk.lock();
+            if (!ran) changed_.wait(lk, [this, seen]() { return events_ != seen; });
+        }
+    }
+
+    void RethrowIfAborted()
+    {
+        if (abort_) {
+            std::lock_guard<std::mutex> g(m_);
+            std::rethrow_exception(exc_);
+        }
+    }
+
+    std::unique_ptr<ThreadPool> ownedPool_;
+    ThreadPool& pool_;
+    std::mutex m_;
+    std::condition_variable changed_;
+    // Elements of a deque keep their address as it grows or shrinks at the
+    // ends; nodes_[i] is the task with id 'firstId_ + i'
+    std::deque<Node> nodes_;
+    Id firstId_ = 0;
+    size_t unfinished_ = 0;
+    size_t events_ = 0;
+    std::atomic_bool abort_{false};
+    std::exception_ptr exc_;
+};
+
+}  // namespace Parallel
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PARALLEL_TASKGRAPH_H
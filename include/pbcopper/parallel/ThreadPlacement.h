@@ -0,0 +1,116 @@
+#ifndef PBCOPPER_PARALLEL_THREADPLACEMENT_H
+#define PBCOPPER_PARALLEL_THREADPLACEMENT_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace PacBio {
+namespace Parallel {
+
+///
+/// One logical CPU, as described by sysfs.
+///
+struct CpuInfo
+{
+    int id = 0;
+    int core = 0;
+    int package = 0;
+    int node = 0;
+};
+
+///
+/// \returns all online CPUs, read from 'sysfsRoot'/cpu and 'sysfsRoot'/node.
+///          Without sysfs, e.g. on macOS, one CPU per hardware thread on
+///          node 0 is reported.
+///
+std::vector<CpuInfo> ReadCpuTopology(const std::string& sysfsRoot = "/sys/devices/system");
+
+///
+/// \returns the CPUs this process may run on, e.g. those of its cgroup
+///          cpuset or taskset, or an empty list where this is unknown
+///
+std::vector<int> AllowedCpus();
+
+///
+/// \returns the CPUs of 'topology' that are in 'allowed', or all of
+///          'topology' if 'allowed' is empty
+///
+std::vector<CpuInfo> RestrictCpuTopology(const std::vector<CpuInfo>& topology,
+                                         const std::vector<int>& allowed);
+
+///
+/// Pins the calling thread to 'cpu'.
+///
+/// \returns false if pinning failed or is not supported on this platform
+///
+bool PinCurrentThread(int cpu);
+
+///
+/// Decides which CPU every worker thread of a ThreadPool is pinned to:
+///
+///  * None      - threads are not pinned (default)
+///  * Compact   - consecutive workers fill one NUMA node, then the next,
+///                sharing caches as much as possible
+///  * Scatter   - consecutive workers alternate between NUMA nodes and use
+///                distinct cores first, maximizing memory bandwidth
+///  * Explicit  - worker i is pinned to cpus[i % cpus.size()]
+///
+/// Compact and Scatter only choose among the CPUs this process is allowed to
+/// run on, see AllowedCpus.
+///
+/// Pinned workers stay on their node, so memory they touch first, e.g.
+/// per-worker scratch buffers allocated by a FireAndForgetIndexed init
+/// function, is placed on their local node.
+///
+class ThreadPlacement
+{
+public:
+    enum class Policy
+    {
+        NONE,
+        COMPACT,
+        SCATTER,
+        EXPLICIT
+    };
+
+public:
+    static ThreadPlacement None();
+    static ThreadPlacement Compact();
+    static ThreadPlacement Scatter();
+    static ThreadPlacement Explicit(std::vector<int> cpus);
+
+public:
+    ThreadPlacement();
+
+    Policy GetPolicy() const;
+
+    ///
+    /// \returns the CPU for each of 'numThreads' workers, or -1 where a worker
+    ///          should not be pinned, using the topology of this machine
+    ///          restricted to the allowed CPUs
+    ///
+    std::vector<int> CpusFor(size_t numThreads) const;
+
+    /// \returns the CPU for each of 'numThreads' workers, using 'topology'
+    std::vector<int> CpusFor(size_t numThreads, const std::vector<CpuInfo>& topology) const;
+
+private:
+    ThreadPlacement(Policy policy, std::vector<int> cpus);
+
+    Policy policy_;
+    std::vector<int> cpus_;
+};
+
+namespace internal {
+
+/// Parses a sysfs CPU list, e.g. "0-3,8,10-11"
+std::vector<int> ParseCpuList(const std::string& list);
+
+}  // namespace internal
+}  // namespace Parallel
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PARALLEL_THREADPLACEMENT_H
@@ -0,0 +1,287 @@
+#ifndef PBCOPPER_PARALLEL_THREADPOOL_H
+#define PBCOPPER_PARALLEL_THREADPOOL_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <pbcopper/parallel/BoundedQueue.h>
+#include <pbcopper/parallel/Task.h>
+#include <pbcopper/parallel/ThreadPlacement.h>
+#include <pbcopper/parallel/internal/EventCount.h>
+
+namespace PacBio {
+namespace Parallel {
+
+///
+/// Work-stealing thread pool.
+///
+/// Every worker owns a deque of tasks. Tasks submitted from a worker thread go
+/// to that worker's own deque, tasks submitted from any other thread go to a
+/// lock-free FIFO injection queue, so they are started in submission order.
+/// Should the injection queue ever be full, further tasks go to a locked
+/// overflow deque until it has drained again. An idle
+/// worker first drains its own deque (newest first), then the injection queue,
+/// then steals the oldest task of randomly chosen victims, and finally parks
+/// until new work is submitted.
+///
+/// Locks are only held to push or pop a single task, never while waiting;
+/// parked workers are woken through an EventCount, which costs nothing while
+/// all workers are busy.
+///
+/// Tasks are stored as Parallel::Task, small tasks are submitted without any
+/// allocation besides the occasional growth of a deque.
+///
+/// Workers can be pinned to CPUs chosen by a ThreadPlacement policy.
+///
+/// Tasks must not throw; callers are expected to capture and propagate
+/// exceptions themselves (see FireAndForget).
+///
+class ThreadPool
+{
+public:
+    using Task = Parallel::Task<void()>;
+
+public:
+    explicit ThreadPool(const size_t size) : ThreadPool{size, ThreadPlacement::None()} {}
+
+    ///
+    /// Starts 'size' workers placed according to 'placement'. Every worker
+    /// first pins itself, then calls 'onStart' with its index before taking
+    /// any task, e.g. to allocate per-worker memory on its local NUMA node.
+    /// The constructor returns once all 'onStart' calls have finished;
+    /// 'onStart' must not throw.
+    ///
+    ThreadPool(const size_t size, const ThreadPlacement& placement,
+               std::function<void(size_t)> onStart = {})
+    {
+        const auto cpus = placement.CpusFor(size);
+
+        // Only touched by the workers if there is an 'onStart' to wait for
+        const bool waitForStart = static_cast<bool>(onStart);
+        std::mutex startMutex;
+        std::condition_variable startCv;
+        size_t started = 0;
+
+        workers_.reserve(size);
+        for (size_t i = 0; i < size; ++i)
+            workers_.emplace_back(new Worker);
+        for (size_t i = 0; i < size; ++i) {
+            const int cpu = cpus[i];
+            workers_[i]->thread = std::thread([&, this, i, cpu, waitForStart]() {
+                if (cpu >= 0) PinCurrentThread(cpu);
+                if (waitForStart) {
+                    onStart(i);
+                    std::lock_guard<std::mutex> g(startMutex);
+                    ++started;
+                    startCv.notify_all();
+                }
+                Run(i);
+            });
+        }
+
+        if (waitForStart) {
+            std::unique_lock<std::mutex> lk(startMutex);
+            startCv.wait(lk, [&]() { return started == size; });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Executes all remaining tasks and joins the worker threads.
+    ~ThreadPool()
+    {
+        stop_ = true;
+        parking_.NotifyAll();
+        for (auto& worker : workers_)
+            worker->thread.join();
+    }
+
+    /// \returns number of worker threads
+    size_t NumThreads() const { return workers_.size(); }
+
+    /// \returns index of the calling worker thread in [0, NumThreads()), or
+    ///          NumThreads() if the caller is not a worker of this pool
+    size_t CurrentWorkerIndex() const
+    {
+        const auto& ctx = Context();
+        return (ctx.pool == this) ? ctx.index : NumThreads();
+    }
+
+    ///
+    /// Schedules a task for execution. Never blocks on other producers or
+    /// on running tasks.
+    ///
+    void Submit(Task task)
+    {
+        const size_t self = CurrentWorkerIndex();
+        if (self == NumThreads()) {
+            // Once tasks overflow, keep appending to the overflow deque to
+            // preserve submission order
+            if (overflowSize_.load(std::memory_order_acquire) > 0 ||
+                !injected_.TryPush(std::move(task))) {
+                std::lock_guard<std::mutex> g(overflowMutex_);
+                overflow_.emplace_back(std::move(task));
+                ++overflowSize_;
+            }
+        } else {
+            auto& worker = *workers_[self];
+            std::lock_guard<std::mutex> g(worker.m);
+            worker.tasks.emplace_back(std::move(task));
+        }
+        queued_.fetch_add(1, std::memory_order_seq_cst);
+        parking_.NotifyOne();
+    }
+
+    ///
+    /// Executes at most one pending task on the calling thread, preferring the
+    /// caller's own deque if it is a worker of this pool. Useful to make
+    /// progress while waiting on other tasks.
+    ///
+    /// \returns true if a task was executed
+    ///
+    bool TryRunOne()
+    {
+        Task task;
+        const size_t self = CurrentWorkerIndex();
+        if (!TryPop(self, task) && !TryPopInjected(task) && !TrySteal(self, task)) return false;
+        task();
+        return true;
+    }
+
+private:
+    // Number of tasks from non-worker threads that can be queued lock-free
+    static constexpr size_t InjectionCapacity = 1024;
+
+    struct Worker
+    {
+        std::mutex m;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    struct WorkerContext
+    {
+        const ThreadPool* pool = nullptr;
+        size_t index = 0;
+    };
+
+    static WorkerContext& Context()
+    {
+        static thread_local WorkerContext ctx;
+        return ctx;
+    }
+
+    void Run(const size_t index)
+    {
+        Context().pool = this;
+        Context().index = index;
+
+        // xorshift state for victim selection, distinct per worker
+        uint32_t seed = static_cast<uint32_t>(index) * 2654435761u + 1u;
+
+        Task task;
+        while (true) {
+            if (TryPop(index, task) || TryPopInjected(task) || TrySteal(index, seed, task)) {
+                task();
+                task = nullptr;
+                continue;
+            }
+
+            const auto key = parking_.PrepareWait();
+            if (queued_.load(std::memory_order_seq_cst) > 0) {
+                parking_.CancelWait();
+                continue;
+            }
+            if (stop_) {
+                parking_.CancelWait();
+                return;
+            }
+            parking_.Wait(key);
+        }
+    }
+
+    bool TryPop(const size_t index, Task& task)
+    {
+        if (index == NumThreads()) return false;
+
+        auto& worker = *workers_[index];
+        std::lock_guard<std::mutex> g(worker.m);
+        if (worker.tasks.empty()) return false;
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+        queued_.fetch_sub(1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    bool TryPopInjected(Task& task)
+    {
+        if (!injected_.TryPop(task)) {
+            if (overflowSize_.load(std::memory_order_acquire) == 0) return false;
+
+            std::lock_guard<std::mutex> g(overflowMutex_);
+            if (overflow_.empty()) return false;
+            task = std::move(overflow_.front());
+            overflow_.pop_front();
+            --overflowSize_;
+        }
+        queued_.fetch_sub(1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    bool TrySteal(const size_t self, Task& task)
+    {
+        uint32_t seed = static_cast<uint32_t>(nextSeed_++) * 2654435761u + 1u;
+        return TrySteal(self, seed, task);
+    }
+
+    bool TrySteal(const size_t self, uint32_t& seed, Task& task)
+    {
+        const size_t n = NumThreads();
+        if (n == 0 || queued_.load(std::memory_order_seq_cst) == 0) return false;
+
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        const size_t start = seed % n;
+
+        for (size_t i = 0; i < n; ++i) {
+            const size_t victim = (start + i) % n;
+            if (victim == self) continue;
+
+            auto& worker = *workers_[victim];
+            std::unique_lock<std::mutex> lk(worker.m, std::try_to_lock);
+            if (!lk.owns_lock() || worker.tasks.empty()) continue;
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+            queued_.fetch_sub(1, std::memory_order_seq_cst);
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    BoundedQueue<Task> injected_{InjectionCapacity};
+    std::mutex overflowMutex_;
+    std::deque<Task> overflow_;
+    std::atomic<size_t> overflowSize_{0};
+    std::atomic<size_t> nextSeed_{0};
+    std::atomic<int64_t> queued_{0};
+    std::atomic_bool stop_{false};
+    internal::EventCount parking_;
+};
+
+}  // namespace Parallel
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PARALLEL_THREADPOOL_H
@@ -5,17 +5,24 @@
 
 #include <pbcopper/PbcopperConfig.h>
 
+#include <algorithm>
 #include <atomic>
-#include <condition_variable>
+#include <chrono>
 #include <cstddef>
-#include <deque>
 #include <exception>
-#include <future>
+#include <memory>
 #include <mutex>
 #include <vector>
 
 #include <boost/optional.hpp>
 
+#include <pbcopper/parallel/BoundedQueue.h>
+#include <pbcopper/parallel/QueueMetrics.h>
+#include <pbcopper/parallel/Task.h>
+#include <pbcopper/parallel/ThreadPool.h>
+#include <pbcopper/parallel/internal/EventCount.h>
+#include <pbcopper/parallel/internal/RunnerGroup.h>
+
 namespace PacBio {
 namespace Parallel {
 
@@ -23,86 +30,146 @@ namespace Parallel {
 ///    workQueue.FinalizeWorkers();
 ///    workerThread.wait(); // Shut down the consuming worker thread!
 ///    workQueue.Finalize();
+///
+/// Tasks run either on the queue's own pool of 'size' threads, or on a shared
+/// pool, e.g. SharedThreadPool(), of which the queue occupies at most
+/// 'maxConcurrency' workers at a time.
+///
+/// Tasks are queued in a lock-free BoundedQueue of 'size * mul' tasks. Every
+/// task is numbered when it is produced and writes its result into the
+/// matching slot of a preallocated ring of '2 * size * mul' results, which
+/// the consumer reads in order; small tasks neither allocate nor need a
+/// future, and no lock is taken to produce, run or consume a task.
+///
+/// Workers pop tasks in batches, whose size adapts to the observed per-task
+/// runtime: cheap tasks are taken several at a time, expensive tasks one at
+/// a time to keep all workers busy.
+///
+/// Call EnableMetrics() before producing to collect QueueMetrics.
 template <typename T>
 class WorkQueue
 {
 private:
-    using TTask = boost::optional<std::packaged_task<T()>>;
-    using TFuture = boost::optional<std::future<T>>;
+    using TTask = Task<T()>;
+
+    struct Item
+    {
+        size_t seq = 0;
+        TTask task;
+        // Only set with metrics enabled
+        QueueMetrics::Clock::time_point produced;
+    };
+
+    // Result of a task, written by the worker that runs it and read by the
+    // consumer once 'ready' has been set.
+    struct Slot
+    {
+        boost::optional<T> value;
+        std::exception_ptr exc;
+        std::atomic_bool ready{false};
+    };
+
+    // Tasks popped at once by a runner, and their average runtime
+    struct Batch
+    {
+        std::vector<Item> items;
+        double avgTaskNanoseconds = 0;
+    };
+
+    // A popped batch of tasks should take about this long to run ...
+    static constexpr double TargetBatchNanoseconds = 100000;
+    // ... but never contain more than this many tasks.
+    static constexpr size_t MaxBatchSize = 64;
 
 public:
     WorkQueue(const size_t size, const size_t mul = 2)
-        : exc{nullptr}, sz{size * mul}, abort{false}, workersFinalized{false}
-    {
-        for (size_t i = 0; i < size; ++i) {
-            threads.emplace_back(std::thread([this]() {
-                try {
-                    if (abort) return;
-                    while (auto task = PopTask()) {
-                        if (abort) return;
-                        (*task)();
-                    }
-                } catch (...) {
-                    {
-                        std::lock_guard<std::mutex> g(m);
-                        exc = std::current_exception();
-                    }
-                    popped.notify_all();
-                }
-            }));
-        }
+        : WorkQueue{std::make_unique<ThreadPool>(size), nullptr, size, mul}
+    {
+    }
+
+    WorkQueue(ThreadPool& pool, const size_t maxConcurrency, const size_t mul = 2)
+        : WorkQueue{nullptr, &pool, maxConcurrency, mul}
+    {
     }
 
     template <typename F, typename... Args>
     void ProduceWith(F&& f, Args&&... args)
     {
-        std::packaged_task<T()> task{std::bind(std::forward<F>(f), std::forward<Args>(args)...)};
+        Push(produced.fetch_add(1),
+             TTask{internal::Bind(std::forward<F>(f), std::forward<Args>(args)...)});
+    }
 
-        {
-            std::unique_lock<std::mutex> lk(m);
-            popped.wait(lk, [&task, this]() {
-                if (exc) std::rethrow_exception(exc);
+    ///
+    /// Enqueues one task per element of 'items', calling 'f' with that element.
+    /// The tasks are numbered all at once and pushed in order. Result slots
+    /// are reserved, and workers notified, once per run of tasks that fits
+    /// into the queue instead of once per task.
+    ///
+    template <typename F, typename U>
+    void ProduceBatchWith(F&& f, std::vector<U> items)
+    {
+        const size_t first = produced.fetch_add(items.size());
+        size_t i = 0;
+        while (i < items.size()) {
+            const auto start =
+                metrics ? QueueMetrics::Clock::now() : QueueMetrics::Clock::time_point{};
+            WaitFor(slotFreed, [first, i, this]() {
+                return abort || first + i < consumed.load(std::memory_order_acquire) + slots.size();
+            });
+            RethrowIfAborted();
+            if (metrics) metrics->ProducerBlocked(QueueMetrics::Clock::now() - start);
 
-                if (head.size() < sz) {
-                    head.emplace_back(std::move(task));
-                    return true;
-                }
+            // Fill the free slots without blocking, then announce them at once
+            const size_t end = std::min(
+                items.size(), consumed.load(std::memory_order_acquire) + slots.size() - first);
+            size_t run = 0;
+            Item item;
+            for (; i < end; ++i, ++run) {
+                item = Item{first + i, TTask{internal::Bind(f, std::move(items[i]))}, start};
+                if (metrics) metrics->Queued(head.Size());
+                if (!head.TryPush(std::move(item))) break;
+            }
+            if (run > 0) runners.Added(run);
 
-                return false;
-            });
+            // The queue is full, and its tasks keep the runners busy
+            if (i < end) {
+                if (!head.Push(std::move(item))) RethrowIfAborted();
+                runners.Added();
+                ++i;
+            }
         }
-        pushed.notify_one();
     }
 
     template <typename F, typename... Args>
     bool ConsumeWith(F&& cont, Args&&... args)
     {
-        std::deque<TFuture> futs;
-
-        {
-            std::unique_lock<std::mutex> lk(m);
-            popped.wait(lk, [&futs, this]() {
-                if (tail.empty()) return false;
-                tail.swap(futs);
-                return !futs.empty();
-            });
-        }
-        pushed.notify_one();
+        // Results are consumed in production order
+        size_t next = consumed.load(std::memory_order_relaxed);
+        const auto waitStart =
+            metrics ? QueueMetrics::Clock::now() : QueueMetrics::Clock::time_point{};
+        WaitFor(resultReady, [next, this]() {
+            return abort || SlotFor(next).ready.load(std::memory_order_acquire) ||
+                   (workersFinalized && next == produced.load());
+        });
+        if (metrics) metrics->ConsumerBlocked(QueueMetrics::Clock::now() - waitStart);
+        if (abort || !SlotFor(next).ready.load(std::memory_order_acquire)) return false;
 
         try {
-            for (auto& fut : futs) {
-                if (!fut) return false;
-                auto result = fut->get();
+            // Consume the whole run of finished results
+            do {
+                auto& slot = SlotFor(next);
+                if (slot.exc) std::rethrow_exception(slot.exc);
+                T result = std::move(*slot.value);
+                slot.value = boost::none;
+                slot.ready.store(false, std::memory_order_relaxed);
+                consumed.store(++next, std::memory_order_release);
+                slotFreed.NotifyAll();
+
                 cont(std::forward<Args>(args)..., std::move(result));
-            }
-            return true;
+            } while (!abort && SlotFor(next).ready.load(std::memory_order_acquire));
+            return !abort;
         } catch (...) {
-            abort = true;
-            {
-                std::lock_guard<std::mutex> g(m);
-                exc = std::current_exception();
-            }
-            popped.notify_all();
+            Fail(std::current_exception());
         }
         return false;
     }
@@ -110,71 +177,188 @@ public:
     void FinalizeWorkers()
     {
         if (!workersFinalized) {
-            {
-                std::lock_guard<std::mutex> g(m);
-                // Push boost::none to signal that there are no further tasks
-                head.emplace_back(boost::none);
-            }
-            // Let all workers know that they should look that there is no further work
-            pushed.notify_all();
             workersFinalized = true;
+            // The consumer might wait for results that will never come
+            resultReady.NotifyAll();
         }
     }
 
+    ///
+    /// Starts collecting metrics, one worker per concurrently running task.
+    /// Must be called before the first task is produced.
+    ///
+    QueueMetrics& EnableMetrics()
+    {
+        if (!metrics) metrics = std::make_unique<QueueMetrics>(runners.Limit());
+        return *metrics;
+    }
+
+    /// \returns metrics, or nullptr if EnableMetrics() has not been called
+    const QueueMetrics* Metrics() const { return metrics.get(); }
+
     void Finalize()
     {
         FinalizeWorkers();
-        // One last notify in case a consumer exception occured and threads
-        // are still waiting in PopTask wait.
-        pushed.notify_all();
-        // Wait for all threads to join and do not continue before all tasks
-        // have been finished.
-        for (auto& thread : threads)
-            thread.join();
+        // Do not continue before all tasks have been finished.
+        runners.WaitIdle();
 
         // Is there a final exception, throw if so..
-        if (exc) std::rethrow_exception(exc);
+        RethrowIfAborted();
     }
 
 private:
-    TTask PopTask()
+    WorkQueue(std::unique_ptr<ThreadPool> ownPool, ThreadPool* sharedPool, const size_t size,
+              const size_t mul)
+        : ownedPool{std::move(ownPool)}
+        , head{size * mul}
+        , slots(2 * size * mul)
+        , exc{nullptr}
+        , abort{false}
+        , workersFinalized{false}
+        , runners{ownedPool ? *ownedPool : *sharedPool, size,
+                  [this](const size_t slot) { Drain(slot); }}
     {
-        TTask task(boost::none);
+        batches.resize(runners.Limit());
+        for (auto& batch : batches)
+            batch.items.reserve(MaxBatchSize);
+    }
 
-        {
-            std::unique_lock<std::mutex> lk(m);
-            pushed.wait(lk, [&task, this]() {
-                // If a consumer task threw an exception, this is the shortcut
-                // to escape
-                if (abort) return true;
+    static size_t AdaptBatchSize(const double avgTaskNanoseconds)
+    {
+        if (avgTaskNanoseconds <= 0) return 1;
+        const double n = TargetBatchNanoseconds / avgTaskNanoseconds;
+        return static_cast<size_t>(std::max(1.0, std::min<double>(MaxBatchSize, n)));
+    }
 
-                if (head.empty() || tail.size() >= sz) return false;
+    Slot& SlotFor(const size_t seq) { return slots[seq % slots.size()]; }
 
-                if ((task = std::move(head.front()))) {
-                    head.pop_front();
-                    tail.emplace_back(std::move(task->get_future()));
-                } else
-                    tail.emplace_back(boost::none);
+    // Queues the task numbered 'seq', once its result slot is free
+    void Push(const size_t seq, TTask task)
+    {
+        const auto start = metrics ? QueueMetrics::Clock::now() : QueueMetrics::Clock::time_point{};
 
-                return true;
-            });
+        WaitFor(slotFreed, [seq, this]() {
+            return abort || seq < consumed.load(std::memory_order_acquire) + slots.size();
+        });
+        RethrowIfAborted();
+        if (metrics) metrics->Queued(head.Size());
+        if (!head.Push(Item{seq, std::move(task), start})) RethrowIfAborted();
+        if (metrics) metrics->ProducerBlocked(QueueMetrics::Clock::now() - start);
+        runners.Added();
+    }
+
+    // Runs queued tasks on a worker of the pool, until there are none left.
+    // Takes up to a fair share of the queued tasks at a time, as many as run
+    // for about TargetBatchNanoseconds.
+    void Drain(const size_t slot)
+    {
+        auto& batch = batches[slot];
+        try {
+            while (true) {
+                batch.items.clear();
+                const size_t fairShare = (head.Size() + runners.Limit() - 1) / runners.Limit();
+                const size_t n = std::min(AdaptBatchSize(batch.avgTaskNanoseconds),
+                                          std::max<size_t>(1, fairShare));
+                Item item;
+                while (batch.items.size() < n && head.TryPop(item))
+                    batch.items.push_back(std::move(item));
+                if (batch.items.empty()) return;
+                runners.Taken(batch.items.size());
+
+                const auto batchStart = std::chrono::steady_clock::now();
+                for (auto& popped : batch.items) {
+                    // Skip remaining tasks once the queue has been aborted
+                    if (!abort) {
+                        if (metrics) {
+                            const auto start = QueueMetrics::Clock::now();
+                            Run(popped);
+                            const auto end = QueueMetrics::Clock::now();
+                            metrics->TaskFinished(slot, end - popped.produced, end - start);
+                        } else {
+                            Run(popped);
+                        }
+                    }
+                    popped.task = nullptr;
+                }
+                const std::chrono::duration<double, std::nano> elapsed =
+                    std::chrono::steady_clock::now() - batchStart;
+                const double taskNanoseconds = elapsed.count() / batch.items.size();
+                batch.avgTaskNanoseconds =
+                    (batch.avgTaskNanoseconds == 0)
+                        ? taskNanoseconds
+                        : 0.8 * batch.avgTaskNanoseconds + 0.2 * taskNanoseconds;
+            }
+        } catch (...) {
+            batch.items.clear();
+            Fail(std::current_exception());
         }
-        popped.notify_one();  // ProduceWith/ConsumeWith may be waiting
-        pushed.notify_one();  // other PopTask's may also be waiting
+    }
 
-        return task;
+    // Runs a task, storing its result or exception in its slot
+    void Run(Item& item)
+    {
+        auto& slot = SlotFor(item.seq);
+        try {
+            slot.value = item.task();
+        } catch (...) {
+            slot.exc = std::current_exception();
+        }
+        slot.ready.store(true, std::memory_order_release);
+        resultReady.NotifyAll();
+    }
+
+    // Stores the first exception and aborts the queue
+    void Fail(std::exception_ptr e)
+    {
+        {
+            std::lock_guard<std::mutex> g(m);
+            if (!exc) exc = std::move(e);
+        }
+        abort = true;
+        head.Close();
+        resultReady.NotifyAll();
+        slotFreed.NotifyAll();
+    }
+
+    void RethrowIfAborted()
+    {
+        if (abort) {
+            std::lock_guard<std::mutex> g(m);
+            if (exc) std::rethrow_exception(exc);
+        }
+    }
+
+    template <typename Pred>
+    static void WaitFor(internal::EventCount& event, Pred pred)
+    {
+        while (!pred()) {
+            const auto key = event.PrepareWait();
+            if (pred()) {
+                event.CancelWait();
+                return;
+            }
+            event.Wait(key);
+        }
     }
 
-    std::vector<std::thread> threads;
-    std::deque<TTask> head;
-    std::deque<TFuture> tail;
-    std::condition_variable popped;
-    std::condition_variable pushed;
+    // Destroyed last, after all runners have finished
+    std::unique_ptr<ThreadPool> ownedPool;
+    BoundedQueue<Item> head;
+    // Preallocated ring of results, indexed by task number
+    std::vector<Slot> slots;
+    std::atomic<size_t> produced{0};
+    std::atomic<size_t> consumed{0};
+    internal::EventCount resultReady;
+    internal::EventCount slotFreed;
     std::exception_ptr exc;
     std::mutex m;
-    size_t sz;
     std::atomic_bool abort;
     std::atomic_bool workersFinalized;
+    std::unique_ptr<QueueMetrics> metrics;
+    // One per runner slot
+    std::vector<Batch> batches;
+    // Destroyed first, waiting for active runners to access the members above
+    internal::RunnerGroup runners;
 };
 }  // namespace Parallel
 }  // namespace PacBio
@@ -0,0 +1,126 @@
+#ifndef PBCOPPER_PARALLEL_CHANNEL_H
+#define PBCOPPER_PARALLEL_CHANNEL_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+#include <boost/optional.hpp>
+
+namespace PacBio {
+namespace Parallel {
+namespace internal {
+
+///
+/// Bounded blocking queue connecting two pipeline stages.
+///
+/// Close() lets consumers drain the remaining items, Abort() wakes everybody
+/// up and makes all further calls fail immediately, except TryPop.
+///
+/// A stage running on a ThreadPool is notified of pushes and of Close()
+/// through hooks, and takes items with TryPop instead of waiting for them.
+///
+template <typename T>
+class Channel
+{
+public:
+    explicit Channel(const size_t capacity) : capacity_{capacity == 0 ? 1 : capacity} {}
+
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    ///
+    /// Sets the functions called after every push and on Close(). Must be
+    /// called before the channel is used.
+    ///
+    void SetHooks(std::function<void()> onPush, std::function<void()> onClose)
+    {
+        onPush_ = std::move(onPush);
+        onClose_ = std::move(onClose);
+    }
+
+    /// \returns false if the channel has been aborted
+    bool Push(T item)
+    {
+        {
+            std::unique_lock<std::mutex> lk(m_);
+            notFull_.wait(lk, [this]() { return aborted_ || items_.size() < capacity_; });
+            if (aborted_) return false;
+            items_.emplace_back(std::move(item));
+        }
+        notEmpty_.notify_one();
+        if (onPush_) onPush_();
+        return true;
+    }
+
+    /// \returns boost::none if the channel has been aborted, or closed and drained
+    boost::optional<T> Pop()
+    {
+        boost::optional<T> item;
+        {
+            std::unique_lock<std::mutex> lk(m_);
+            notEmpty_.wait(lk, [this]() { return aborted_ || closed_ || !items_.empty(); });
+            if (aborted_ || items_.empty()) return item;
+            item = std::move(items_.front());
+            items_.pop_front();
+        }
+        notFull_.notify_one();
+        return item;
+    }
+
+    /// \returns the oldest item without waiting, if any, also once aborted
+    boost::optional<T> TryPop()
+    {
+        boost::optional<T> item;
+        {
+            std::lock_guard<std::mutex> g(m_);
+            if (items_.empty()) return item;
+            item = std::move(items_.front());
+            items_.pop_front();
+        }
+        notFull_.notify_one();
+        return item;
+    }
+
+    void Close()
+    {
+        {
+            std::lock_guard<std::mutex> g(m_);
+            closed_ = true;
+        }
+        notEmpty_.notify_all();
+        if (onClose_) onClose_();
+    }
+
+    void Abort()
+    {
+        {
+            std::lock_guard<std::mutex> g(m_);
+            aborted_ = true;
+        }
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+    }
+
+private:
+    const size_t capacity_;
+    std::deque<T> items_;
+    bool closed_ = false;
+    bool aborted_ = false;
+    std::mutex m_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::function<void()> onPush_;
+    std::function<void()> onClose_;
+};
+
+}  // namespace internal
+}  // namespace Parallel
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PARALLEL_CHANNEL_H
@@ -0,0 +1,118 @@
+#ifndef PBCOPPER_PARALLEL_EVENTCOUNT_H
+#define PBCOPPER_PARALLEL_EVENTCOUNT_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace PacBio {
+namespace Parallel {
+namespace internal {
+
+///
+/// Futex-style parking primitive for lock-free structures.
+///
+/// Waiters announce themselves before re-checking their condition and only
+/// then go to sleep, so notifiers can skip the mutex and the wakeup entirely
+/// while nobody is parked:
+///
+///     auto key = ec.PrepareWait();
+///     if (conditionMet) ec.CancelWait();
+///     else ec.Wait(key);
+///
+/// A notifier must make its condition visible before calling Notify*().
+///
+class EventCount
+{
+public:
+    using Key = uint32_t;
+
+public:
+    EventCount() = default;
+    EventCount(const EventCount&) = delete;
+    EventCount& operator=(const EventCount&) = delete;
+
+    Key PrepareWait()
+    {
+        const uint64_t prev = state_.fetch_add(WaiterInc, std::memory_order_seq_cst);
+        return static_cast<Key>(prev >> EpochShift);
+    }
+
+    void CancelWait() { state_.fetch_sub(WaiterInc, std::memory_order_seq_cst); }
+
+    void Wait(const Key key)
+    {
+        {
+            std::unique_lock<std::mutex> lk(m_);
+            cv_.wait(lk, [key, this]() { return Epoch() != key; });
+        }
+        state_.fetch_sub(WaiterInc, std::memory_order_seq_cst);
+    }
+
+    ///
+    /// Like Wait, but gives up at 'deadline'.
+    ///
+    /// \returns false if the deadline has passed without a notification
+    ///
+    template <typename Clock, typename Duration>
+    bool WaitUntil(const Key key, const std::chrono::time_point<Clock, Duration>& deadline)
+    {
+        bool notified = false;
+        {
+            std::unique_lock<std::mutex> lk(m_);
+            notified = cv_.wait_until(lk, deadline, [key, this]() { return Epoch() != key; });
+        }
+        state_.fetch_sub(WaiterInc, std::memory_order_seq_cst);
+        return notified;
+    }
+
+    void NotifyOne() { Notify(false); }
+
+    void NotifyAll() { Notify(true); }
+
+private:
+    static constexpr uint64_t WaiterInc = 1;
+    static constexpr uint64_t WaiterMask = 0xFFFFFFFF;
+    static constexpr uint64_t EpochShift = 32;
+    static constexpr uint64_t EpochInc = uint64_t{1} << EpochShift;
+
+    Key Epoch() const
+    {
+        return static_cast<Key>(state_.load(std::memory_order_acquire) >> EpochShift);
+    }
+
+    void Notify(const bool all)
+    {
+        // Orders the notifier's condition, which may have been published by
+        // a plain release store, before reading the number of waiters.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t state = state_.load(std::memory_order_seq_cst);
+        // Nobody is parked, nothing to do. This is the fast path.
+        if ((state & WaiterMask) == 0) return;
+
+        state_.fetch_add(EpochInc, std::memory_order_seq_cst);
+        // Empty critical section: a waiter either sees the new epoch in its
+        // predicate, or is already blocked on the condition variable.
+        {
+            std::lock_guard<std::mutex> g(m_);
+        }
+        if (all)
+            cv_.notify_all();
+        else
+            cv_.notify_one();
+    }
+
+    std::atomic<uint64_t> state_{0};
+    std::mutex m_;
+    std::condition_variable cv_;
+};
+
+}  // namespace internal
+}  // namespace Parallel
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PARALLEL_EVENTCOUNT_H
@@ -0,0 +1,123 @@
+#ifndef PBCOPPER_PARALLEL_RUNNERGROUP_H
+#define PBCOPPER_PARALLEL_RUNNERGROUP_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <pbcopper/parallel/Task.h>
+#include <pbcopper/parallel/ThreadPool.h>
+
+namespace PacBio {
+namespace Parallel {
+namespace internal {
+
+///
+/// Processes the work of one queue on a (shared) ThreadPool, occupying at
+/// most 'limit' of its workers at a time.
+///
+/// The owner announces new work with Added(); while work is pending and
+/// fewer than 'limit' runners are active, a runner task is submitted to the
+/// pool. A runner calls 'drain(slot)', which is expected to take work, call
+/// Taken() per item, and return once it finds nothing left. Every active
+/// runner holds a distinct slot in [0, limit), e.g. to index per-thread data.
+///
+class RunnerGroup
+{
+public:
+    using Drain = Task<void(size_t)>;
+
+public:
+    RunnerGroup(ThreadPool& pool, const size_t limit, Drain drain)
+        : pool_{pool}, limit_{limit == 0 ? 1 : limit}, drain_{std::move(drain)}
+    {
+        freeSlots_.reserve(limit_);
+        for (size_t i = limit_; i > 0; --i)
+            freeSlots_.push_back(i - 1);
+    }
+
+    RunnerGroup(const RunnerGroup&) = delete;
+    RunnerGroup& operator=(const RunnerGroup&) = delete;
+
+    ~RunnerGroup() { WaitIdle(); }
+
+    ThreadPool& Pool() const { return pool_; }
+
+    size_t Limit() const { return limit_; }
+
+    /// Announces 'n' new work items, starting runners if needed.
+    void Added(const int64_t n = 1)
+    {
+        pending_.fetch_add(n, std::memory_order_seq_cst);
+        while (true) {
+            size_t running = running_.load(std::memory_order_seq_cst);
+            const int64_t pending = pending_.load(std::memory_order_seq_cst);
+            if (running >= limit_ || static_cast<int64_t>(running) >= pending) return;
+            if (running_.compare_exchange_weak(running, running + 1, std::memory_order_seq_cst))
+                pool_.Submit([this]() { Run(); });
+        }
+    }
+
+    /// Called by 'drain' for every work item taken.
+    void Taken(const int64_t n = 1) { pending_.fetch_sub(n, std::memory_order_seq_cst); }
+
+    /// Blocks until no runner is active anymore.
+    void WaitIdle()
+    {
+        std::unique_lock<std::mutex> lk(m_);
+        idle_.wait(lk, [this]() { return running_ == 0; });
+    }
+
+private:
+    void Run()
+    {
+        while (true) {
+            size_t slot = 0;
+            {
+                std::lock_guard<std::mutex> g(m_);
+                slot = freeSlots_.back();
+                freeSlots_.pop_back();
+            }
+
+            drain_(slot);
+
+            // Retire under the lock, so that WaitIdle cannot return while
+            // this runner still touches any member
+            std::lock_guard<std::mutex> g(m_);
+            freeSlots_.push_back(slot);
+            running_.fetch_sub(1, std::memory_order_seq_cst);
+
+            // Work announced after 'drain' returned, by a producer that saw
+            // this runner still active, must not be left behind
+            if (pending_.load(std::memory_order_seq_cst) > 0) {
+                size_t running = running_.load(std::memory_order_seq_cst);
+                if (running < limit_ &&
+                    running_.compare_exchange_strong(running, running + 1,
+                                                     std::memory_order_seq_cst))
+                    continue;
+            }
+            idle_.notify_all();
+            return;
+        }
+    }
+
+    ThreadPool& pool_;
+    const size_t limit_;
+    Drain drain_;
+    std::atomic<size_t> running_{0};
+    std::atomic<int64_t> pending_{0};
+    std::mutex m_;
+    std::condition_variable idle_;
+    std::vector<size_t> freeSlots_;
+};
+
+}  // namespace internal
+}  // namespace Parallel
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PARALLEL_RUNNERGROUP_H
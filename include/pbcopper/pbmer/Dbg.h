@@ -8,40 +8,26 @@
 #include <cstddef>
 #include <cstdint>
 
+#include <array>
 #include <map>
 #include <string>
 #include <tuple>
 #include <vector>
 
+#include <pbcopper/parallel/ThreadPool.h>
 #include <pbcopper/pbmer/DbgNode.h>
 #include <pbcopper/pbmer/DnaBit.h>
+#include <pbcopper/pbmer/FrozenDbg.h>
+#include <pbcopper/pbmer/KmerSketch.h>
+#include <pbcopper/pbmer/MappedDbg.h>
 #include <pbcopper/pbmer/Mers.h>
 #include <pbcopper/pbmer/Parser.h>
+#include <pbcopper/pbmer/UnitigGraph.h>
 #include <pbcopper/third-party/robin_hood/robin_hood.h>
 
 namespace PacBio {
 namespace Pbmer {
 
-/*      BubbleInfo
-
-    std::string:
-        KMER + "L" or KMER + "R"
-
-        The KMER is the head of the bubble (e.i `Y` fork).
-        The L and R suffix describe which branch of the bubble.
-
-    std::vector<std::tuple<uint32_t, int, int>>>
-       READID, KMER_COUNT, PATH_LENGTH
-
-       READID documents which reads are in the path.
-       KMER_COUNT documents the number of kmers for a given read over the paths
-       PATH_LENGTH documents the length of a given path. For example,
-       if KMER_COUNT/PATH_LENGTH == 1, then you know the read completely spans
-       the path.
- */
-
-using BubbleInfo = std::map<std::string, std::vector<std::tuple<uint32_t, int, int>>>;
-
 class Dbg
 {
 public:
@@ -53,6 +39,11 @@ public:
     ///
     Dbg(uint8_t kmerSize, uint32_t nr);
 
+    ///
+    /// Loads a graph written by WriteBinary, see MappedDbg.
+    ///
+    explicit Dbg(const MappedDbg& graph);
+
     ///
     /// Adds a Mers object to dbg
     ///
@@ -64,16 +55,76 @@ public:
     ///
     int AddKmers(const PacBio::Pbmer::Mers& m, const uint32_t rid);
 
+    ///
+    /// Same as above, but only adds the kmers that 'solid' counted at least
+    /// 'minFreq' times, so that no node is created for most erroneous
+    /// kmers. See KmerSketch.
+    ///
+    int AddKmers(const PacBio::Pbmer::Mers& m, uint32_t rid, const KmerSketch& solid,
+                 uint8_t minFreq);
+
+    ///
+    /// Adds packed kmers (DnaBit2Bin, with the one-based read id in the low
+    /// 32 bits). Kmers are sorted, and a node is added for every kmer seen
+    /// more than 'minFreqCutoff' times.
+    ///
     void AddKmers(std::vector<BI>& kmers, uint32_t minFreqCutoff);
 
+    ///
+    /// Same as above, but sorts with a parallel radix sort on 'pool', and
+    /// creates the nodes of runs of equal kmers in parallel. Equal kmers
+    /// keep their input order, so a node's strand is that of its first kmer.
+    ///
+    void AddKmers(std::vector<BI>& kmers, uint32_t minFreqCutoff, Parallel::ThreadPool& pool);
+
     void AddVerifedKmerPairs(std::vector<PacBio::Pbmer::DnaBit>& bits, const uint32_t rid);
 
+    ///
+    /// Adds the kmers of many reads in parallel, 'mers[i]' being loaded as
+    /// read 'firstRid + i'. Canonical kmers are partitioned by hash into
+    /// shards, each shard is built without locking by one task of 'pool', and
+    /// the shards are then merged into the graph. The result is the same as
+    /// calling AddKmers(mers[i], firstRid + i) for all reads in order.
+    ///
+    /// \param mers        kmers of each read
+    /// \param pool        threads to build the shards on
+    /// \param firstRid    read id of 'mers[0]'
+    /// \return      1 : everything is okay.
+    ///             -1 : kmer is too large.
+    ///             -2 : kmer length is not odd.
+    ///             -3 : read ids are not within [1, nr].
+    ///
+    int AddKmers(const std::vector<PacBio::Pbmer::Mers>& mers, Parallel::ThreadPool& pool,
+                 uint32_t firstRid = 1);
+
+    ///
+    /// Same as above, but only adds the kmers that 'solid' counted at least
+    /// 'minFreq' times.
+    ///
+    int AddKmers(const std::vector<PacBio::Pbmer::Mers>& mers, Parallel::ThreadPool& pool,
+                 const KmerSketch& solid, uint8_t minFreq, uint32_t firstRid = 1);
+
+    ///
+    /// Parallel AddVerifedKmerPairs, 'bits[i]' being loaded as read
+    /// 'firstRid + i'. See AddKmers above for how the graph is built.
+    ///
+    /// \return      1 : everything is okay.
+    ///             -3 : read ids are not within [1, nr].
+    ///
+    int AddVerifedKmerPairs(std::vector<std::vector<PacBio::Pbmer::DnaBit>>& bits,
+                            Parallel::ThreadPool& pool, uint32_t firstRid = 1);
+
     ///
     /// Iterates over node kmers and checks for all possible out/in bases
     /// {A, C, G, T} and sets the out/in edges. Once this is done edges are set.
     ///
     void BuildEdges();
 
+    ///
+    /// Same as above, probing the nodes in parallel on 'pool'.
+    ///
+    void BuildEdges(Parallel::ThreadPool& pool);
+
     ///
     /// Iterates over node kmers and checks for all possible out/in bases
     /// {A, C, G, T} and sets the out/in edges based on neighbors.
@@ -102,6 +153,15 @@ public:
     ///
     void WriteGraph(std::string fn);
 
+    ///
+    /// Writes nodes, edges and read support to binary file 'fn', to be
+    /// mapped back with MappedDbg. Edges are written as they are, so should be
+    /// built first.
+    ///
+    /// \throws std::runtime_error if the file cannot be written
+    ///
+    void WriteBinary(const std::string& fn) const;
+
     ///
     /// Remove kmers with fewer than N reads covering it. This resets the edges
     ///
@@ -109,6 +169,10 @@ public:
     ///
     void FrequencyFilterNodes(unsigned long n);
 
+    ///
+    /// Same as FrequencyFilterNodes, but keeps the edges valid: only the
+    /// edges of the neighbors of removed nodes are updated.
+    ///
     void FrequencyFilterNodes2(unsigned long n);
 
     ///
@@ -146,10 +210,16 @@ public:
     std::vector<DnaBit> GetLinearPath(uint64_t x) const;
 
     ///
-    /// \return simple bubbles
+    /// \return simple bubbles, found on a frozen copy of the graph
     ///
     BubbleInfo GetBubbles() const;
 
+    ///
+    /// \return read support of simple bubbles, keyed by packed kmer, found in
+    ///         parallel on a frozen copy of the graph, see FrozenDbg::FindBubbles
+    ///
+    std::vector<BubbleSupport> FindBubbles(Parallel::ThreadPool& pool) const;
+
     ////
     /// Removes simple spurs (out edge == 2) from graph. Ties are not resolved.
     ///
@@ -158,6 +228,34 @@ public:
     ///
     int RemoveSpurs(unsigned int maxLength);
 
+    ///
+    /// Removes spurs as RemoveSpurs does, round after round, until none is
+    /// left. Only the first round looks at the whole graph: later rounds
+    /// start from the nodes next to removed spurs, and edges are updated in
+    /// place instead of being rebuilt. Edges must be set, e.g. by BuildEdges.
+    ///
+    /// \param maxLength    only spurs shorter than `maxLength` will be removed
+    /// \return number of spurs trimmed over all rounds
+    ///
+    int TrimSpurs(unsigned int maxLength);
+
+    ///
+    /// \return read-only snapshot of the graph with dense node ids and
+    ///         flat adjacency arrays, see FrozenDbg. It refers to the read
+    ///         ids of this graph and must not be used once it is modified.
+    ///
+    FrozenDbg Freeze() const;
+
+    ///
+    /// Collapses every maximal non-branching path of the graph, following
+    /// the edges set by BuildEdges or AddVerifedKmerPairs, into a unitig,
+    /// with the read support and kmer coverage of its nodes.
+    ///
+    /// \return compacted graph, with one unitig per path and a link for
+    ///         every edge between paths
+    ///
+    UnitigGraph Compact() const;
+
     ///
     /// \return dot formatted string from the graph, useful for testing
     ///
@@ -175,6 +273,38 @@ public:
     bool OneIntermediateNode(uint64_t n1, uint64_t n2, uint64_t* shared) const;
 
 private:
+    struct ShardEntry;
+    using ShardBuckets = std::vector<std::vector<ShardEntry>>;
+
+    // Oriented kmers reachable from 'kmer' (a node's kmer, in either
+    // orientation) by appending a base along the node's edges.
+    //
+    // \returns number of neighbors written to 'next'
+    int Successors(uint64_t kmer, std::array<uint64_t, 4>& next) const;
+
+    // Same as Successors, by prepending a base
+    int Predecessors(uint64_t kmer, std::array<uint64_t, 4>& prev) const;
+
+    // AddKmers of the kmers for which 'keep(canonical kmer)' is true
+    template <typename Keep>
+    int AddKmersIf(const PacBio::Pbmer::Mers& m, uint32_t rid, Keep keep);
+
+    template <typename Keep>
+    int AddKmersIf(const std::vector<PacBio::Pbmer::Mers>& mers, Parallel::ThreadPool& pool,
+                   uint32_t firstRid, Keep keep);
+
+    // edges of 'node' to every kmer of the graph, as set by BuildEdges
+    uint8_t ProbeEdges(const DbgNode& node) const;
+
+    // Erases the nodes of 'kmers', and the edges of their neighbors to
+    // them, appending to 'touched' the neighbors whose edges changed.
+    // Edges are expected to go both ways.
+    void RemoveNodes(const std::vector<uint64_t>& kmers, std::vector<uint64_t>* touched = nullptr);
+
+    // builds one map per shard from the buckets of all batches, then merges
+    // them into dbg_
+    void MergeShards(std::vector<ShardBuckets>& batches, Parallel::ThreadPool& pool);
+
     // the whole graph structure and colors are stored here.
     robin_hood::unordered_map<uint64_t, DbgNode> dbg_;
     // kmer size up to 32
@@ -10,9 +10,8 @@
 
 #include <iterator>
 
-#include <boost/dynamic_bitset.hpp>
-
 #include <pbcopper/pbmer/DnaBit.h>
+#include <pbcopper/pbmer/ReadIdSet.h>
 
 namespace PacBio {
 namespace Pbmer {
@@ -35,6 +34,12 @@ public:
     ///
     bool AddLoad(uint32_t rid);
 
+    ///
+    /// \return zero-based indices of the reads covering the kmer, i.e.
+    ///         every 'rid - 1' passed to AddLoad
+    ///
+    const ReadIdSet& ReadIds() const;
+
     ///
     /// \brief Uses a bit field to set out edges, possibilities {bit0:A, bit2:C,
     ///        bit3:G, bit4:T}
@@ -125,7 +130,8 @@ public:
 private:
     DnaBit dna_;
     uint8_t edges_;
-    boost::dynamic_bitset<> readIds2_;
+    // zero-based indices of the reads covering the kmer
+    ReadIdSet readIds2_;
     friend class Dbg;
 };
 
@@ -0,0 +1,337 @@
+#ifndef PBCOPPER_PBMER_FIXEDDNABIT_H
+#define PBCOPPER_PBMER_FIXEDDNABIT_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <cstdint>
+
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+#include <pbcopper/pbmer/DnaBit.h>
+#include <pbcopper/pbmer/Parser.h>
+
+namespace PacBio {
+namespace Pbmer {
+namespace internal {
+
+__extension__ using UInt128 = unsigned __int128;
+
+///
+/// Smallest word holding K packed bases.
+///
+template <int K>
+using FixedKmerWord =
+    std::conditional_t<(K <= 16), uint32_t, std::conditional_t<(K <= 32), uint64_t, UInt128>>;
+
+///
+/// Complements and reverses all 32 bases of 'mer'.
+///
+inline uint64_t ReverseCompAll64(const uint64_t mer)
+{
+    uint64_t res = ~mer;
+    res = ((res >> 2 & 0x3333333333333333) | (res & 0x3333333333333333) << 2);
+    res = ((res >> 4 & 0x0F0F0F0F0F0F0F0F) | (res & 0x0F0F0F0F0F0F0F0F) << 4);
+    res = ((res >> 8 & 0x00FF00FF00FF00FF) | (res & 0x00FF00FF00FF00FF) << 8);
+    res = ((res >> 16 & 0x0000FFFF0000FFFF) | (res & 0x0000FFFF0000FFFF) << 16);
+    res = ((res >> 32 & 0x00000000FFFFFFFF) | (res & 0x00000000FFFFFFFF) << 32);
+    return res;
+}
+
+///
+/// Mix64Masked with a precomputed mask.
+///
+inline uint64_t Mix64(const uint64_t key, const uint64_t mask)
+{
+    uint64_t res = key;
+    res = (~res + (res << 21)) & mask;
+    res = res ^ (res >> 24);
+    res = ((res + (res << 3)) + (res << 8)) & mask;
+    res = res ^ (res >> 14);
+    res = ((res + (res << 2)) + (res << 4)) & mask;
+    res = res ^ (res >> 28);
+    res = (res + (res << 31)) & mask;
+    return res;
+}
+
+///
+/// Mask of the low 2 * K bits, K in [1, 32].
+///
+template <int K>
+constexpr uint64_t KmerMask64()
+{
+    return ~uint64_t{0} >> (64 - 2 * K);
+}
+
+///
+/// Word operations of FixedDnaBit<K>, for kmers of one machine word (K <= 32)
+/// and of two (K > 32).
+///
+template <int K, bool Wide = (K > 32)>
+struct FixedKmerOps
+{
+    using Word = FixedKmerWord<K>;
+    using Hash = uint64_t;
+
+    static constexpr Word Mask() { return static_cast<Word>(KmerMask64<K>()); }
+
+    static Word ReverseComp(const Word mer)
+    {
+        return static_cast<Word>(ReverseCompAll64(mer) >> (64 - 2 * K));
+    }
+
+    static Hash Mix(const Word mer) { return Mix64(mer, KmerMask64<K>()); }
+};
+
+template <int K>
+struct FixedKmerOps<K, true>
+{
+    using Word = UInt128;
+    using Hash = UInt128;
+
+    static constexpr Word Mask() { return ~Word{0} >> (128 - 2 * K); }
+
+    static Word ReverseComp(const Word mer)
+    {
+        const Word all = (Word{ReverseCompAll64(static_cast<uint64_t>(mer))} << 64) |
+                         ReverseCompAll64(static_cast<uint64_t>(mer >> 64));
+        return all >> (128 - 2 * K);
+    }
+
+    // the low 32 bases and the K - 32 above them are mixed separately, which
+    // keeps the hash a bijection
+    static Hash Mix(const Word mer)
+    {
+        return (Hash{Mix64(static_cast<uint64_t>(mer >> 64), KmerMask64<K - 32>())} << 64) |
+               Mix64(static_cast<uint64_t>(mer), ~uint64_t{0});
+    }
+};
+
+template <int... Ks>
+struct KmerSizeList
+{
+};
+
+template <typename R, typename F>
+R DispatchKmerSize(const uint8_t kmerSize, F&&, KmerSizeList<>)
+{
+    throw std::invalid_argument{"[pbmer] kmer size ERROR: no fixed-size kmers for size " +
+                                std::to_string(kmerSize)};
+}
+
+template <typename R, typename F, int K, int... Ks>
+R DispatchKmerSize(const uint8_t kmerSize, F&& f, KmerSizeList<K, Ks...>)
+{
+    if (kmerSize == K) {
+        return f(std::integral_constant<int, K>{});
+    }
+    return DispatchKmerSize<R>(kmerSize, f, KmerSizeList<Ks...>{});
+}
+
+// Sizes instantiated by DispatchKmerSize
+using DispatchedKmerSizes = KmerSizeList<11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31>;
+
+}  // namespace internal
+
+///
+/// DnaBit with a kmer size known at compile time, K in [1, 63].
+///
+/// Masks and shifts are constants, and the kmer is stored in the smallest
+/// word that fits: uint32_t up to 16 bp (half the size of a DnaBit),
+/// uint64_t up to 32 bp and unsigned __int128 above. Methods behave as those
+/// of DnaBit of the same name, for K < 32.
+///
+/// Kmers up to 32 bp are hashed with Mix64Masked. Longer kmers are hashed as
+/// their high K - 32 and low 32 bases, each with Mix64Masked.
+///
+template <int K>
+class FixedDnaBit
+{
+    static_assert(K >= 1 && K <= 63, "FixedDnaBit kmer size must be in [1, 63]");
+
+    using Ops = internal::FixedKmerOps<K>;
+
+public:
+    using Word = typename Ops::Word;
+    using Hash = typename Ops::Hash;
+
+    static constexpr int KmerSize() { return K; }
+    static constexpr Word Mask() { return Ops::Mask(); }
+
+    // K DNA bases packed in the low bits, as in DnaBit
+    Word mer = 0;
+    // 0:+ forward strand ; 1:- reverse strand
+    uint8_t strand = 0;
+
+    FixedDnaBit() = default;
+    FixedDnaBit(Word k, uint8_t s) : mer{k}, strand{s} {}
+
+    ///
+    /// Converts a DnaBit of K bp, K <= 32.
+    ///
+    /// \throws std::invalid_argument if the DnaBit size is not K
+    ///
+    explicit FixedDnaBit(const DnaBit& bit);
+
+    ///
+    /// \return the kmer as a DnaBit, K <= 32
+    ///
+    DnaBit ToDnaBit() const;
+
+    ///
+    /// \return hash of 'mer', as Mix64Masked(mer, K)
+    ///
+    static Hash HashMer(Word mer) { return Ops::Mix(mer); }
+
+    ///
+    /// \return reverse complement of 'mer', as ReverseComp64(mer, K)
+    ///
+    static Word ReverseCompMer(Word mer) { return Ops::ReverseComp(mer); }
+
+    ///
+    /// \return hash of the kmer
+    ///
+    Hash HashValue() const { return HashMer(mer); }
+
+    // Ignores strand, compares hashed kmer.
+    bool operator<(const FixedDnaBit& b) const { return HashValue() < b.HashValue(); }
+    bool operator>(const FixedDnaBit& b) const { return b < *this; }
+    bool operator<=(const FixedDnaBit& b) const { return !(b < *this); }
+    bool operator>=(const FixedDnaBit& b) const { return !(*this < b); }
+
+    // Checks strand, not hashed kmer.
+    bool operator==(const FixedDnaBit& b) const
+    {
+        return std::tie(mer, strand) == std::tie(b.mer, b.strand);
+    }
+    bool operator!=(const FixedDnaBit& b) const { return !(*this == b); }
+
+    ///
+    /// Reverse complements the kmer in place.
+    ///
+    void ReverseComp();
+
+    ///
+    /// \places the smaller kmer (forward/reverse).
+    ///
+    void MakeLexSmaller();
+
+    ///
+    /// \places the hashed smaller kmer (forward/reverse).
+    ///
+    void MakeLexSmallerHashed();
+
+    ///
+    /// Put a base at the end of the kmer
+    ///
+    void AppendBase(uint8_t c) { mer = ((mer << 2) & Mask()) | (c % 4); }
+    void AppendBase(char c) { AppendBase(AsciiToDna[static_cast<uint8_t>(c)]); }
+
+    ///
+    /// Put a base at the beginning of kmer
+    ///
+    void PrependBase(uint8_t c) { mer = (Word(c % 4) << (2 * (K - 1))) | (mer >> 2); }
+    void PrependBase(char c) { PrependBase(AsciiToDna[static_cast<uint8_t>(c)]); }
+
+    uint8_t GetFirstBaseIdx() const { return static_cast<uint8_t>((mer >> (2 * (K - 1))) & 3); }
+    uint8_t GetLastBaseIdx() const { return static_cast<uint8_t>(mer & 3); }
+
+    ///
+    /// \return the kmer as a printable string;
+    ///
+    std::string KmerToStr() const;
+};
+
+///
+/// Calls 'f(std::integral_constant<int, K>{})' with K = 'kmerSize', so that
+/// code written for FixedDnaBit<K> or FixedParser<K> can be picked from a
+/// runtime kmer size. All calls must return the same type.
+///
+/// \code{.cpp}
+///    const auto numKmers = DispatchKmerSize(kmerSize, [&](auto k) {
+///        return FixedParser<decltype(k)::value>{}.ParseDnaBit(dna).size();
+///    });
+/// \endcode
+///
+/// Odd kmer sizes from 11 to 31 are instantiated.
+///
+/// \throws std::invalid_argument for other kmer sizes
+///
+template <typename F>
+auto DispatchKmerSize(const uint8_t kmerSize, F&& f)
+    -> decltype(f(std::integral_constant<int, 11>{}))
+{
+    using R = decltype(f(std::integral_constant<int, 11>{}));
+    return internal::DispatchKmerSize<R>(kmerSize, f, internal::DispatchedKmerSizes{});
+}
+
+///
+/// \return true if DispatchKmerSize handles 'kmerSize'
+///
+inline bool IsDispatchedKmerSize(const uint8_t kmerSize)
+{
+    return kmerSize >= 11 && kmerSize <= 31 && (kmerSize % 2) == 1;
+}
+
+template <int K>
+FixedDnaBit<K>::FixedDnaBit(const DnaBit& bit) : mer{static_cast<Word>(bit.mer)}, strand{bit.strand}
+{
+    static_assert(K <= 32, "DnaBit holds at most 32 bp");
+    if (bit.msize != K) {
+        throw std::invalid_argument{"[pbmer] kmer size ERROR: expected a DnaBit of " +
+                                    std::to_string(K) + " bp, got " + std::to_string(bit.msize)};
+    }
+}
+
+template <int K>
+DnaBit FixedDnaBit<K>::ToDnaBit() const
+{
+    static_assert(K <= 32, "DnaBit holds at most 32 bp");
+    return DnaBit{static_cast<uint64_t>(mer), strand, static_cast<uint8_t>(K)};
+}
+
+template <int K>
+void FixedDnaBit<K>::ReverseComp()
+{
+    mer = ReverseCompMer(mer);
+    strand = !strand;
+}
+
+template <int K>
+void FixedDnaBit<K>::MakeLexSmaller()
+{
+    const Word rc = ReverseCompMer(mer);
+    if (rc <= mer) {
+        mer = rc;
+        strand = !strand;
+    }
+}
+
+template <int K>
+void FixedDnaBit<K>::MakeLexSmallerHashed()
+{
+    const Word rc = ReverseCompMer(mer);
+    if (HashMer(rc) <= HashMer(mer)) {
+        mer = rc;
+        strand = !strand;
+    }
+}
+
+template <int K>
+std::string FixedDnaBit<K>::KmerToStr() const
+{
+    constexpr const std::array<char, 4> lookup{'A', 'C', 'G', 'T'};
+    std::string bases(K, 'A');
+    for (int i = 0; i < K; ++i) {
+        bases[i] = lookup[static_cast<uint8_t>(mer >> (2 * (K - i - 1))) & 3];
+    }
+    return bases;
+}
+
+}  // namespace Pbmer
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PBMER_FIXEDDNABIT_H
@@ -0,0 +1,85 @@
+#ifndef PBCOPPER_PBMER_FIXEDPARSER_H
+#define PBCOPPER_PBMER_FIXEDPARSER_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <cstddef>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pbcopper/pbmer/FixedDnaBit.h>
+#include <pbcopper/pbmer/internal/BaseEncoding.h>
+
+namespace PacBio {
+namespace Pbmer {
+
+///
+/// Parser::ParseDnaBit for a kmer size 'K' known at compile time, producing
+/// FixedDnaBit<K>. Kmers are rolled with constant masks and shifts, in the
+/// word size of FixedDnaBit<K>, so K may be up to 63.
+///
+/// See DispatchKmerSize to pick K from a runtime kmer size.
+///
+template <int K>
+class FixedParser
+{
+public:
+    using DnaBitType = FixedDnaBit<K>;
+
+    ///
+    /// Calls 'f(forward, reverse)' with the FixedDnaBit<K> of every kmer of
+    /// 'dna' and of its reverse complement, skipping kmers with unknown bases.
+    ///
+    template <typename F>
+    void ForEachKmer(const std::string& dna, F&& f) const;
+
+    ///
+    /// Convert a std::string into a FixedDnaBit vector.
+    ///
+    std::vector<DnaBitType> ParseDnaBit(const std::string& dna) const;
+
+    ///
+    /// Convert a std::string into a FixedDnaBit vector, reusing a vector.
+    ///
+    void ParseDnaBit(const std::string& dna, std::vector<DnaBitType>& kms) const;
+};
+
+template <int K>
+template <typename F>
+void FixedParser<K>::ForEachKmer(const std::string& dna, F&& f) const
+{
+    using Word = typename DnaBitType::Word;
+    internal::ForEachFixedKmer<Word, K>(dna.data(), dna.size(),
+                                        [&](const Word forward, const Word reverse) {
+                                            f(DnaBitType{forward, 0}, DnaBitType{reverse, 1});
+                                        },
+                                        []() {});
+}
+
+template <int K>
+std::vector<FixedDnaBit<K>> FixedParser<K>::ParseDnaBit(const std::string& dna) const
+{
+    std::vector<DnaBitType> kms;
+    if (dna.size() >= static_cast<size_t>(K)) kms.reserve(dna.size() - K + 1);
+    ParseDnaBit(dna, kms);
+    return kms;
+}
+
+template <int K>
+void FixedParser<K>::ParseDnaBit(const std::string& dna, std::vector<DnaBitType>& kms) const
+{
+    if (dna.size() < static_cast<size_t>(K))
+        throw std::runtime_error{"[pbmer] parsing ERROR: DNA sequence shorter than kmer size."};
+
+    using Word = typename DnaBitType::Word;
+    internal::ForEachFixedKmer<Word, K>(
+        dna.data(), dna.size(), [&](const Word forward, Word) { kms.emplace_back(forward, 0); },
+        []() {});
+}
+
+}  // namespace Pbmer
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PBMER_FIXEDPARSER_H
@@ -0,0 +1,219 @@
+#ifndef PBCOPPER_PBMER_FROZENDBG_H
+#define PBCOPPER_PBMER_FROZENDBG_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <limits>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <pbcopper/parallel/ThreadPool.h>
+#include <pbcopper/pbmer/DnaBit.h>
+#include <pbcopper/pbmer/ReadIdSet.h>
+#include <pbcopper/third-party/robin_hood/robin_hood.h>
+
+namespace PacBio {
+namespace Pbmer {
+
+/*      BubbleInfo
+
+    std::string:
+        KMER + "L" or KMER + "R"
+
+        The KMER is the head of the bubble (e.i `Y` fork).
+        The L and R suffix describe which branch of the bubble.
+
+    std::vector<std::tuple<uint32_t, int, int>>>
+       READID, KMER_COUNT, PATH_LENGTH
+
+       READID documents which reads are in the path.
+       KMER_COUNT documents the number of kmers for a given read over the paths
+       PATH_LENGTH documents the length of a given path. For example,
+       if KMER_COUNT/PATH_LENGTH == 1, then you know the read completely spans
+       the path.
+ */
+
+using BubbleInfo = std::map<std::string, std::vector<std::tuple<uint32_t, int, int>>>;
+
+enum class BubbleSide : uint8_t
+{
+    LEFT,
+    RIGHT
+};
+
+///
+/// Support of one read for one side of a simple bubble: a BubbleInfo entry
+/// keyed by packed kmer instead of by string.
+///
+struct BubbleSupport
+{
+    // lex smaller kmer of the bubble head, the KMER of BubbleInfo
+    uint64_t head;
+    BubbleSide side;
+    // one-based read id
+    uint32_t readId;
+    // number of kmers of the read over the path
+    uint32_t kmerCount;
+    // number of nodes in the path
+    uint32_t pathLength;
+};
+
+inline bool operator==(const BubbleSupport& lhs, const BubbleSupport& rhs)
+{
+    return std::tie(lhs.head, lhs.side, lhs.readId, lhs.kmerCount, lhs.pathLength) ==
+           std::tie(rhs.head, rhs.side, rhs.readId, rhs.kmerCount, rhs.pathLength);
+}
+
+///
+/// Read-only snapshot of a Dbg, as returned by Dbg::Freeze, for traversals.
+///
+/// Nodes get dense ids, in the iteration order of the Dbg, and their payloads
+/// are stored in parallel arrays. The neighbors of node 'id' are stored
+/// contiguously, as ids, in the order DbgNode iterates them, so walking the
+/// graph needs no kmer rebuilding and no hash lookups. Edges to kmers that
+/// are not in the graph are dropped.
+///
+/// Read ids are not copied: a FrozenDbg must not outlive its Dbg, and is
+/// invalidated by any change to it.
+///
+class FrozenDbg
+{
+public:
+    static constexpr uint32_t NoNode = std::numeric_limits<uint32_t>::max();
+
+    class NeighborRange
+    {
+    public:
+        NeighborRange(const uint32_t* first, const uint32_t* last) : first_{first}, last_{last} {}
+        const uint32_t* begin() const { return first_; }
+        const uint32_t* end() const { return last_; }
+        size_t size() const { return last_ - first_; }
+
+    private:
+        const uint32_t* first_;
+        const uint32_t* last_;
+    };
+
+    ///
+    /// \return number of nodes
+    ///
+    size_t NNodes() const;
+
+    ///
+    /// \return number of edges, counting both directions
+    ///
+    size_t NEdges() const;
+
+    ///
+    /// \return kmer size in bp
+    ///
+    uint8_t KmerSize() const;
+
+    ///
+    /// \return id of the node of 'kmer' (lex smaller kmer), or NoNode
+    ///
+    uint32_t Id(uint64_t kmer) const;
+
+    ///
+    /// \return lex smaller kmer of node 'id'
+    ///
+    uint64_t Kmer(uint32_t id) const;
+
+    ///
+    /// \return kmer of node 'id', with the strand it was first seen on
+    ///
+    DnaBit Dna(uint32_t id) const;
+
+    ///
+    /// \return number of neighbors of node 'id'
+    ///
+    uint32_t Degree(uint32_t id) const;
+
+    ///
+    /// \return neighbor ids of node 'id'
+    ///
+    NeighborRange Neighbors(uint32_t id) const;
+
+    ///
+    /// \return zero-based indices of the reads covering node 'id'
+    ///
+    const ReadIdSet& ReadIds(uint32_t id) const;
+
+    ///
+    /// \return number of reads covering node 'id'
+    ///
+    uint32_t ReadCount(uint32_t id) const;
+
+    ///
+    /// Same as Dbg::GetLinearPath, on node ids.
+    ///
+    /// \return nodes in the path including the starting node
+    ///
+    std::vector<uint32_t> GetLinearPath(uint32_t id) const;
+
+    ///
+    /// Same as Dbg::OneIntermediateNode, on node ids.
+    ///
+    bool OneIntermediateNode(uint32_t n1, uint32_t n2, uint32_t* shared) const;
+
+    ///
+    /// Same as Dbg::GetBubbles, with the reads of each side in increasing
+    /// read id order.
+    ///
+    BubbleInfo GetBubbles() const;
+
+    ///
+    /// Finds the same bubbles as GetBubbles, without building strings.
+    ///
+    /// \return read support of every bubble side, ordered by head, side
+    ///         and read id
+    ///
+    std::vector<BubbleSupport> FindBubbles() const;
+
+    ///
+    /// Same as above, with the branching nodes and the read support of
+    /// bubbles processed in parallel on 'pool'. The result does not depend on
+    /// the number of threads.
+    ///
+    std::vector<BubbleSupport> FindBubbles(Parallel::ThreadPool& pool) const;
+
+    ///
+    /// \return node ids of every spur, i.e. every linear path of at most
+    ///         'maxLength' nodes starting at a tip, as removed by
+    ///         Dbg::RemoveSpurs
+    ///
+    std::vector<std::vector<uint32_t>> GetSpurs(unsigned int maxLength) const;
+
+private:
+    friend class Dbg;
+
+    // GetLinearPath into 'path'
+    void LinearPath(uint32_t id, std::vector<uint32_t>& path) const;
+
+    // FindBubbles, with 'forEach(n, f)' calling 'f(i)' for i in [0, n)
+    template <typename ForEach>
+    std::vector<BubbleSupport> FindBubbles(ForEach&& forEach) const;
+
+    uint8_t kmerSize_ = 0;
+    robin_hood::unordered_map<uint64_t, uint32_t> ids_;
+
+    // node payloads, by id
+    std::vector<uint64_t> kmers_;
+    std::vector<uint8_t> strands_;
+    std::vector<uint32_t> readCounts_;
+    std::vector<const ReadIdSet*> readIds_;
+
+    // neighbors of node 'id' are neighbors_[offsets_[id], offsets_[id + 1])
+    std::vector<uint32_t> offsets_;
+    std::vector<uint32_t> neighbors_;
+};
+
+}  // namespace Pbmer
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PBMER_FROZENDBG_H
@@ -0,0 +1,83 @@
+#ifndef PBCOPPER_PBMER_HASHEDSORT_H
+#define PBCOPPER_PBMER_HASHEDSORT_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <cstdint>
+
+#include <vector>
+
+#include <pbcopper/parallel/ThreadPool.h>
+#include <pbcopper/pbmer/DnaBit.h>
+#include <pbcopper/pbmer/Kmer.h>
+
+namespace PacBio {
+namespace Pbmer {
+
+///
+/// Bulk versions of the hashed DnaBit operations. Every kmer is hashed once
+/// (Mix64Masked), where std::sort with DnaBit::operator< hashes both sides of
+/// every comparison, and the hashes are then radix sorted as 64-bit keys.
+///
+/// Mix64Masked is a bijection of kmers of a given size, so kmers with equal
+/// keys are equal. As for std::sort, the order of equal kmers (e.g. of
+/// different strands) is unspecified.
+///
+
+///
+/// Sorts 'bits' by Mix64Masked(mer, msize), i.e. as std::sort with
+/// DnaBit::operator<.
+///
+void SortHashed(std::vector<DnaBit>& bits);
+
+///
+/// Same as above, hashing and sorting in parallel on 'pool'.
+///
+void SortHashed(std::vector<DnaBit>& bits, Parallel::ThreadPool& pool);
+
+///
+/// Sorts 'kmers' of 'kmerSize' bases by Mix64Masked(mer, kmerSize).
+///
+void SortHashed(std::vector<Kmer>& kmers, uint8_t kmerSize);
+
+///
+/// Same as above, hashing and sorting in parallel on 'pool'.
+///
+void SortHashed(std::vector<Kmer>& kmers, uint8_t kmerSize, Parallel::ThreadPool& pool);
+
+///
+/// Calls DnaBit::MakeLexSmallerHashed on every element of 'bits', hashing
+/// each kmer and its reverse complement once.
+///
+void MakeLexSmallerHashed(std::vector<DnaBit>& bits);
+
+///
+/// Same as above, in parallel on 'pool'.
+///
+void MakeLexSmallerHashed(std::vector<DnaBit>& bits, Parallel::ThreadPool& pool);
+
+///
+/// MakeLexSmallerHashed then SortHashed, using the hash computed for the
+/// kept strand as sort key, so that each kmer is hashed twice in all.
+///
+void CanonicalSortHashed(std::vector<DnaBit>& bits);
+
+///
+/// Same as above, in parallel on 'pool'.
+///
+void CanonicalSortHashed(std::vector<DnaBit>& bits, Parallel::ThreadPool& pool);
+
+///
+/// Calls DnaBit::MakeLexSmaller on every element of 'bits'.
+///
+void MakeLexSmaller(std::vector<DnaBit>& bits);
+
+///
+/// Same as above, in parallel on 'pool'.
+///
+void MakeLexSmaller(std::vector<DnaBit>& bits, Parallel::ThreadPool& pool);
+
+}  // namespace Pbmer
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PBMER_HASHEDSORT_H
@@ -0,0 +1,150 @@
+#ifndef PBCOPPER_PBMER_KMERCOUNTER_H
+#define PBCOPPER_PBMER_KMERCOUNTER_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pbcopper/parallel/ThreadPool.h>
+
+namespace PacBio {
+namespace Pbmer {
+
+///
+/// Counts canonical kmers (the smaller of a kmer and its reverse
+/// complement), without building a Dbg.
+///
+/// Reads are split into kmers as Parser does, without materializing them.
+/// Kmers are partitioned by hash, and each partition is an open addressing
+/// table of packed kmers and 32-bit counts, so that a kmer costs about 12
+/// bytes at most load factors and counting a batch of reads in parallel
+/// needs no locking.
+///
+class KmerCounter
+{
+public:
+    ///
+    /// \param kmerSize         kmer size in bp, in [1, 32]
+    /// \param numPartitions    number of hash partitions, rounded up to a
+    ///                         power of two
+    ///
+    /// \throws std::invalid_argument if kmerSize is out of range
+    ///
+    explicit KmerCounter(uint8_t kmerSize, size_t numPartitions = 64);
+
+    ///
+    /// Counts the kmers of 'dna'. Kmers with bases other than ACGT are
+    /// skipped.
+    ///
+    void AddRead(const std::string& dna);
+
+    ///
+    /// Counts the kmers of all 'reads' in rounds of about 'basesPerRound'
+    /// bases (at least one read): the reads of a round are split into
+    /// partition buckets in parallel, then each partition is counted on one
+    /// task of 'pool'. Buckets take 8 bytes per kmer of a round, on top of
+    /// the tables.
+    ///
+    void AddReads(const std::vector<std::string>& reads, Parallel::ThreadPool& pool,
+                  size_t basesPerRound = size_t{1} << 22);
+
+    ///
+    /// \return kmer size in bp
+    ///
+    uint8_t KmerSize() const;
+
+    ///
+    /// \return number of distinct canonical kmers
+    ///
+    size_t NumDistinct() const;
+
+    ///
+    /// \return number of kmers counted, i.e. the sum of all counts
+    ///
+    uint64_t NumTotal() const;
+
+    ///
+    /// \return number of occurrences of canonical kmer 'kmer'
+    ///
+    uint32_t Count(uint64_t kmer) const;
+
+    ///
+    /// \return kmer spectrum: element c is the number of distinct kmers seen
+    ///         c times, for c in [1, maxCount), and element maxCount the
+    ///         number of those seen maxCount times or more. Ends at the
+    ///         largest count seen, if that is below maxCount.
+    ///
+    /// \throws std::invalid_argument if maxCount is 0
+    ///
+    std::vector<uint64_t> Histogram(uint32_t maxCount = 1000) const;
+
+    ///
+    /// \return (canonical kmer, count) of the kmers seen at least 'minCount'
+    ///         times, in increasing kmer order
+    ///
+    std::vector<std::pair<uint64_t, uint32_t>> SortedCounts(uint32_t minCount = 1) const;
+
+    ///
+    /// Writes SortedCounts(minCount) to binary file 'fn': the magic
+    /// "PBMERKMC", a uint32_t version (1), a uint32_t kmer size and a
+    /// uint64_t number of kmers, followed by the uint64_t kmers and then
+    /// the uint32_t counts, in native byte order.
+    ///
+    /// \throws std::runtime_error if the file cannot be written
+    ///
+    void WriteSorted(const std::string& fn, uint32_t minCount = 1) const;
+
+    ///
+    /// \return memory used by the tables, in bytes
+    ///
+    size_t MemoryUsage() const;
+
+private:
+    class Partition
+    {
+    public:
+        void Add(uint64_t kmer, uint64_t hash, uint32_t n = 1);
+        uint32_t Count(uint64_t kmer, uint64_t hash) const;
+
+        // calls 'f(kmer, count)' for every kmer in the table
+        template <typename F>
+        void ForEach(F&& f) const;
+
+        size_t Size() const;
+        size_t MemoryUsage() const;
+
+    private:
+        void Grow();
+
+        // ~0 marks an empty slot, as it is never a canonical kmer
+        std::vector<uint64_t> kmers_;
+        std::vector<uint32_t> counts_;
+        size_t size_ = 0;
+    };
+
+    size_t PartitionOf(uint64_t hash) const;
+
+    uint8_t kmerSize_;
+    int partitionBits_;
+    std::vector<Partition> partitions_;
+};
+
+template <typename F>
+void KmerCounter::Partition::ForEach(F&& f) const
+{
+    for (size_t i = 0; i < kmers_.size(); ++i) {
+        if (kmers_[i] != ~uint64_t{0}) {
+            f(kmers_[i], counts_[i]);
+        }
+    }
+}
+
+}  // namespace Pbmer
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PBMER_KMERCOUNTER_H
@@ -0,0 +1,96 @@
+#ifndef PBCOPPER_PBMER_KMERSKETCH_H
+#define PBCOPPER_PBMER_KMERSKETCH_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <vector>
+
+#include <pbcopper/pbmer/Mers.h>
+
+namespace PacBio {
+namespace Pbmer {
+
+///
+/// Count-min sketch of kmer occurrences, in a fixed amount of memory.
+///
+/// Each kmer maps to one 8-bit counter in each of 'Depth()' rows, and its
+/// count is the smallest of these. Counts never underestimate (up to the
+/// saturation value MaxCount), so filtering on them never drops a kmer seen
+/// often enough; overestimates shrink with Width(). Counters are updated
+/// conservatively: only those equal to the current estimate are increased.
+///
+/// Used as a prefilter, so that a Dbg only creates nodes for solid kmers:
+///
+///     KmerSketch sketch{1 << 30};
+///     for (const auto& m : mers) sketch.AddKmers(m);
+///     for (size_t i = 0; i < mers.size(); ++i)
+///         dbg.AddKmers(mers[i], i + 1, sketch, minFreq);
+///     dbg.FrequencyFilterNodes(minFreq);  // exact, on far fewer nodes
+///
+class KmerSketch
+{
+public:
+    static constexpr uint8_t MaxCount = 255;
+
+    ///
+    /// \param memoryBytes  counter memory, rounded down to 'depth' rows of a
+    ///                     power of two counters, at least 64 each
+    /// \param depth        number of rows, in [1, 8]
+    ///
+    /// \throws std::invalid_argument if depth is out of range
+    ///
+    explicit KmerSketch(size_t memoryBytes, int depth = 4);
+
+    ///
+    /// Counts one occurrence of 'kmer'.
+    ///
+    void Add(uint64_t kmer);
+
+    ///
+    /// Counts the lex smaller form of every forward kmer of 'm', as Dbg
+    /// stores them.
+    ///
+    void AddKmers(const Mers& m);
+
+    ///
+    /// \return estimated number of occurrences of 'kmer', saturating at
+    ///         MaxCount
+    ///
+    uint8_t Count(uint64_t kmer) const;
+
+    ///
+    /// Adds the counts of 'other', e.g. one sketch per thread of input.
+    ///
+    /// \throws std::invalid_argument if the sketches differ in shape
+    ///
+    void Merge(const KmerSketch& other);
+
+    ///
+    /// Resets all counts to zero.
+    ///
+    void Clear();
+
+    size_t Width() const;
+    int Depth() const;
+
+    ///
+    /// \return counter memory in bytes
+    ///
+    size_t MemoryUsage() const;
+
+private:
+    // counter indices of 'kmer' in each row, within counts_
+    void Slots(uint64_t kmer, size_t* slots) const;
+
+    size_t width_;
+    int depth_;
+    std::vector<uint8_t> counts_;
+};
+
+}  // namespace Pbmer
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PBMER_KMERSKETCH_H
@@ -0,0 +1,158 @@
+#ifndef PBCOPPER_PBMER_MAPPEDDBG_H
+#define PBCOPPER_PBMER_MAPPEDDBG_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <limits>
+#include <string>
+
+#include <pbcopper/pbmer/DnaBit.h>
+
+namespace PacBio {
+namespace Pbmer {
+
+///
+/// Read-only De Bruijn graph, memory-mapped from a file written by
+/// Dbg::WriteBinary.
+///
+/// The file holds, after a fixed header, one array per node field: sorted
+/// lex smaller kmers, strands, edge bitfields (as in DbgNode), and the read
+/// support as per-node offsets into one array of zero-based read indices.
+/// Nothing is copied or rebuilt on load; kmers are looked up by binary
+/// search and pages are only read when first touched.
+///
+/// Format (native byte order, every array starting at a multiple of 8):
+///
+///     header      magic "PBMERDBG", version, kmer size, number of reads,
+///                 nodes and read indices
+///     kmers       uint64_t[nodes], increasing
+///     readOffsets uint64_t[nodes + 1]
+///     readIds     uint32_t[read indices], increasing within a node
+///     edges       uint8_t[nodes]
+///     strands     uint8_t[nodes]
+///
+class MappedDbg
+{
+public:
+    static constexpr uint32_t NoNode = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t Version = 1;
+
+    class ReadIdRange
+    {
+    public:
+        ReadIdRange(const uint32_t* first, const uint32_t* last) : first_{first}, last_{last} {}
+        const uint32_t* begin() const { return first_; }
+        const uint32_t* end() const { return last_; }
+        size_t size() const { return last_ - first_; }
+
+    private:
+        const uint32_t* first_;
+        const uint32_t* last_;
+    };
+
+    ///
+    /// Maps graph file 'fn'.
+    ///
+    /// \throws std::runtime_error if the file cannot be mapped, or is not a
+    ///         graph file of this version, or its sizes, kmer size or read
+    ///         offsets are inconsistent
+    ///
+    explicit MappedDbg(const std::string& fn);
+
+    MappedDbg(MappedDbg&& other) noexcept;
+    MappedDbg& operator=(MappedDbg&& other) noexcept;
+    MappedDbg(const MappedDbg&) = delete;
+    MappedDbg& operator=(const MappedDbg&) = delete;
+    ~MappedDbg();
+
+    ///
+    /// \return number of nodes
+    ///
+    size_t NNodes() const;
+
+    ///
+    /// \return number of edges, as Dbg::NEdges
+    ///
+    size_t NEdges() const;
+
+    ///
+    /// \return kmer size in bp
+    ///
+    uint8_t KmerSize() const;
+
+    ///
+    /// \return number of reads of the graph
+    ///
+    uint32_t NReads() const;
+
+    ///
+    /// \return id of the node of 'kmer' (lex smaller kmer), or NoNode. Ids
+    ///         follow increasing kmer order.
+    ///
+    uint32_t Id(uint64_t kmer) const;
+
+    ///
+    /// \return lex smaller kmer of node 'id'
+    ///
+    uint64_t Kmer(uint32_t id) const;
+
+    ///
+    /// \return kmer of node 'id', with the strand it was first seen on
+    ///
+    DnaBit Dna(uint32_t id) const;
+
+    ///
+    /// \return edge bitfield of node 'id', see DbgNode
+    ///
+    uint8_t Edges(uint32_t id) const;
+
+    ///
+    /// \return number of edges of node 'id'
+    ///
+    int Degree(uint32_t id) const;
+
+    ///
+    /// Writes the lex smaller kmers of the neighbors of node 'id' to
+    /// 'neighbors', in the order DbgNode iterates them.
+    ///
+    /// \return number of neighbors
+    ///
+    int Neighbors(uint32_t id, std::array<uint64_t, 8>& neighbors) const;
+
+    ///
+    /// \return zero-based indices of the reads covering node 'id', in
+    ///         increasing order
+    ///
+    ReadIdRange ReadIds(uint32_t id) const;
+
+    ///
+    /// \return number of reads covering node 'id'
+    ///
+    uint32_t ReadCount(uint32_t id) const;
+
+private:
+    void Unmap();
+
+    void* data_ = nullptr;
+    size_t size_ = 0;
+
+    uint8_t kmerSize_ = 0;
+    uint32_t nReads_ = 0;
+    uint64_t nNodes_ = 0;
+
+    // views into the mapping
+    const uint64_t* kmers_ = nullptr;
+    const uint64_t* readOffsets_ = nullptr;
+    const uint32_t* readIds_ = nullptr;
+    const uint8_t* edges_ = nullptr;
+    const uint8_t* strands_ = nullptr;
+};
+
+}  // namespace Pbmer
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PBMER_MAPPEDDBG_H
@@ -0,0 +1,201 @@
+#ifndef PBCOPPER_PBMER_MINIMIZERSCANNER_H
+#define PBCOPPER_PBMER_MINIMIZERSCANNER_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pbcopper/pbmer/Kmer.h>
+#include <pbcopper/pbmer/Mers.h>
+#include <pbcopper/pbmer/internal/BaseEncoding.h>
+
+namespace PacBio {
+namespace Pbmer {
+
+///
+/// Single-pass minimizer extraction. For a DNA sequence, produces the same
+/// minimizers, in the same order, as
+///
+/// \code{.cpp}
+///    Mers mers = Parser{kmerSize}.Parse(dna);
+///    mers.HashKmers();
+///    mers.WindowMin(winSize);
+///    // mers.minimizers
+/// \endcode
+///
+/// but without materializing any kmer vector: kmers are hashed and made
+/// canonical as they are rolled, and windowed in a ring buffer of
+/// 'winSize + 1' candidates. Memory per sequence is O(winSize).
+///
+class MinimizerScanner
+{
+public:
+    MinimizerScanner(uint8_t kmerSize, unsigned int winSize);
+
+    uint8_t KmerSize() const;
+    unsigned int WindowSize() const;
+
+    ///
+    /// Calls 'f(const Kmer&)' for every minimizer of 'dna'.
+    ///
+    /// \throws std::runtime_error if 'dna' is shorter than the kmer size
+    ///
+    template <typename F>
+    void ForEachMinimizer(const std::string& dna, F&& f) const;
+
+    ///
+    /// Calls 'f(const Kmer& nmp, const Kmer& previous, const Kmer& current)'
+    /// for every neighboring minimizer pair of 'dna'. 'nmp' is the pair as
+    /// Mers::BuildNMPs makes it from the minimizers above, and 'previous' and
+    /// 'current' are the two minimizers, with their positions and strands.
+    ///
+    /// \throws std::runtime_error if the kmer size exceeds 16 bp, or if 'dna'
+    ///         is shorter than the kmer size
+    ///
+    template <typename F>
+    void ForEachNmp(const std::string& dna, F&& f) const;
+
+    ///
+    /// Appends the minimizers of 'dna' to 'minimizers'.
+    ///
+    void Minimizers(const std::string& dna, std::vector<Kmer>& minimizers) const;
+
+    ///
+    /// \returns the minimizers of 'dna'
+    ///
+    std::vector<Kmer> Minimizers(const std::string& dna) const;
+
+    ///
+    /// \returns the hash of the neighboring minimizer pair 'minA', 'minB',
+    ///          minimizers of at most 16 bp, independent of their order
+    ///
+    static uint64_t NmpHash(uint64_t minA, uint64_t minB);
+
+private:
+    uint8_t kmerSize_;
+    unsigned int winSize_;
+};
+
+template <typename F>
+void MinimizerScanner::ForEachMinimizer(const std::string& dna, F&& f) const
+{
+    if (dna.size() < kmerSize_)
+        throw std::runtime_error{"[pbmer] parsing ERROR: DNA sequence shorter than kmer size."};
+
+    const uint64_t mask = (kmerSize_ >= 32) ? ~0ull : (1ull << 2 * kmerSize_) - 1;
+    const size_t w = winSize_;
+    const size_t ringSize = w + 1;
+
+    // Canonical candidates, by index, and a monotonic deque of candidate
+    // indices; both only ever hold the current window and the one before
+    std::vector<Kmer> candidates(ringSize);
+    std::vector<size_t> deque(ringSize);
+    size_t dequeHead = 0;
+    size_t dequeSize = 0;
+
+    const auto Candidate = [&](const size_t ix) -> const Kmer& {
+        return candidates[ix % ringSize];
+    };
+    const auto Front = [&]() { return deque[dequeHead]; };
+    const auto Back = [&]() { return deque[(dequeHead + dequeSize - 1) % ringSize]; };
+    const auto PopFront = [&]() {
+        dequeHead = (dequeHead + 1) % ringSize;
+        --dequeSize;
+    };
+    const auto PushBack = [&](const size_t ix) {
+        deque[(dequeHead + dequeSize) % ringSize] = ix;
+        ++dequeSize;
+    };
+
+    // Index and value of the last output, to output ties exactly once
+    bool anyOutput = false;
+    size_t lastOutputIx = 0;
+    uint64_t lastOutputMer = 0;
+    const auto Output = [&](const size_t ix) {
+        if (anyOutput && ix <= lastOutputIx) return;
+        anyOutput = true;
+        lastOutputIx = ix;
+        lastOutputMer = Candidate(ix).mer;
+        f(Candidate(ix));
+    };
+    const auto TiesLastOutput = [&](const size_t ix) {
+        return anyOutput && Candidate(ix).mer == lastOutputMer;
+    };
+
+    // Same sliding window as Mers::WindowMin
+    size_t i = 0;
+    const auto AddCandidate = [&](const Kmer& kmer) {
+        candidates[i % ringSize] = kmer;
+        if (i >= w) {
+            Output(Front());
+            while (dequeSize > 0 && Front() + w <= i) {
+                if (TiesLastOutput(Front())) Output(Front());
+                PopFront();
+            }
+        }
+        while (dequeSize > 0 && kmer.mer < Candidate(Back()).mer) {
+            if (i >= w && TiesLastOutput(Back())) Output(Back());
+            --dequeSize;
+        }
+        PushBack(i);
+        ++i;
+    };
+
+    // Same positions and canonical choice as Parser::Parse and Mers::HashKmers
+    uint32_t pos = 1;
+    internal::ForEachKmer(dna.data(), dna.size(), kmerSize_,
+                          [&](const uint64_t forward, const uint64_t reverse) {
+                              const uint64_t hashedForward = Mers::Mix64Masked(forward, mask);
+                              const uint64_t hashedReverse = Mers::Mix64Masked(reverse, mask);
+                              if (hashedForward < hashedReverse) {
+                                  AddCandidate(Kmer{hashedForward, pos, Data::Strand::FORWARD});
+                              } else if (hashedReverse < hashedForward) {
+                                  AddCandidate(Kmer{hashedReverse, pos, Data::Strand::REVERSE});
+                              }
+                              ++pos;
+                          },
+                          [&]() { pos += kmerSize_; });
+
+    // Minimizers of the last window
+    if (dequeSize > 0) {
+        const uint64_t minMer = Candidate(Front()).mer;
+        for (size_t l = 0; l < dequeSize; ++l) {
+            const size_t ix = deque[(dequeHead + l) % ringSize];
+            if (Candidate(ix).mer == minMer) Output(ix);
+        }
+    }
+}
+
+template <typename F>
+void MinimizerScanner::ForEachNmp(const std::string& dna, F&& f) const
+{
+    if (kmerSize_ > 16) throw std::runtime_error{"[pbmer] Mers ERROR: Kmer must be <= 16 bp."};
+
+    bool first = true;
+    Kmer previous;
+    ForEachMinimizer(dna, [&](const Kmer& minimizer) {
+        if (!first) {
+            f(Kmer{NmpHash(previous.mer, minimizer.mer), 0, Data::Strand::FORWARD}, previous,
+              minimizer);
+        }
+        first = false;
+        previous = minimizer;
+    });
+}
+
+inline uint64_t MinimizerScanner::NmpHash(const uint64_t minA, const uint64_t minB)
+{
+    // no mask because we are merging to minimizers up to 32 bits.
+    const uint64_t pair = (minA <= minB) ? (minA << 32) | minB : (minB << 32) | minA;
+    return Mers::Mix64Masked(pair, ~uint64_t(0));
+}
+
+}  // namespace Pbmer
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PBMER_MINIMIZERSCANNER_H
@@ -0,0 +1,156 @@
+#ifndef PBCOPPER_PBMER_NMPINDEX_H
+#define PBCOPPER_PBMER_NMPINDEX_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pbcopper/data/Strand.h>
+#include <pbcopper/parallel/ThreadPool.h>
+#include <pbcopper/pbmer/MinimizerScanner.h>
+
+namespace PacBio {
+namespace Pbmer {
+
+///
+/// A read sharing neighboring minimizer pairs (NMPs) with a query.
+///
+struct NmpCandidate
+{
+    // id of the indexed read
+    uint32_t readId;
+
+    // FORWARD if the read matches the query as is, REVERSE if it matches
+    // its reverse complement
+    Data::Strand strand;
+
+    // number of NMP hits between the query and the read
+    uint32_t count;
+
+    // median diagonal of the hits, in bp: query minus read position for
+    // FORWARD matches, query plus read position for REVERSE ones
+    int64_t diagonal;
+};
+
+bool operator==(const NmpCandidate& lhs, const NmpCandidate& rhs);
+
+///
+/// Overlap candidate index of neighboring minimizer pairs, as produced by
+/// Mers::BuildNMPs, across many reads.
+///
+/// Reads are added in bulk, then Build sorts the pairs by hash and groups
+/// them into one postings array, so that the reads sharing NMPs with a query
+/// can be found without aligning it against all of them.
+///
+/// \code{.cpp}
+///    NmpIndex index{15, 10};
+///    index.AddReads(reads, pool);
+///    index.Build(pool);
+///    for (const auto& c : index.Query(reads[0], 3, 0)) {
+///        // reads[c.readId] shares c.count NMPs with reads[0]
+///    }
+/// \endcode
+///
+class NmpIndex
+{
+public:
+    /// Marks a query that is not one of the indexed reads
+    static constexpr uint32_t NoRead = ~uint32_t{0};
+
+    ///
+    /// \param kmerSize     minimizer size in bp, at most 16
+    /// \param winSize      minimizer window size, in kmers
+    ///
+    /// \throws std::runtime_error if kmerSize or winSize is out of range
+    ///
+    NmpIndex(uint8_t kmerSize, unsigned int winSize);
+
+    ///
+    /// Adds the NMPs of 'dna' under 'readId'. They are not searched before
+    /// the next call to Build. Sequences shorter than the kmer size are
+    /// skipped.
+    ///
+    void AddRead(uint32_t readId, const std::string& dna);
+
+    ///
+    /// Adds the NMPs of all 'reads' in parallel, 'reads[i]' under read id
+    /// 'firstReadId + i'.
+    ///
+    void AddReads(const std::vector<std::string>& reads, Parallel::ThreadPool& pool,
+                  uint32_t firstReadId = 0);
+
+    ///
+    /// Sorts the NMPs added so far into the index, together with those
+    /// already in it. Postings of equal NMPs stay in insertion order.
+    ///
+    void Build();
+
+    ///
+    /// Same as above, sorting on 'pool'.
+    ///
+    void Build(Parallel::ThreadPool& pool);
+
+    ///
+    /// \returns the indexed reads sharing at least 'minShared' NMP hits with
+    ///          'dna', by increasing read id then strand. 'selfId' is left
+    ///          out, and NMPs found in more than 'maxOccurrences' postings
+    ///          (0 for no limit) are ignored as repeats.
+    ///
+    std::vector<NmpCandidate> Query(const std::string& dna, uint32_t minShared,
+                                    uint32_t selfId = NoRead, size_t maxOccurrences = 0) const;
+
+    ///
+    /// \returns number of distinct NMPs in the index
+    ///
+    size_t NumKeys() const;
+
+    ///
+    /// \returns number of NMPs in the index, i.e. of postings
+    ///
+    size_t NumNmps() const;
+
+    ///
+    /// \returns number of NMPs added but not yet built into the index
+    ///
+    size_t NumPending() const;
+
+    ///
+    /// \returns memory used by the index and pending NMPs, in bytes
+    ///
+    size_t MemoryUsage() const;
+
+private:
+    // read id, and position (2x the pair midpoint) << 1 | strand
+    struct Posting
+    {
+        uint32_t readId;
+        uint32_t posStrand;
+    };
+    using Entry = std::pair<uint64_t, Posting>;
+
+    // calls 'f(hash, posStrand)' for every NMP of 'dna'
+    template <typename F>
+    void ForEachNmp(const std::string& dna, F&& f) const;
+
+    void Build(Parallel::ThreadPool* pool);
+
+    MinimizerScanner scanner_;
+
+    // sorted distinct NMP hashes; the postings of keys_[i] are
+    // postings_[offsets_[i], offsets_[i + 1])
+    std::vector<uint64_t> keys_;
+    std::vector<uint64_t> offsets_;
+    std::vector<Posting> postings_;
+
+    std::vector<Entry> pending_;
+};
+
+}  // namespace Pbmer
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PBMER_NMPINDEX_H
@@ -26,6 +26,11 @@ constexpr const std::array<uint8_t, 256> AsciiToDna{
     4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
     4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4};
 
+///
+/// Splits DNA into 2-bit packed kmers. Bases are encoded 64 at a time, using
+/// AVX2 or SSE2 where available, and kmers containing unknown bases (see
+/// AsciiToDna) are skipped.
+///
 class Parser
 {
 public:
@@ -58,8 +63,6 @@ public:
 
 private:
     uint8_t kmerSize_;
-    uint64_t mask_;
-    uint64_t shift1_;
 };
 
 }  // namespace Pbmer
@@ -0,0 +1,106 @@
+#ifndef PBCOPPER_PBMER_READIDSET_H
+#define PBCOPPER_PBMER_READIDSET_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <vector>
+
+namespace PacBio {
+namespace Pbmer {
+
+///
+/// Set of read indices supporting a De Bruijn graph node.
+///
+/// Most kmers are covered by a small fraction of the reads, so ids are kept
+/// as a sorted array while that is smaller than a bitmap over [0, max id],
+/// and switch to such a bitmap once the set becomes dense. Memory is thus
+/// min(4 * Count(), max id / 8) bytes, instead of one bit per read of the
+/// whole graph for every node.
+///
+class ReadIdSet
+{
+public:
+    ///
+    /// Adds a read index.
+    ///
+    /// \param id   read index
+    /// \return true if 'id' was not in the set yet
+    ///
+    bool Insert(uint32_t id);
+
+    ///
+    /// \return true if read index 'id' is in the set
+    ///
+    bool Contains(uint32_t id) const;
+
+    ///
+    /// \return number of read indices in the set
+    ///
+    uint32_t Count() const;
+
+    ///
+    /// \return true if the set is stored as a bitmap
+    ///
+    bool IsDense() const;
+
+    ///
+    /// \return heap memory held by the set, in bytes
+    ///
+    size_t MemoryUsage() const;
+
+    ///
+    /// Removes all read indices and releases their memory.
+    ///
+    void Clear();
+
+    ///
+    /// Adds all read indices of 'other'.
+    ///
+    ReadIdSet& operator|=(const ReadIdSet& other);
+
+    ///
+    /// Calls 'f(uint32_t id)' for every read index, in increasing order.
+    ///
+    template <typename F>
+    void ForEach(F&& f) const;
+
+    ///
+    /// \return read indices, in increasing order
+    ///
+    std::vector<uint32_t> Ids() const;
+
+private:
+    void MakeDense(uint32_t maxId);
+
+    // sorted read indices, or a bitmap of 32 reads per word if dense_
+    std::vector<uint32_t> data_;
+    uint32_t count_ = 0;
+    bool dense_ = false;
+};
+
+template <typename F>
+void ReadIdSet::ForEach(F&& f) const
+{
+    if (!dense_) {
+        for (const uint32_t id : data_) {
+            f(id);
+        }
+        return;
+    }
+
+    for (size_t w = 0; w < data_.size(); ++w) {
+        uint32_t word = data_[w];
+        while (word != 0) {
+            f(static_cast<uint32_t>(w * 32 + __builtin_ctz(word)));
+            word &= word - 1;
+        }
+    }
+}
+
+}  // namespace Pbmer
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PBMER_READIDSET_H
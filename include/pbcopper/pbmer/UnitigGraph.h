@@ -0,0 +1,107 @@
+#ifndef PBCOPPER_PBMER_UNITIGGRAPH_H
+#define PBCOPPER_PBMER_UNITIGGRAPH_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <pbcopper/pbmer/ReadIdSet.h>
+
+namespace PacBio {
+namespace Pbmer {
+
+///
+/// Maximal non-branching path of De Bruijn graph nodes.
+///
+struct Unitig
+{
+    // bases of its kmers, overlapping by 'kmerSize - 1'
+    std::string sequence;
+
+    // zero-based indices of the reads covering any of its kmers
+    ReadIdSet readIds;
+
+    // sum over its kmers of the number of reads covering the kmer
+    uint64_t kmerCoverage = 0;
+};
+
+///
+/// Overlap of 'kmerSize - 1' bases between the end of unitig 'from' and the
+/// start of unitig 'to', each read in reverse complement if flagged.
+///
+struct UnitigLink
+{
+    uint32_t from = 0;
+    bool fromReverse = false;
+    uint32_t to = 0;
+    bool toReverse = false;
+};
+
+///
+/// Compacted De Bruijn graph, as returned by Dbg::Compact. Every kmer of the
+/// original graph is in exactly one unitig; links only exist between unitig
+/// ends.
+///
+class UnitigGraph
+{
+public:
+    UnitigGraph(uint8_t kmerSize, std::vector<Unitig> unitigs, std::vector<UnitigLink> links);
+
+    ///
+    /// \return kmer size in bp
+    ///
+    uint8_t KmerSize() const;
+
+    ///
+    /// \return number of unitigs
+    ///
+    size_t NumUnitigs() const;
+
+    ///
+    /// \return number of kmers in unitig 'id'
+    ///
+    size_t NumKmers(uint32_t id) const;
+
+    ///
+    /// \return mean number of reads covering the kmers of unitig 'id'
+    ///
+    double MeanCoverage(uint32_t id) const;
+
+    const std::vector<Unitig>& Unitigs() const;
+
+    ///
+    /// \return links, each listed once in one of its two equivalent directions
+    ///
+    const std::vector<UnitigLink>& Links() const;
+
+    ///
+    /// Writes the graph in GFA1 format. Segments are named by unitig id and
+    /// carry the tags LN (length), KC (kmer coverage), RC (number of reads)
+    /// and km (mean kmer coverage).
+    ///
+    /// \param out  output stream
+    ///
+    void WriteGfa(std::ostream& out) const;
+
+    ///
+    /// Writes the graph in GFA1 format to file 'fn'.
+    ///
+    /// \throws std::runtime_error if the file cannot be opened
+    ///
+    void WriteGfa(const std::string& fn) const;
+
+private:
+    uint8_t kmerSize_;
+    std::vector<Unitig> unitigs_;
+    std::vector<UnitigLink> links_;
+};
+
+}  // namespace Pbmer
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PBMER_UNITIGGRAPH_H
@@ -0,0 +1,115 @@
+#ifndef PBCOPPER_PBMER_BASEENCODING_H
+#define PBCOPPER_PBMER_BASEENCODING_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+
+namespace PacBio {
+namespace Pbmer {
+namespace internal {
+
+// Number of bases encoded at once
+constexpr size_t EncodingBlockSize = 64;
+
+///
+/// Converts 'n' <= EncodingBlockSize bases to their 2-bit codes, as
+/// AsciiToDna does, and sets bit i of 'unknown' for every base i that is not
+/// one of ACGT, acgt or 0-3 (whose code is then unspecified).
+///
+/// Full blocks are encoded 16 or 32 bases per instruction with SSE2 or AVX2,
+/// chosen once at runtime, and the remainder one base at a time.
+///
+void EncodeBases(const char* dna, size_t n, uint8_t* codes, uint64_t& unknown);
+
+///
+/// Calls 'emit(forward, reverse)' for every kmer of 'dna', in order, with the
+/// 2-bit packed forward kmer and its reverse complement, and 'skip()' for
+/// every unknown base, which resets both kmers.
+///
+/// kmerSize must be in [1, 32].
+///
+template <typename Emit, typename Skip>
+void ForEachKmer(const char* dna, const size_t size, const uint8_t kmerSize, Emit&& emit,
+                 Skip&& skip)
+{
+    const uint64_t mask = (kmerSize >= 32) ? ~0ull : (1ull << 2 * kmerSize) - 1;
+    const uint64_t shift1 = 2ull * (kmerSize - 1);
+
+    uint64_t forward = 0;
+    uint64_t reverse = 0;
+    // number of known bases in the current kmers, up to kmerSize
+    size_t lk = 0;
+
+    std::array<uint8_t, EncodingBlockSize> codes;
+    for (size_t start = 0; start < size; start += EncodingBlockSize) {
+        const size_t n = std::min(EncodingBlockSize, size - start);
+        uint64_t unknown = 0;
+        EncodeBases(dna + start, n, codes.data(), unknown);
+
+        for (size_t i = 0; i < n; ++i) {
+            if (unknown != 0 && ((unknown >> i) & 1)) {
+                lk = 0;
+                forward = 0;
+                reverse = 0;
+                skip();
+                continue;
+            }
+            const uint64_t c = codes[i];
+            forward = (forward << 2 | c) & mask;
+            reverse = (reverse >> 2) | (3ull ^ c) << shift1;
+            if (lk < kmerSize) ++lk;
+            if (lk == kmerSize) emit(forward, reverse);
+        }
+    }
+}
+
+///
+/// ForEachKmer for a kmer size 'K' known at compile time, with kmers packed
+/// in 'Word', which must hold 2 * K bits.
+///
+template <typename Word, int K, typename Emit, typename Skip>
+void ForEachFixedKmer(const char* dna, const size_t size, Emit&& emit, Skip&& skip)
+{
+    static_assert(K >= 1 && 2 * K <= 8 * static_cast<int>(sizeof(Word)),
+                  "kmer size does not fit the kmer word");
+    constexpr Word mask = ~Word{0} >> (8 * sizeof(Word) - 2 * K);
+    constexpr int shift1 = 2 * (K - 1);
+
+    Word forward = 0;
+    Word reverse = 0;
+    // number of known bases in the current kmers, up to K
+    int lk = 0;
+
+    std::array<uint8_t, EncodingBlockSize> codes;
+    for (size_t start = 0; start < size; start += EncodingBlockSize) {
+        const size_t n = std::min(EncodingBlockSize, size - start);
+        uint64_t unknown = 0;
+        EncodeBases(dna + start, n, codes.data(), unknown);
+
+        for (size_t i = 0; i < n; ++i) {
+            if (unknown != 0 && ((unknown >> i) & 1)) {
+                lk = 0;
+                forward = 0;
+                reverse = 0;
+                skip();
+                continue;
+            }
+            const Word c = codes[i];
+            forward = ((forward << 2) | c) & mask;
+            reverse = (reverse >> 2) | (Word{3} ^ c) << shift1;
+            if (lk < K) ++lk;
+            if (lk == K) emit(forward, reverse);
+        }
+    }
+}
+
+}  // namespace internal
+}  // namespace Pbmer
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PBMER_BASEENCODING_H
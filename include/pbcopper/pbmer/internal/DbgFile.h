@@ -0,0 +1,58 @@
+#ifndef PBCOPPER_PBMER_DBGFILE_H
+#define PBCOPPER_PBMER_DBGFILE_H
+
+#include <pbcopper/PbcopperConfig.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace PacBio {
+namespace Pbmer {
+namespace internal {
+
+// Binary graph file layout shared by Dbg::WriteBinary and MappedDbg, see
+// MappedDbg for the format.
+
+constexpr char DbgFileMagic[8] = {'P', 'B', 'M', 'E', 'R', 'D', 'B', 'G'};
+
+struct DbgFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t kmerSize;
+    uint32_t nReads;
+    uint32_t reserved;
+    uint64_t nNodes;
+    uint64_t nReadIds;
+};
+
+static_assert(sizeof(DbgFileHeader) == 40, "unexpected DbgFileHeader padding");
+
+// byte offsets of the arrays following the header, and the file size
+struct DbgFileSections
+{
+    DbgFileSections(const uint64_t nNodes, const uint64_t nReadIds)
+        : kmers{sizeof(DbgFileHeader)}
+        , readOffsets{kmers + 8 * nNodes}
+        , readIds{readOffsets + 8 * (nNodes + 1)}
+        , edges{Align(readIds + 4 * nReadIds)}
+        , strands{Align(edges + nNodes)}
+        , size{Align(strands + nNodes)}
+    {
+    }
+
+    static uint64_t Align(const uint64_t offset) { return (offset + 7) & ~uint64_t{7}; }
+
+    uint64_t kmers;
+    uint64_t readOffsets;
+    uint64_t readIds;
+    uint64_t edges;
+    uint64_t strands;
+    uint64_t size;
+};
+
+}  // namespace internal
+}  // namespace Pbmer
+}  // namespace PacBio
+
+#endif  // PBCOPPER_PBMER_DBGFILE_H
@@ -14,6 +14,7 @@
 #include <pbcopper/cli2/internal/MultiToolInterfaceHelpPrinter.h>
 #include <pbcopper/cli2/internal/VersionPrinter.h>
 #include <pbcopper/logging/Logging.h>
+#include <pbcopper/parallel/SharedThreadPool.h>
 #include <pbcopper/utility/Alarm.h>
 
 using CommandLineParser = PacBio::CLI_v2::internal::CommandLineParser;
@@ -104,6 +105,9 @@ int Run(const std::vector<std::string>& args, const Interface& interface,
 
     Logging::Logger::Current(logger.get());
 
+    // Size the process-wide thread pool, before the application starts it
+    if (interface.NumThreadsOption()) Parallel::SetSharedThreadPoolSize(results.NumThreads());
+
     if (allowExceptionsPassthrough) {
         return handler(results);
     } else {
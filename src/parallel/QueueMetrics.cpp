@@ -0,0 +1,163 @@
+#include <pbcopper/parallel/QueueMetrics.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace PacBio {
+namespace Parallel {
+namespace {
+
+double Seconds(const std::chrono::nanoseconds ns) { return ns.count() / 1e9; }
+
+unsigned int Count(const uint64_t n)
+{
+    return static_cast<unsigned int>(
+        std::min<uint64_t>(n, std::numeric_limits<unsigned int>::max()));
+}
+
+}  // namespace
+
+constexpr size_t QueueMetrics::NumDepthBuckets;
+constexpr size_t QueueMetrics::NumLatencyBuckets;
+
+QueueMetrics::QueueMetrics(const size_t numWorkers)
+    : start_{Clock::now()}, workers_{new Worker[numWorkers]}, numWorkers_{numWorkers}
+{
+    for (auto& bucket : depth_)
+        bucket = 0;
+    for (auto& bucket : latency_)
+        bucket = 0;
+}
+
+size_t QueueMetrics::NumWorkers() const { return numWorkers_; }
+
+uint64_t QueueMetrics::NumTasks() const
+{
+    uint64_t result = 0;
+    for (size_t i = 0; i < numWorkers_; ++i)
+        result += NumTasks(i);
+    return result;
+}
+
+uint64_t QueueMetrics::NumTasks(const size_t worker) const
+{
+    return workers_[worker].tasks.load(std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds QueueMetrics::Elapsed() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_);
+}
+
+std::chrono::nanoseconds QueueMetrics::BusyTime(const size_t worker) const
+{
+    return std::chrono::nanoseconds(workers_[worker].busy.load(std::memory_order_relaxed));
+}
+
+std::chrono::nanoseconds QueueMetrics::IdleTime(const size_t worker) const
+{
+    return std::max(Elapsed() - BusyTime(worker), std::chrono::nanoseconds{0});
+}
+
+std::chrono::nanoseconds QueueMetrics::ProducerBlockedTime() const
+{
+    return std::chrono::nanoseconds(producerBlocked_.load(std::memory_order_relaxed));
+}
+
+std::chrono::nanoseconds QueueMetrics::ConsumerBlockedTime() const
+{
+    return std::chrono::nanoseconds(consumerBlocked_.load(std::memory_order_relaxed));
+}
+
+std::vector<uint64_t> QueueMetrics::DepthHistogram() const
+{
+    std::vector<uint64_t> result;
+    result.reserve(NumDepthBuckets);
+    for (const auto& bucket : depth_)
+        result.push_back(bucket.load(std::memory_order_relaxed));
+    return result;
+}
+
+std::chrono::nanoseconds QueueMetrics::LatencyPercentile(const double percentile) const
+{
+    std::array<uint64_t, NumLatencyBuckets> counts;
+    uint64_t total = 0;
+    for (size_t i = 0; i < NumLatencyBuckets; ++i) {
+        counts[i] = latency_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) return std::chrono::nanoseconds{0};
+
+    const double p = std::min(100.0, std::max(0.0, percentile));
+    const uint64_t rank = std::max<uint64_t>(1, std::ceil(p / 100.0 * total));
+
+    uint64_t seen = 0;
+    size_t bucket = 0;
+    for (; bucket < NumLatencyBuckets; ++bucket) {
+        seen += counts[bucket];
+        if (seen >= rank) break;
+    }
+
+    // Report the upper bound of the bucket
+    if (bucket < 8) return std::chrono::nanoseconds(bucket);
+    const int msb = bucket / 8 + 2;
+    const uint64_t width = uint64_t{1} << (msb - 3);
+    const uint64_t lower = (8 + bucket % 8) * width;
+    return std::chrono::nanoseconds(lower + width - 1);
+}
+
+Reports::Report QueueMetrics::ToReport(const std::string& id) const
+{
+    Reports::Report report{id, "Queue Metrics"};
+    report.Attributes({
+        {"num_workers", Count(NumWorkers()), "Number of workers"},
+        {"num_tasks", Count(NumTasks()), "Number of finished tasks"},
+        {"elapsed", Seconds(Elapsed()), "Elapsed time (seconds)"},
+        {"producer_blocked", Seconds(ProducerBlockedTime()),
+         "Time producers were blocked on a full queue (seconds)"},
+        {"consumer_blocked", Seconds(ConsumerBlockedTime()),
+         "Time the consumer was blocked on an empty queue (seconds)"},
+        {"latency_p50", Seconds(LatencyPercentile(50)), "Median task latency (seconds)"},
+        {"latency_p90", Seconds(LatencyPercentile(90)), "90th percentile task latency (seconds)"},
+        {"latency_p99", Seconds(LatencyPercentile(99)), "99th percentile task latency (seconds)"},
+        {"latency_max", Seconds(LatencyPercentile(100)), "Maximum task latency (seconds)"},
+    });
+
+    std::vector<Reports::ReportValue> worker;
+    std::vector<Reports::ReportValue> tasks;
+    std::vector<Reports::ReportValue> busy;
+    std::vector<Reports::ReportValue> idle;
+    for (size_t i = 0; i < NumWorkers(); ++i) {
+        worker.emplace_back(Count(i));
+        tasks.emplace_back(Count(NumTasks(i)));
+        busy.emplace_back(Seconds(BusyTime(i)));
+        idle.emplace_back(Seconds(IdleTime(i)));
+    }
+    report.AddTable({"workers",
+                     {{"worker", worker, "Worker"},
+                      {"tasks", tasks, "Tasks"},
+                      {"busy", busy, "Busy (seconds)"},
+                      {"idle", idle, "Idle (seconds)"}},
+                     "Workers"});
+
+    // Only report buckets up to the deepest queue seen
+    const auto histogram = DepthHistogram();
+    size_t numBuckets = histogram.size();
+    while (numBuckets > 1 && histogram[numBuckets - 1] == 0)
+        --numBuckets;
+    std::vector<Reports::ReportValue> minDepth;
+    std::vector<Reports::ReportValue> counts;
+    for (size_t i = 0; i < numBuckets; ++i) {
+        minDepth.emplace_back(Count(i == 0 ? 0 : uint64_t{1} << (i - 1)));
+        counts.emplace_back(Count(histogram[i]));
+    }
+    report.AddTable({"queue_depth",
+                     {{"min_depth", minDepth, "Minimum queue depth"}, {"count", counts, "Pushes"}},
+                     "Queue Depth"});
+
+    return report;
+}
+
+}  // namespace Parallel
+}  // namespace PacBio
@@ -0,0 +1,47 @@
+#include <pbcopper/parallel/SharedThreadPool.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace PacBio {
+namespace Parallel {
+namespace {
+
+struct SharedThreadPoolState
+{
+    std::mutex m;
+    size_t numThreads = std::max(1U, std::thread::hardware_concurrency());
+    std::unique_ptr<ThreadPool> pool;
+};
+
+SharedThreadPoolState& State()
+{
+    static SharedThreadPoolState state;
+    return state;
+}
+
+}  // namespace
+
+bool SetSharedThreadPoolSize(const size_t numThreads)
+{
+    auto& state = State();
+    std::lock_guard<std::mutex> g(state.m);
+
+    const size_t n = std::max<size_t>(1, numThreads);
+    if (state.pool) return state.pool->NumThreads() == n;
+    state.numThreads = n;
+    return true;
+}
+
+ThreadPool& SharedThreadPool()
+{
+    auto& state = State();
+    std::lock_guard<std::mutex> g(state.m);
+    if (!state.pool) state.pool = std::make_unique<ThreadPool>(state.numThreads);
+    return *state.pool;
+}
+
+}  // namespace Parallel
+}  // namespace PacBio
@@ -0,0 +1,236 @@
+#include <pbcopper/parallel/ThreadPlacement.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <tuple>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace PacBio {
+namespace Parallel {
+namespace {
+
+// \returns first line of 'filename', or an empty string if it is not readable
+std::string ReadLine(const std::string& filename)
+{
+    std::ifstream in{filename};
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+int ReadInt(const std::string& filename, const int fallback)
+{
+    const std::string line = ReadLine(filename);
+    if (line.empty()) return fallback;
+    try {
+        return std::stoi(line);
+    } catch (const std::exception&) {
+        return fallback;
+    }
+}
+
+}  // namespace
+
+namespace internal {
+
+std::vector<int> ParseCpuList(const std::string& list)
+{
+    std::vector<int> result;
+    std::istringstream in{list};
+    std::string range;
+    while (std::getline(in, range, ',')) {
+        if (range.empty()) continue;
+        try {
+            const auto dash = range.find('-');
+            if (dash == std::string::npos) {
+                result.push_back(std::stoi(range));
+            } else {
+                const int first = std::stoi(range.substr(0, dash));
+                const int last = std::stoi(range.substr(dash + 1));
+                for (int cpu = first; cpu <= last; ++cpu)
+                    result.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            // ignore malformed entries
+        }
+    }
+    return result;
+}
+
+}  // namespace internal
+
+std::vector<CpuInfo> ReadCpuTopology(const std::string& sysfsRoot)
+{
+    std::vector<CpuInfo> topology;
+
+    const auto online = internal::ParseCpuList(ReadLine(sysfsRoot + "/cpu/online"));
+    if (online.empty()) {
+        const int numCpus = std::max(1U, std::thread::hardware_concurrency());
+        for (int i = 0; i < numCpus; ++i) {
+            CpuInfo cpu;
+            cpu.id = i;
+            cpu.core = i;
+            topology.push_back(cpu);
+        }
+        return topology;
+    }
+
+    std::map<int, int> nodeOf;
+    for (const int node : internal::ParseCpuList(ReadLine(sysfsRoot + "/node/online"))) {
+        const std::string cpulist =
+            ReadLine(sysfsRoot + "/node/node" + std::to_string(node) + "/cpulist");
+        for (const int cpu : internal::ParseCpuList(cpulist))
+            nodeOf[cpu] = node;
+    }
+
+    for (const int id : online) {
+        const std::string dir = sysfsRoot + "/cpu/cpu" + std::to_string(id) + "/topology/";
+        CpuInfo cpu;
+        cpu.id = id;
+        cpu.core = ReadInt(dir + "core_id", id);
+        cpu.package = ReadInt(dir + "physical_package_id", 0);
+        const auto it = nodeOf.find(id);
+        cpu.node = (it == nodeOf.cend()) ? 0 : it->second;
+        topology.push_back(cpu);
+    }
+    return topology;
+}
+
+std::vector<int> AllowedCpus()
+{
+    std::vector<int> allowed;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(getpid(), sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) allowed.push_back(cpu);
+        }
+    }
+#endif
+    return allowed;
+}
+
+std::vector<CpuInfo> RestrictCpuTopology(const std::vector<CpuInfo>& topology,
+                                         const std::vector<int>& allowed)
+{
+    if (allowed.empty()) return topology;
+
+    std::vector<CpuInfo> result;
+    for (const auto& cpu : topology) {
+        if (std::find(allowed.cbegin(), allowed.cend(), cpu.id) != allowed.cend())
+            result.push_back(cpu);
+    }
+    return result;
+}
+
+bool PinCurrentThread(const int cpu)
+{
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+ThreadPlacement::ThreadPlacement() : ThreadPlacement{Policy::NONE, {}} {}
+
+ThreadPlacement::ThreadPlacement(Policy policy, std::vector<int> cpus)
+    : policy_{policy}, cpus_{std::move(cpus)}
+{
+}
+
+ThreadPlacement ThreadPlacement::None() { return ThreadPlacement{Policy::NONE, {}}; }
+
+ThreadPlacement ThreadPlacement::Compact() { return ThreadPlacement{Policy::COMPACT, {}}; }
+
+ThreadPlacement ThreadPlacement::Scatter() { return ThreadPlacement{Policy::SCATTER, {}}; }
+
+ThreadPlacement ThreadPlacement::Explicit(std::vector<int> cpus)
+{
+    return ThreadPlacement{Policy::EXPLICIT, std::move(cpus)};
+}
+
+ThreadPlacement::Policy ThreadPlacement::GetPolicy() const { return policy_; }
+
+std::vector<int> ThreadPlacement::CpusFor(const size_t numThreads) const
+{
+    if (policy_ == Policy::NONE || policy_ == Policy::EXPLICIT) return CpusFor(numThreads, {});
+    // Pinning to a CPU outside of the affinity mask would fail
+    return CpusFor(numThreads, RestrictCpuTopology(ReadCpuTopology(), AllowedCpus()));
+}
+
+std::vector<int> ThreadPlacement::CpusFor(const size_t numThreads,
+                                          const std::vector<CpuInfo>& topology) const
+{
+    std::vector<int> result(numThreads, -1);
+
+    if (policy_ == Policy::EXPLICIT) {
+        if (!cpus_.empty()) {
+            for (size_t i = 0; i < numThreads; ++i)
+                result[i] = cpus_[i % cpus_.size()];
+        }
+        return result;
+    }
+    if (policy_ == Policy::NONE || topology.empty()) return result;
+
+    if (policy_ == Policy::COMPACT) {
+        auto cpus = topology;
+        std::sort(cpus.begin(), cpus.end(), [](const CpuInfo& a, const CpuInfo& b) {
+            return std::tie(a.node, a.package, a.core, a.id) <
+                   std::tie(b.node, b.package, b.core, b.id);
+        });
+        for (size_t i = 0; i < numThreads; ++i)
+            result[i] = cpus[i % cpus.size()].id;
+        return result;
+    }
+
+    // SCATTER: per node, first one hardware thread of every core, then the
+    // remaining siblings
+    std::map<int, std::vector<CpuInfo>> perNode;
+    for (const auto& cpu : topology)
+        perNode[cpu.node].push_back(cpu);
+
+    std::vector<std::vector<int>> nodes;
+    for (auto& node : perNode) {
+        auto& cpus = node.second;
+        std::sort(cpus.begin(), cpus.end(), [](const CpuInfo& a, const CpuInfo& b) {
+            return std::tie(a.package, a.core, a.id) < std::tie(b.package, b.core, b.id);
+        });
+        std::map<std::pair<int, int>, int> siblingRank;
+        std::vector<std::pair<int, int>> ranked;
+        for (const auto& cpu : cpus)
+            ranked.emplace_back(siblingRank[{cpu.package, cpu.core}]++, cpu.id);
+        std::stable_sort(ranked.begin(), ranked.end(),
+                         [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+                             return a.first < b.first;
+                         });
+
+        std::vector<int> ids;
+        for (const auto& r : ranked)
+            ids.push_back(r.second);
+        nodes.push_back(std::move(ids));
+    }
+
+    for (size_t i = 0; i < numThreads; ++i) {
+        const auto& ids = nodes[i % nodes.size()];
+        result[i] = ids[(i / nodes.size()) % ids.size()];
+    }
+    return result;
+}
+
+}  // namespace Parallel
+}  // namespace PacBio
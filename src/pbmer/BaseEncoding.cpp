@@ -0,0 +1,116 @@
+#include <pbcopper/pbmer/internal/BaseEncoding.h>
+
+#include <pbcopper/pbmer/Parser.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define PBMER_ENCODE_X86
+#include <immintrin.h>
+#endif
+
+namespace PacBio {
+namespace Pbmer {
+namespace internal {
+namespace {
+
+using EncodeBlockFn = void (*)(const char*, uint8_t*, uint64_t&);
+
+void EncodeScalar(const char* dna, const size_t n, uint8_t* codes, uint64_t& unknown)
+{
+    unknown = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t c = AsciiToDna[static_cast<unsigned char>(dna[i])];
+        codes[i] = c & 3;
+        unknown |= static_cast<uint64_t>(c >> 2) << i;
+    }
+}
+
+#ifdef PBMER_ENCODE_X86
+
+// For ACGT and acgt, bits 1-2 of the ASCII code xor-ed with bits 2-3 give the
+// 2-bit code: A (0x41) -> 0, C (0x43) -> 1, G (0x47) -> 2, T (0x54) -> 3.
+// Bytes 0-3 are their own code. Anything else is unknown.
+
+// SSE2 is part of x86-64, no runtime check needed
+void EncodeBlockSse2(const char* dna, uint8_t* codes, uint64_t& unknown)
+{
+    const __m128i three = _mm_set1_epi8(3);
+    const __m128i lowerCase = _mm_set1_epi8(0x20);
+    unknown = 0;
+    for (size_t i = 0; i < EncodingBlockSize; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dna + i));
+        const __m128i lower = _mm_or_si128(v, lowerCase);
+        const __m128i acgt = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(lower, _mm_set1_epi8('a')),
+                                                       _mm_cmpeq_epi8(lower, _mm_set1_epi8('c'))),
+                                          _mm_or_si128(_mm_cmpeq_epi8(lower, _mm_set1_epi8('g')),
+                                                       _mm_cmpeq_epi8(lower, _mm_set1_epi8('t'))));
+        const __m128i raw = _mm_cmpeq_epi8(_mm_andnot_si128(three, v), _mm_setzero_si128());
+        const __m128i fromAscii =
+            _mm_and_si128(_mm_xor_si128(_mm_srli_epi16(v, 1), _mm_srli_epi16(v, 2)), three);
+        const __m128i c = _mm_or_si128(_mm_and_si128(acgt, fromAscii), _mm_and_si128(raw, v));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(codes + i), c);
+
+        const auto known = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(acgt, raw)));
+        unknown |= static_cast<uint64_t>(~known & 0xFFFF) << i;
+    }
+}
+
+__attribute__((target("avx2"))) void EncodeBlockAvx2(const char* dna, uint8_t* codes,
+                                                     uint64_t& unknown)
+{
+    const __m256i three = _mm256_set1_epi8(3);
+    const __m256i lowerCase = _mm256_set1_epi8(0x20);
+    unknown = 0;
+    for (size_t i = 0; i < EncodingBlockSize; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dna + i));
+        const __m256i lower = _mm256_or_si256(v, lowerCase);
+        const __m256i acgt =
+            _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(lower, _mm256_set1_epi8('a')),
+                                            _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('c'))),
+                            _mm256_or_si256(_mm256_cmpeq_epi8(lower, _mm256_set1_epi8('g')),
+                                            _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('t'))));
+        const __m256i raw =
+            _mm256_cmpeq_epi8(_mm256_andnot_si256(three, v), _mm256_setzero_si256());
+        const __m256i fromAscii = _mm256_and_si256(
+            _mm256_xor_si256(_mm256_srli_epi16(v, 1), _mm256_srli_epi16(v, 2)), three);
+        const __m256i c =
+            _mm256_or_si256(_mm256_and_si256(acgt, fromAscii), _mm256_and_si256(raw, v));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(codes + i), c);
+
+        const auto known = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(acgt, raw)));
+        unknown |= static_cast<uint64_t>(~known) << i;
+    }
+}
+
+EncodeBlockFn SelectEncodeBlock()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return &EncodeBlockAvx2;
+    return &EncodeBlockSse2;
+}
+
+#else
+
+void EncodeBlockScalar(const char* dna, uint8_t* codes, uint64_t& unknown)
+{
+    EncodeScalar(dna, EncodingBlockSize, codes, unknown);
+}
+
+EncodeBlockFn SelectEncodeBlock() { return &EncodeBlockScalar; }
+
+#endif  // PBMER_ENCODE_X86
+
+}  // namespace
+
+void EncodeBases(const char* dna, const size_t n, uint8_t* codes, uint64_t& unknown)
+{
+    static const EncodeBlockFn encodeBlock = SelectEncodeBlock();
+    if (n == EncodingBlockSize) {
+        encodeBlock(dna, codes, unknown);
+    } else {
+        EncodeScalar(dna, n, codes, unknown);
+    }
+}
+
+}  // namespace internal
+}  // namespace Pbmer
+}  // namespace PacBio
@@ -4,11 +4,18 @@
 
 #include <cassert>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
+#include <tuple>
 #include <unordered_set>
+#include <utility>
 
+#include <pbcopper/parallel/For.h>
+#include <pbcopper/parallel/Sort.h>
+#include <pbcopper/pbmer/internal/DbgFile.h>
 #include <pbcopper/third-party/kxsort/kxsort.h>
 
 namespace PacBio {
@@ -22,42 +29,144 @@ struct RadixTraits_128
     bool compare(const BI& x, const BI& y) { return (x >> 64) < (y >> 64); }
 };
 
+// \returns shard of a canonical kmer, from the high hash bits so that the
+//          shard maps still see well-spread low bits
+size_t ShardOf(const uint64_t mer, const size_t numShards)
+{
+    return ((robin_hood::hash_int(mer) >> 32) * numShards) >> 32;
+}
+
+// Several shards & batches per thread, to balance uneven reads and shards
+size_t NumShards(const Parallel::ThreadPool& pool) { return 4 * (pool.NumThreads() + 1); }
+
+// Calls 'f(batch, first, last)' in parallel for 'numBatches' consecutive
+// ranges of reads covering [0, numReads)
+template <typename F>
+void ForEachBatch(Parallel::ThreadPool& pool, const size_t numReads, const size_t numBatches, F&& f)
+{
+    Parallel::For(pool, 0, numBatches, 1, [&](const size_t batch) {
+        f(batch, batch * numReads / numBatches, (batch + 1) * numReads / numBatches);
+    });
+}
+
+uint64_t KmerMask(const uint8_t kmerSize)
+{
+    return (kmerSize >= 32) ? ~uint64_t{0} : (uint64_t{1} << 2 * kmerSize) - 1;
+}
+
+uint64_t Canonical(const uint64_t kmer, const uint8_t kmerSize)
+{
+    return std::min(kmer, ReverseComp64(kmer, kmerSize));
+}
+
+uint64_t PackedKmer(const BI& x) { return static_cast<uint64_t>(x >> 64); }
+
+// Calls 'f(start, end)' for every run [start, end) of equal kmers within
+// [first, last) of sorted packed kmers
+template <typename F>
+void ForEachKmerRun(const std::vector<BI>& kmers, const size_t first, const size_t last, F&& f)
+{
+    size_t start = first;
+    while (start < last) {
+        size_t end = start + 1;
+        while (end < last && PackedKmer(kmers[end]) == PackedKmer(kmers[start])) {
+            ++end;
+        }
+        f(start, end);
+        start = end;
+    }
+}
+
+// Node of the run [start, end) of packed kmers
+DbgNode MakeNode(const std::vector<BI>& kmers, const size_t start, const size_t end)
+{
+    DnaBit db;
+    db.Bin2DnaBit(kmers[start]);
+    DbgNode eg{db, 0};
+    for (size_t i = start; i < end; ++i) {
+        eg.AddLoad(static_cast<uint32_t>(kmers[i]));
+    }
+    return eg;
+}
+
 }  // namespace
 
+// A canonical kmer occurrence, bucketed by shard before insertion.
+struct Dbg::ShardEntry
+{
+    uint64_t mer;
+    uint32_t rid;
+    uint8_t strand;
+    uint8_t msize;
+    uint8_t edges;
+};
+
 Dbg::Dbg(uint8_t k, uint32_t nr) : kmerSize_{k}, nReads_{nr} {}
 
+Dbg::Dbg(const MappedDbg& graph) : kmerSize_{graph.KmerSize()}, nReads_{graph.NReads()}
+{
+    dbg_.reserve(graph.NNodes());
+    for (uint32_t id = 0; id < graph.NNodes(); ++id) {
+        DbgNode node{graph.Dna(id), graph.Edges(id)};
+        for (const uint32_t i : graph.ReadIds(id)) {
+            node.readIds2_.Insert(i);
+        }
+        dbg_.emplace(graph.Kmer(id), std::move(node));
+    }
+}
+
 void Dbg::AddKmers(std::vector<BI>& kmers, uint32_t minFreqCutoff)
 {
     kx::radix_sort(kmers.begin(), kmers.end(), RadixTraits_128());
-    size_t start_i = 0;
-    size_t end_i = 0;
-
-    while (end_i < kmers.size()) {
-        ++end_i;
-        if ((kmers[start_i] >> 64) != (kmers[end_i] >> 64)) {
-            --end_i;
-
-            if ((end_i - start_i) >= minFreqCutoff) {
-                DnaBit db;
-                db.Bin2DnaBit(kmers[start_i]);
-                DbgNode eg{db, 0};
-                eg.readIds2_.resize(nReads_);
-
-                for (auto i = start_i; i <= end_i; ++i) {
-                    uint32_t v = static_cast<uint32_t>(kmers[i]);
-                    // converting from one base index to zero
-                    eg.readIds2_[v - 1] = 1;
-                }
-                dbg_.emplace(db.mer, std::move(eg));
+
+    ForEachKmerRun(kmers, 0, kmers.size(), [&](const size_t start, const size_t end) {
+        if (end - start > minFreqCutoff) {
+            dbg_.emplace(PackedKmer(kmers[start]), MakeNode(kmers, start, end));
+        }
+    });
+}
+
+void Dbg::AddKmers(std::vector<BI>& kmers, uint32_t minFreqCutoff, Parallel::ThreadPool& pool)
+{
+    Parallel::RadixSort(pool, kmers.begin(), kmers.end(), PackedKmer);
+    if (kmers.empty()) return;
+
+    // chunks of whole runs, moving every boundary up to the start of a run
+    const size_t numChunks = std::min(kmers.size(), NumShards(pool));
+    std::vector<size_t> bounds(numChunks + 1, kmers.size());
+    bounds[0] = 0;
+    for (size_t c = 1; c < numChunks; ++c) {
+        size_t b = std::max(c * kmers.size() / numChunks, bounds[c - 1]);
+        while (b > 0 && b < kmers.size() && PackedKmer(kmers[b]) == PackedKmer(kmers[b - 1])) {
+            ++b;
+        }
+        bounds[c] = b;
+    }
+
+    std::vector<std::vector<std::pair<uint64_t, DbgNode>>> nodes(numChunks);
+    Parallel::For(pool, 0, numChunks, 1, [&](const size_t c) {
+        ForEachKmerRun(kmers, bounds[c], bounds[c + 1], [&](const size_t start, const size_t end) {
+            if (end - start > minFreqCutoff) {
+                nodes[c].emplace_back(PackedKmer(kmers[start]), MakeNode(kmers, start, end));
             }
+        });
+    });
 
-            start_i = end_i + 1;
-            end_i = start_i;
+    size_t numNodes = dbg_.size();
+    for (const auto& chunk : nodes) {
+        numNodes += chunk.size();
+    }
+    dbg_.reserve(numNodes);
+    for (auto& chunk : nodes) {
+        for (auto& node : chunk) {
+            dbg_.emplace(node.first, std::move(node.second));
         }
+        std::vector<std::pair<uint64_t, DbgNode>>{}.swap(chunk);
     }
 }
 
-int Dbg::AddKmers(const PacBio::Pbmer::Mers& m, const uint32_t rid)
+template <typename Keep>
+int Dbg::AddKmersIf(const PacBio::Pbmer::Mers& m, const uint32_t rid, Keep keep)
 {
     // cover the cases where the kmers are not suitable for the Dbg.
     if ((m.kmerSize > 31)) return -1;
@@ -69,12 +178,12 @@ int Dbg::AddKmers(const PacBio::Pbmer::Mers& m, const uint32_t rid)
                     kmerSize_};
 
         niby.MakeLexSmaller();
+        if (!keep(niby.mer)) continue;
 
         if (dbg_.find(niby.mer) != dbg_.end()) {
             dbg_.at(niby.mer).AddLoad(rid);
         } else {
             DbgNode eg{niby, 0};
-            eg.readIds2_.resize(nReads_);
             eg.AddLoad(rid);
             dbg_.emplace(niby.mer, std::move(eg));
         }
@@ -82,6 +191,17 @@ int Dbg::AddKmers(const PacBio::Pbmer::Mers& m, const uint32_t rid)
     return 1;
 }
 
+int Dbg::AddKmers(const PacBio::Pbmer::Mers& m, const uint32_t rid)
+{
+    return AddKmersIf(m, rid, [](uint64_t) { return true; });
+}
+
+int Dbg::AddKmers(const PacBio::Pbmer::Mers& m, const uint32_t rid, const KmerSketch& solid,
+                  const uint8_t minFreq)
+{
+    return AddKmersIf(m, rid, [&](const uint64_t mer) { return solid.Count(mer) >= minFreq; });
+}
+
 void Dbg::AddVerifedKmerPairs(std::vector<DnaBit>& bits, const uint32_t rid)
 {
 
@@ -98,7 +218,6 @@ void Dbg::AddVerifedKmerPairs(std::vector<DnaBit>& bits, const uint32_t rid)
         } else {
 
             DbgNode eg{bits[i], 0};
-            eg.readIds2_.resize(nReads_);
 
             eg.AddLoad(rid);
 
@@ -108,6 +227,132 @@ void Dbg::AddVerifedKmerPairs(std::vector<DnaBit>& bits, const uint32_t rid)
     }
 }
 
+template <typename Keep>
+int Dbg::AddKmersIf(const std::vector<PacBio::Pbmer::Mers>& mers, Parallel::ThreadPool& pool,
+                    const uint32_t firstRid, Keep keep)
+{
+    for (const auto& m : mers) {
+        if ((m.kmerSize > 31)) return -1;
+        if ((m.kmerSize % 2) == 0) return -2;
+    }
+    if (mers.empty()) return 1;
+    if (firstRid == 0 || uint64_t{firstRid} - 1 + mers.size() > nReads_) return -3;
+
+    const size_t numShards = NumShards(pool);
+    const size_t numBatches = std::min(mers.size(), numShards);
+    std::vector<ShardBuckets> batches(numBatches, ShardBuckets(numShards));
+
+    ForEachBatch(pool, mers.size(), numBatches, [&](const size_t batch, const size_t first,
+                                                    const size_t last) {
+        auto& buckets = batches[batch];
+        for (size_t i = first; i < last; ++i) {
+            const uint32_t rid = firstRid + i;
+            for (const auto& x : mers[i].forward) {
+                DnaBit niby{x.mer, static_cast<uint8_t>(x.strand == Data::Strand::FORWARD ? 0 : 1),
+                            kmerSize_};
+                niby.MakeLexSmaller();
+                if (!keep(niby.mer)) continue;
+                buckets[ShardOf(niby.mer, numShards)].push_back(
+                    ShardEntry{niby.mer, rid, niby.strand, niby.msize, 0});
+            }
+        }
+    });
+
+    MergeShards(batches, pool);
+    return 1;
+}
+
+int Dbg::AddKmers(const std::vector<PacBio::Pbmer::Mers>& mers, Parallel::ThreadPool& pool,
+                  const uint32_t firstRid)
+{
+    return AddKmersIf(mers, pool, firstRid, [](uint64_t) { return true; });
+}
+
+int Dbg::AddKmers(const std::vector<PacBio::Pbmer::Mers>& mers, Parallel::ThreadPool& pool,
+                  const KmerSketch& solid, const uint8_t minFreq, const uint32_t firstRid)
+{
+    return AddKmersIf(mers, pool, firstRid,
+                      [&](const uint64_t mer) { return solid.Count(mer) >= minFreq; });
+}
+
+int Dbg::AddVerifedKmerPairs(std::vector<std::vector<PacBio::Pbmer::DnaBit>>& bits,
+                             Parallel::ThreadPool& pool, const uint32_t firstRid)
+{
+    if (bits.empty()) return 1;
+    if (firstRid == 0 || uint64_t{firstRid} - 1 + bits.size() > nReads_) return -3;
+
+    const size_t numShards = NumShards(pool);
+    const size_t numBatches = std::min(bits.size(), numShards);
+    std::vector<ShardBuckets> batches(numBatches, ShardBuckets(numShards));
+
+    ForEachBatch(pool, bits.size(), numBatches,
+                 [&](const size_t batch, const size_t first, const size_t last) {
+                     auto& buckets = batches[batch];
+                     for (size_t i = first; i < last; ++i) {
+                         auto& read = bits[i];
+                         if (read.empty()) continue;
+
+                         const uint32_t rid = firstRid + i;
+                         for (auto& niby : read) {
+                             niby.MakeLexSmaller();
+                         }
+                         const auto edges = BuildVerifiedEdges(read);
+                         for (size_t j = 0; j < read.size(); ++j) {
+                             const DnaBit& niby = read[j];
+                             buckets[ShardOf(niby.mer, numShards)].push_back(
+                                 ShardEntry{niby.mer, rid, niby.strand, niby.msize, edges[j]});
+                         }
+                     }
+                 });
+
+    MergeShards(batches, pool);
+    return 1;
+}
+
+void Dbg::MergeShards(std::vector<ShardBuckets>& batches, Parallel::ThreadPool& pool)
+{
+    const size_t numShards = batches.front().size();
+
+    // Every shard is owned by one task, no locking needed. Batches are visited
+    // in read order, so nodes are created by the same occurrence as in a
+    // serial build.
+    std::vector<robin_hood::unordered_map<uint64_t, DbgNode>> shards(numShards);
+    Parallel::For(pool, 0, numShards, 1, [&](const size_t s) {
+        auto& shard = shards[s];
+        for (auto& buckets : batches) {
+            for (const auto& entry : buckets[s]) {
+                auto it = shard.find(entry.mer);
+                if (it == shard.end()) {
+                    DbgNode eg{DnaBit{entry.mer, entry.strand, entry.msize}, 0};
+                    it = shard.emplace(entry.mer, std::move(eg)).first;
+                }
+                it->second.AddLoad(entry.rid);
+                it->second.SetEdges(entry.edges);
+            }
+            std::vector<ShardEntry>{}.swap(buckets[s]);
+        }
+    });
+
+    size_t numNodes = dbg_.size();
+    for (const auto& shard : shards) {
+        numNodes += shard.size();
+    }
+    dbg_.reserve(numNodes);
+
+    for (auto& shard : shards) {
+        for (auto& node : shard) {
+            auto it = dbg_.find(node.first);
+            if (it == dbg_.end()) {
+                dbg_.emplace(node.first, std::move(node.second));
+            } else {
+                it->second.readIds2_ |= node.second.readIds2_;
+                it->second.SetEdges(node.second.edges_);
+            }
+        }
+        shard.clear();
+    }
+}
+
 uint8_t SetRevEdge(const DnaBit& a, const DnaBit& b)
 {
     uint8_t c = (a.strand << 1) | (b.strand);
@@ -205,35 +450,173 @@ std::vector<uint8_t> Dbg::BuildVerifiedEdges(const std::vector<PacBio::Pbmer::Dn
     return edges;
 }
 
+uint8_t Dbg::ProbeEdges(const DbgNode& node) const
+{
+    uint8_t edges = 0;
+    // all 8 possible edges
+    for (uint8_t y = 0; y < 8; ++y) {
+
+        DnaBit niby = node.dna_;
+        // pre-prending base
+        if (y <= 3) {
+            niby.PrependBase(y);
+        }
+        // appending base
+        else {
+            niby.AppendBase(y);
+        }
+
+        // generate new lex smallest
+        niby.MakeLexSmaller();
+
+        // this is a self loop
+        // TODO validate this should not be skipped.
+        if (node.dna_.mer == niby.mer) continue;
+
+        if (dbg_.find(niby.mer) != dbg_.end()) {
+            edges |= (uint8_t(1) << y);
+        }
+    }
+    return edges;
+}
+
 void Dbg::BuildEdges()
 {
     for (auto x = dbg_.begin(); x != dbg_.end(); ++x) {
-        // all 8 possible edges
-        for (uint8_t y = 0; y < 8; ++y) {
+        //setting the edges
+        x->second.SetEdges(ProbeEdges(x->second));
+    }
+}
 
-            DnaBit niby = x->second.dna_;
-            // pre-prending base
-            if (y <= 3) {
-                niby.PrependBase(y);
-            }
-            // appending base
-            else {
-                niby.AppendBase(y);
-            }
+void Dbg::BuildEdges(Parallel::ThreadPool& pool)
+{
+    // nodes only change their own edges, and the map is not modified
+    std::vector<DbgNode*> nodes;
+    nodes.reserve(dbg_.size());
+    for (auto& x : dbg_) {
+        nodes.push_back(&x.second);
+    }
+    Parallel::For(pool, 0, nodes.size(), 0,
+                  [&](const size_t i) { nodes[i]->SetEdges(ProbeEdges(*nodes[i])); });
+}
 
-            // generate new lex smallest
-            niby.MakeLexSmaller();
+int Dbg::Successors(const uint64_t kmer, std::array<uint64_t, 4>& next) const
+{
+    const uint64_t canonical = Canonical(kmer, kmerSize_);
+    const uint8_t edges = dbg_.at(canonical).edges_;
+    const bool forward = (kmer == canonical);
+
+    // appending to the reverse complement is prepending to the node's kmer
+    int n = 0;
+    for (uint8_t b = 0; b < 4; ++b) {
+        if (((edges >> (forward ? b + 4 : b)) & 1) == 0) continue;
+        const uint64_t neighbor = ((kmer << 2) | (forward ? b : 3 - b)) & KmerMask(kmerSize_);
+        if (dbg_.find(Canonical(neighbor, kmerSize_)) != dbg_.end()) next[n++] = neighbor;
+    }
+    return n;
+}
 
-            // this is a self loop
-            // TODO validate this should not be skipped.
-            if (x->second.dna_.mer == niby.mer) continue;
+int Dbg::Predecessors(const uint64_t kmer, std::array<uint64_t, 4>& prev) const
+{
+    const int n = Successors(ReverseComp64(kmer, kmerSize_), prev);
+    for (int i = 0; i < n; ++i) {
+        prev[i] = ReverseComp64(prev[i], kmerSize_);
+    }
+    return n;
+}
+
+UnitigGraph Dbg::Compact() const
+{
+    std::vector<Unitig> unitigs;
+    // first and last oriented kmer of every unitig
+    std::vector<std::pair<uint64_t, uint64_t>> ends;
+    robin_hood::unordered_map<uint64_t, uint32_t> unitigOf;
+    unitigOf.reserve(dbg_.size());
+
+    std::array<uint64_t, 4> next;
+    std::array<uint64_t, 4> prev;
+
+    const auto AddKmer = [&](Unitig& unitig, const uint64_t kmer) {
+        const uint64_t canonical = Canonical(kmer, kmerSize_);
+        const auto& readIds = dbg_.at(canonical).readIds2_;
+        unitigOf.emplace(canonical, static_cast<uint32_t>(unitigs.size()));
+        unitig.readIds |= readIds;
+        unitig.kmerCoverage += readIds.Count();
+    };
+
+    // follows unique successors, whose only predecessor is the current kmer
+    const auto BuildFrom = [&](const uint64_t start) {
+        Unitig unitig;
+        unitig.sequence = DnaBit{start, 0, kmerSize_}.KmerToStr();
+        AddKmer(unitig, start);
+
+        uint64_t kmer = start;
+        while (Successors(kmer, next) == 1 && Predecessors(next[0], prev) == 1 && prev[0] == kmer &&
+               unitigOf.find(Canonical(next[0], kmerSize_)) == unitigOf.end()) {
+            kmer = next[0];
+            unitig.sequence.push_back("ACGT"[kmer & 3]);
+            AddKmer(unitig, kmer);
+        }
+
+        ends.emplace_back(start, kmer);
+        unitigs.push_back(std::move(unitig));
+    };
+
+    for (const auto& node : dbg_) {
+        if (unitigOf.find(node.first) != unitigOf.end()) continue;
+
+        // Walk back to the start of the path. Each kmer has at most one such
+        // predecessor, and each predecessor one such successor, so the walk
+        // either ends or comes back around a cycle to this node.
+        uint64_t start = node.first;
+        while (Predecessors(start, prev) == 1 && Successors(prev[0], next) == 1 &&
+               next[0] == start && Canonical(prev[0], kmerSize_) != node.first) {
+            start = prev[0];
+        }
+        if (unitigOf.find(Canonical(start, kmerSize_)) != unitigOf.end()) start = node.first;
+
+        BuildFrom(start);
+        // only if the path folds back onto itself
+        if (unitigOf.find(node.first) == unitigOf.end()) BuildFrom(node.first);
+    }
 
-            if (dbg_.find(niby.mer) != dbg_.end()) {
-                //setting the edges
-                x->second.SetEdges((uint8_t(1) << y));
+    // Links leave the last kmer of a unitig, or the reverse complement of its
+    // first. Every link is found from both of its unitigs; keep the smaller
+    // of its two equivalent directions.
+    std::vector<std::tuple<uint32_t, bool, uint32_t, bool>> links;
+    for (uint32_t u = 0; u < unitigs.size(); ++u) {
+        for (const bool uReverse : {false, true}) {
+            const uint64_t tail =
+                uReverse ? ReverseComp64(ends[u].first, kmerSize_) : ends[u].second;
+            const int n = Successors(tail, next);
+            for (int i = 0; i < n; ++i) {
+                const uint32_t v = unitigOf.at(Canonical(next[i], kmerSize_));
+                bool vReverse = false;
+                if (next[i] == ends[v].first) {
+                    vReverse = false;
+                } else if (next[i] == ReverseComp64(ends[v].second, kmerSize_)) {
+                    vReverse = true;
+                } else {
+                    continue;
+                }
+                links.push_back(std::min(std::make_tuple(u, uReverse, v, vReverse),
+                                         std::make_tuple(v, !vReverse, u, !uReverse)));
             }
         }
     }
+    std::sort(links.begin(), links.end());
+    links.erase(std::unique(links.begin(), links.end()), links.end());
+
+    std::vector<UnitigLink> unitigLinks;
+    unitigLinks.reserve(links.size());
+    for (const auto& link : links) {
+        UnitigLink unitigLink;
+        std::tie(unitigLink.from, unitigLink.fromReverse, unitigLink.to, unitigLink.toReverse) =
+            link;
+        unitigLinks.push_back(unitigLink);
+    }
+
+    return UnitigGraph{kmerSize_, std::move(unitigs), std::move(unitigLinks)};
 }
 
 void Dbg::DumpNodes() const
@@ -241,7 +624,7 @@ void Dbg::DumpNodes() const
     for (auto x = dbg_.begin(); x != dbg_.end(); ++x) {
         std::cout << "    " << x->second.dna_.KmerToStr() << " n out:" << x->second.TotalEdgeCount()
                   << " e val: " << static_cast<int>(x->second.edges_)
-                  << " n ids: " << x->second.readIds2_.count()
+                  << " n ids: " << x->second.readIds2_.Count()
                   << " n left eg: " << x->second.LeftEdgeCount()
                   << " n right eg: " << x->second.RightEdgeCount()
                   << " n total eg: " << x->second.TotalEdgeCount() << "\n";
@@ -255,7 +638,7 @@ void Dbg::FrequencyFilterNodes(unsigned long n)
     std::vector<uint64_t> toRemove;
 
     for (auto x = dbg_.begin(); x != dbg_.end(); ++x) {
-        if (x->second.readIds2_.count() < n) {
+        if (x->second.readIds2_.Count() < n) {
             toRemove.push_back(x->first);
         }
     }
@@ -270,19 +653,37 @@ void Dbg::FrequencyFilterNodes2(unsigned long n)
     std::vector<uint64_t> toRemove;
 
     for (auto x = dbg_.begin(); x != dbg_.end(); ++x) {
-        if (x->second.readIds2_.count() < n) {
+        if (x->second.readIds2_.Count() < n) {
             toRemove.push_back(x->first);
         }
     }
-    for (const auto x : toRemove) {
-        dbg_.erase(x);
+    RemoveNodes(toRemove);
+}
+
+void Dbg::RemoveNodes(const std::vector<uint64_t>& kmers, std::vector<uint64_t>* touched)
+{
+    // neighbors of the removed nodes, from their edges before erasing them
+    std::vector<uint64_t> neighbors;
+    for (const auto x : kmers) {
+        const auto it = dbg_.find(x);
+        if (it == dbg_.end()) continue;
+        for (const auto& y : it->second) {
+            neighbors.push_back(y.mer);
+        }
+        dbg_.erase(it);
     }
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
 
     uint64_t lexSmall = 0;
 
-    for (auto x = dbg_.begin(); x != dbg_.end(); ++x) {
+    for (const auto n : neighbors) {
+        const auto x = dbg_.find(n);
+        if (x == dbg_.end()) continue;
+
+        const uint8_t edges = x->second.edges_;
         for (uint8_t y = 0; y < 8; ++y) {
-            if (((1 << y) & x->second.edges_) == 0) continue;
+            if (((1 << y) & edges) == 0) continue;
             DnaBit niby = x->second.dna_;
             // pre-prending base
             if (y <= 3) {
@@ -301,106 +702,48 @@ void Dbg::FrequencyFilterNodes2(unsigned long n)
                 x->second.edges_ &= turnOff;
             }
         }
+        if (touched && x->second.edges_ != edges) {
+            touched->push_back(n);
+        }
     }
 }
 
-BubbleInfo Dbg::GetBubbles() const
+FrozenDbg Dbg::Freeze() const
 {
-    // returned container describing which reads traverse which forks
-    BubbleInfo result;
-
-    // keeping track of read id counts over linear paths
-    // these variables are reused
-    robin_hood::unordered_map<uint32_t, int> left_reads;
-    robin_hood::unordered_map<uint32_t, int> right_reads;
-
-    // keep track of the used head/tails of bubbles.
-    std::unordered_set<uint64_t> used_branch_node;
-
-    // reused variables
-    uint64_t s1, s2, e1, e2, shared;
-
-    for (auto x = dbg_.begin(); x != dbg_.end(); ++x) {
-
-        // this node is already part of a bubble and should be ignored.
-        if (used_branch_node.find(x->second.dna_.mer) != used_branch_node.end()) continue;
-
-        // valid bubbles contain 3 or more paths
-        if (x->second.TotalEdgeCount() < 3) continue;
-        std::vector<std::tuple<uint64_t, uint64_t>> path_info;
-
-        // loop over neighboring nodes collecting the start and end node of
-        // linear paths. I.E. looping over all linear paths coming out of a node.
-        for (auto& out : x->second) {
-            auto linear_path = GetLinearPath(out);
-            if (linear_path.empty()) continue;
-            path_info.push_back(std::make_tuple(out.mer, linear_path.back().mer));
-        }
-
-        // The left and right path of a bubble.
-        std::vector<DnaBit> left;
-        std::vector<DnaBit> right;
-
-        bool bubble = false;
-
-        // Comparing all linear paths to check if they converge. The first
-        // two paths to converge are considered a bubble. subsequent bubbles are
-        // ignored.
-        for (size_t i = 0; i < path_info.size(); ++i) {
-            bubble = false;
-            for (size_t j = 0; j < path_info.size(); ++j) {
-                s1 = std::get<0>(path_info[i]);
-                s2 = std::get<0>(path_info[j]);
-                e1 = std::get<1>(path_info[i]);
-                e2 = std::get<1>(path_info[j]);
-
-                // check if the paths converge on a common neighboring node.
-                if (OneIntermediateNode(e1, e2, &shared)) {
-                    // the paths are not stored in the first loop, maybe the should?
-                    left = GetLinearPath(s1);
-                    right = GetLinearPath(s2);
-                    // set the used incoming node so we don't get 2x n bubbles
-                    used_branch_node.insert(shared);
-                    bubble = true;
-                    break;
-                }
-            }
-            // only keep the first valid bubble
-            if (bubble) break;
-        }
-
-        if (!bubble) {
-            continue;
-        }
-        // reuse the same temp data struct.
-        left_reads.clear();
-        right_reads.clear();
+    FrozenDbg frozen;
+    frozen.kmerSize_ = kmerSize_;
+    frozen.ids_.reserve(dbg_.size());
+    frozen.kmers_.reserve(dbg_.size());
+    frozen.strands_.reserve(dbg_.size());
+    frozen.readCounts_.reserve(dbg_.size());
+    frozen.readIds_.reserve(dbg_.size());
+    for (const auto& x : dbg_) {
+        frozen.ids_.emplace(x.first, static_cast<uint32_t>(frozen.kmers_.size()));
+        frozen.kmers_.push_back(x.first);
+        frozen.strands_.push_back(x.second.dna_.strand);
+        frozen.readCounts_.push_back(x.second.readIds2_.Count());
+        frozen.readIds_.push_back(&x.second.readIds2_);
+    }
 
-        for (auto const& l : left) {
-            for (size_t i = 0; i < dbg_.at(l.mer).readIds2_.size(); ++i) {
-                if (dbg_.at(l.mer).readIds2_[i] != 0) ++left_reads[i + 1];
-            }
-        }
-        for (auto const& r : right) {
-            for (size_t i = 0; i < dbg_.at(r.mer).readIds2_.size(); ++i) {
-                if (dbg_.at(r.mer).readIds2_[i] != 0) ++right_reads[i + 1];
-            }
+    // same iteration order as above, so node i gets the neighbors of id i
+    frozen.offsets_.reserve(dbg_.size() + 1);
+    frozen.offsets_.push_back(0);
+    for (const auto& x : dbg_) {
+        for (const auto& y : x.second) {
+            const auto it = frozen.ids_.find(y.mer);
+            if (it != frozen.ids_.end()) frozen.neighbors_.push_back(it->second);
         }
+        frozen.offsets_.push_back(frozen.neighbors_.size());
+    }
+    frozen.neighbors_.shrink_to_fit();
+    return frozen;
+}
 
-        std::string lk = x->second.dna_.KmerToStr() + "L";
-        std::string rk = x->second.dna_.KmerToStr() + "R";
-
-        assert(result.find(lk) == result.end());
-
-        for (const auto& kv : left_reads) {
-            result[lk].push_back(std::make_tuple(kv.first, kv.second, left.size()));
-        }
+BubbleInfo Dbg::GetBubbles() const { return Freeze().GetBubbles(); }
 
-        for (const auto& kv : right_reads) {
-            result[rk].push_back(std::make_tuple(kv.first, kv.second, right.size()));
-        }
-    }
-    return result;
+std::vector<BubbleSupport> Dbg::FindBubbles(Parallel::ThreadPool& pool) const
+{
+    return Freeze().FindBubbles(pool);
 }
 
 std::vector<DnaBit> Dbg::GetLinearPath(uint64_t x) const { return GetLinearPath(dbg_.at(x).dna_); }
@@ -492,25 +835,17 @@ bool Dbg::OneIntermediateNode(uint64_t n1, uint64_t n2, uint64_t* shared) const
 
 int Dbg::RemoveSpurs(unsigned int maxLength)
 {
+    std::vector<uint64_t> toDelete;
     int nSpurs = 0;
-
-    std::unordered_set<uint64_t> toDelete;
-
-    for (auto nodeIter = dbg_.begin(); nodeIter != dbg_.end(); ++nodeIter) {
-        // Starting at tip nodes with a degree of one.
-        if (nodeIter->second.TotalEdgeCount() != 1) continue;
-
-        // Including tip node in the linear path.
-        auto linear_path = GetLinearPath(nodeIter->second.dna_.mer);
-
-        if (linear_path.size() > maxLength) {
-            continue;
-        }
-        for (const auto x : linear_path) {
-            toDelete.insert(x.mer);
+    {
+        const FrozenDbg frozen = Freeze();
+        const auto spurs = frozen.GetSpurs(maxLength);
+        for (const auto& spur : spurs) {
+            for (const uint32_t id : spur) {
+                toDelete.push_back(frozen.Kmer(id));
+            }
         }
-
-        ++nSpurs;
+        nSpurs = spurs.size();
     }
     for (const auto x : toDelete) {
         dbg_.erase(x);
@@ -522,6 +857,47 @@ int Dbg::RemoveSpurs(unsigned int maxLength)
     return nSpurs;
 }
 
+int Dbg::TrimSpurs(const unsigned int maxLength)
+{
+    // the first round starts from every tip, later ones only from the nodes
+    // whose edges changed
+    std::vector<uint64_t> tips;
+    for (const auto& x : dbg_) {
+        if (x.second.TotalEdgeCount() == 1) {
+            tips.push_back(x.first);
+        }
+    }
+
+    int nSpurs = 0;
+    std::vector<uint64_t> toDelete;
+    std::vector<uint64_t> touched;
+    while (!tips.empty()) {
+        // spurs are found on the graph as it was at the start of the round,
+        // as RemoveSpurs does, before removing any of them
+        toDelete.clear();
+        for (const auto tip : tips) {
+            const auto it = dbg_.find(tip);
+            if (it == dbg_.end() || it->second.TotalEdgeCount() != 1) continue;
+            const auto linear_path = GetLinearPath(it->second.dna_);
+            if (linear_path.size() > maxLength) continue;
+            for (const auto& x : linear_path) {
+                toDelete.push_back(x.mer);
+            }
+            ++nSpurs;
+        }
+
+        touched.clear();
+        RemoveNodes(toDelete, &touched);
+        tips.clear();
+        for (const auto x : touched) {
+            if (dbg_.at(x).TotalEdgeCount() == 1) {
+                tips.push_back(x);
+            }
+        }
+    }
+    return nSpurs;
+}
+
 void Dbg::ResetEdges()
 {
     for (auto x = dbg_.begin(); x != dbg_.end(); ++x) {
@@ -552,11 +928,67 @@ bool Dbg::ValidateEdges() const
 bool Dbg::ValidateLoad() const
 {
     for (const auto& x : dbg_) {
-        if (x.second.readIds2_.count() == 0) return false;
+        if (x.second.readIds2_.Count() == 0) return false;
     }
     return true;
 }
 
+void Dbg::WriteBinary(const std::string& fn) const
+{
+    std::vector<uint64_t> kmers;
+    kmers.reserve(dbg_.size());
+    for (const auto& x : dbg_) {
+        kmers.push_back(x.first);
+    }
+    std::sort(kmers.begin(), kmers.end());
+
+    std::vector<uint64_t> readOffsets;
+    std::vector<uint32_t> readIds;
+    std::vector<uint8_t> edges;
+    std::vector<uint8_t> strands;
+    readOffsets.reserve(kmers.size() + 1);
+    edges.reserve(kmers.size());
+    strands.reserve(kmers.size());
+    readOffsets.push_back(0);
+    for (const uint64_t kmer : kmers) {
+        const DbgNode& node = dbg_.at(kmer);
+        node.readIds2_.ForEach([&](const uint32_t i) { readIds.push_back(i); });
+        readOffsets.push_back(readIds.size());
+        edges.push_back(node.edges_);
+        strands.push_back(node.dna_.strand);
+    }
+
+    internal::DbgFileHeader header{};
+    std::copy(std::begin(internal::DbgFileMagic), std::end(internal::DbgFileMagic), header.magic);
+    header.version = MappedDbg::Version;
+    header.kmerSize = kmerSize_;
+    header.nReads = nReads_;
+    header.nNodes = kmers.size();
+    header.nReadIds = readIds.size();
+    const internal::DbgFileSections sections{header.nNodes, header.nReadIds};
+
+    std::ofstream out{fn, std::ios::binary};
+    if (!out) {
+        throw std::runtime_error{"[pbmer] Dbg ERROR: could not open file for writing: " + fn};
+    }
+    const auto write = [&](const uint64_t offset, const void* data, const size_t n) {
+        // zero padding up to the aligned section start
+        const char padding[8] = {};
+        out.write(padding, offset - out.tellp());
+        out.write(static_cast<const char*>(data), n);
+    };
+    write(0, &header, sizeof(header));
+    write(sections.kmers, kmers.data(), 8 * kmers.size());
+    write(sections.readOffsets, readOffsets.data(), 8 * readOffsets.size());
+    write(sections.readIds, readIds.data(), 4 * readIds.size());
+    write(sections.edges, edges.data(), edges.size());
+    write(sections.strands, strands.data(), strands.size());
+    write(sections.size, nullptr, 0);
+    if (!out) {
+        throw std::runtime_error{"[pbmer] Dbg ERROR: could not write file: " + fn};
+    }
+}
+
 void Dbg::WriteGraph(std::string fn)
 {
     std::ofstream outfile;
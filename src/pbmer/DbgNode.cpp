@@ -42,10 +42,12 @@ DbgNode::DbgNode(const DnaBit& d, uint8_t o) : dna_{d}, edges_{o} {}
 
 bool DbgNode::AddLoad(uint32_t rid)
 {
-    readIds2_[rid - 1] = 1;
+    readIds2_.Insert(rid - 1);
     return true;
 }
 
+const ReadIdSet& DbgNode::ReadIds() const { return readIds2_; }
+
 int DbgNode::LeftEdgeCount() const
 {
     // 11110000 = 240
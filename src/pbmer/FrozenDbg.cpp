@@ -0,0 +1,255 @@
+#include <pbcopper/pbmer/FrozenDbg.h>
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+#include <pbcopper/parallel/For.h>
+
+namespace PacBio {
+namespace Pbmer {
+
+constexpr uint32_t FrozenDbg::NoNode;
+
+size_t FrozenDbg::NNodes() const { return kmers_.size(); }
+
+size_t FrozenDbg::NEdges() const { return neighbors_.size(); }
+
+uint8_t FrozenDbg::KmerSize() const { return kmerSize_; }
+
+uint32_t FrozenDbg::Id(const uint64_t kmer) const
+{
+    const auto it = ids_.find(kmer);
+    return (it == ids_.end()) ? NoNode : it->second;
+}
+
+uint64_t FrozenDbg::Kmer(const uint32_t id) const { return kmers_[id]; }
+
+DnaBit FrozenDbg::Dna(const uint32_t id) const
+{
+    return DnaBit{kmers_[id], strands_[id], kmerSize_};
+}
+
+uint32_t FrozenDbg::Degree(const uint32_t id) const { return offsets_[id + 1] - offsets_[id]; }
+
+FrozenDbg::NeighborRange FrozenDbg::Neighbors(const uint32_t id) const
+{
+    return NeighborRange{neighbors_.data() + offsets_[id], neighbors_.data() + offsets_[id + 1]};
+}
+
+const ReadIdSet& FrozenDbg::ReadIds(const uint32_t id) const { return *readIds_[id]; }
+
+uint32_t FrozenDbg::ReadCount(const uint32_t id) const { return readCounts_[id]; }
+
+std::vector<uint32_t> FrozenDbg::GetLinearPath(const uint32_t id) const
+{
+    std::vector<uint32_t> result;
+    LinearPath(id, result);
+    return result;
+}
+
+void FrozenDbg::LinearPath(const uint32_t id, std::vector<uint32_t>& path) const
+{
+    path.clear();
+
+    if (Degree(id) > 2) {
+        return;
+    }
+
+    // the nodes seen so far, to prevent loops, are those of the path: most
+    // paths are short enough to scan, longer ones are hashed
+    constexpr size_t MaxScan = 32;
+    std::unordered_set<uint32_t> seen;
+    const auto isSeen = [&](const uint32_t y) {
+        if (path.size() <= MaxScan) {
+            return std::find(path.begin(), path.end(), y) != path.end();
+        }
+        return seen.find(y) != seen.end();
+    };
+
+    uint32_t past = id;
+
+    while (!isSeen(past)) {
+        path.push_back(past);
+        if (path.size() > MaxScan) {
+            if (seen.empty()) {
+                seen.insert(path.begin(), path.end());
+            } else {
+                seen.insert(past);
+            }
+        }
+        for (const uint32_t y : Neighbors(past)) {
+            if (Degree(y) > 2) {
+                continue;
+            }
+            if (!isSeen(y)) {
+                past = y;
+            }
+        }
+    }
+}
+
+bool FrozenDbg::OneIntermediateNode(const uint32_t n1, const uint32_t n2, uint32_t* shared) const
+{
+    if (n1 == n2) {
+        return false;
+    }
+    // at most eight neighbors each, no set needed
+    for (const uint32_t nout2 : Neighbors(n2)) {
+        for (const uint32_t nout1 : Neighbors(n1)) {
+            if (nout1 == nout2) {
+                *shared = nout2;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+BubbleInfo FrozenDbg::GetBubbles() const
+{
+    // returned container describing which reads traverse which forks
+    BubbleInfo result;
+
+    DnaBit head{0, 0, kmerSize_};
+    for (const auto& support : FindBubbles()) {
+        head.mer = support.head;
+        const char side = (support.side == BubbleSide::LEFT) ? 'L' : 'R';
+        result[head.KmerToStr() + side].emplace_back(support.readId, support.kmerCount,
+                                                     support.pathLength);
+    }
+    return result;
+}
+
+std::vector<BubbleSupport> FrozenDbg::FindBubbles() const
+{
+    return FindBubbles([](const size_t n, const auto& f) {
+        for (size_t i = 0; i < n; ++i) {
+            f(i);
+        }
+    });
+}
+
+std::vector<BubbleSupport> FrozenDbg::FindBubbles(Parallel::ThreadPool& pool) const
+{
+    return FindBubbles([&pool](const size_t n, const auto& f) { Parallel::For(pool, 0, n, 1, f); });
+}
+
+template <typename ForEach>
+std::vector<BubbleSupport> FrozenDbg::FindBubbles(ForEach&& forEach) const
+{
+    // valid bubbles contain 3 or more paths
+    std::vector<uint32_t> forks;
+    for (uint32_t x = 0; x < NNodes(); ++x) {
+        if (Degree(x) >= 3) {
+            forks.push_back(x);
+        }
+    }
+
+    // The first two linear paths out of a fork that converge on a common
+    // neighboring node. Subsequent bubbles are ignored.
+    struct Candidate
+    {
+        bool found = false;
+        uint32_t shared = NoNode;
+        std::vector<uint32_t> left;
+        std::vector<uint32_t> right;
+    };
+    std::vector<Candidate> candidates(forks.size());
+
+    constexpr size_t Grain = 256;
+    forEach((forks.size() + Grain - 1) / Grain, [&](const size_t chunk) {
+        std::vector<std::vector<uint32_t>> paths;
+        const size_t last = std::min(forks.size(), (chunk + 1) * Grain);
+        for (size_t f = chunk * Grain; f < last; ++f) {
+            // linear paths coming out of the fork, skipping empty ones
+            paths.resize(Degree(forks[f]));
+            size_t numPaths = 0;
+            for (const uint32_t out : Neighbors(forks[f])) {
+                LinearPath(out, paths[numPaths]);
+                numPaths += !paths[numPaths].empty();
+            }
+
+            Candidate& candidate = candidates[f];
+            for (size_t i = 0; i < numPaths && !candidate.found; ++i) {
+                for (size_t j = 0; j < numPaths; ++j) {
+                    uint32_t shared;
+                    if (OneIntermediateNode(paths[i].back(), paths[j].back(), &shared)) {
+                        candidate.found = true;
+                        candidate.shared = shared;
+                        candidate.left = paths[i];
+                        candidate.right = paths[j];
+                        break;
+                    }
+                }
+            }
+        }
+    });
+
+    // Forks already used as the incoming node of a bubble are ignored, so we
+    // don't get 2x n bubbles. This depends on the order of the forks, so is
+    // done serially.
+    std::vector<bool> used_branch_node(NNodes(), false);
+    std::vector<size_t> bubbles;
+    for (size_t f = 0; f < forks.size(); ++f) {
+        if (used_branch_node[forks[f]] || !candidates[f].found) {
+            continue;
+        }
+        used_branch_node[candidates[f].shared] = true;
+        bubbles.push_back(f);
+    }
+    std::sort(bubbles.begin(), bubbles.end(),
+              [&](const size_t a, const size_t b) { return kmers_[forks[a]] < kmers_[forks[b]]; });
+
+    // read support, as (read id, kmers of the read over the path)
+    std::vector<std::vector<BubbleSupport>> supports(bubbles.size());
+    forEach(bubbles.size(), [&](const size_t b) {
+        const size_t f = bubbles[b];
+        std::vector<uint32_t> ids;
+        const auto addSide = [&](const std::vector<uint32_t>& path, const BubbleSide side) {
+            ids.clear();
+            for (const uint32_t node : path) {
+                ReadIds(node).ForEach([&](const uint32_t i) { ids.push_back(i + 1); });
+            }
+            std::sort(ids.begin(), ids.end());
+            for (size_t i = 0; i < ids.size();) {
+                size_t j = i + 1;
+                while (j < ids.size() && ids[j] == ids[i]) {
+                    ++j;
+                }
+                supports[b].push_back(BubbleSupport{kmers_[forks[f]], side, ids[i],
+                                                    static_cast<uint32_t>(j - i),
+                                                    static_cast<uint32_t>(path.size())});
+                i = j;
+            }
+        };
+        addSide(candidates[f].left, BubbleSide::LEFT);
+        addSide(candidates[f].right, BubbleSide::RIGHT);
+    });
+
+    std::vector<BubbleSupport> result;
+    for (const auto& bubble : supports) {
+        result.insert(result.end(), bubble.begin(), bubble.end());
+    }
+    return result;
+}
+
+std::vector<std::vector<uint32_t>> FrozenDbg::GetSpurs(const unsigned int maxLength) const
+{
+    std::vector<std::vector<uint32_t>> spurs;
+    for (uint32_t id = 0; id < NNodes(); ++id) {
+        // Starting at tip nodes with a degree of one.
+        if (Degree(id) != 1) continue;
+
+        // Including tip node in the linear path.
+        auto linear_path = GetLinearPath(id);
+        if (linear_path.size() > maxLength) {
+            continue;
+        }
+        spurs.push_back(std::move(linear_path));
+    }
+    return spurs;
+}
+
+}  // namespace Pbmer
+}  // namespace PacBio
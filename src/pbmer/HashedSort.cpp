@@ -0,0 +1,135 @@
+#include <pbcopper/pbmer/HashedSort.h>
+
+#include <cstddef>
+
+#include <utility>
+
+#include <pbcopper/parallel/For.h>
+#include <pbcopper/parallel/Sort.h>
+#include <pbcopper/third-party/kxsort/kxsort.h>
+
+namespace PacBio {
+namespace Pbmer {
+namespace {
+
+template <typename T>
+using Keyed = std::pair<uint64_t, T>;
+
+template <typename T>
+struct KeyedRadixTraits
+{
+    static const int nBytes = 8;
+    int kth_byte(const Keyed<T>& x, int k) { return (x.first >> (k * 8)) & 0xFF; }
+    bool compare(const Keyed<T>& x, const Keyed<T>& y) { return x.first < y.first; }
+};
+
+// Calls 'f(i)' for i in [0, n), on 'pool' if there is one
+template <typename F>
+void ForEachIndex(Parallel::ThreadPool* pool, const size_t n, F&& f)
+{
+    if (pool) {
+        Parallel::For(*pool, 0, n, 0, f);
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            f(i);
+        }
+    }
+}
+
+// Sorts 'values' by 'key(i)', called once per element
+template <typename T, typename KeyFunc>
+void SortByKey(std::vector<T>& values, KeyFunc key, Parallel::ThreadPool* pool)
+{
+    std::vector<Keyed<T>> keyed(values.size());
+    ForEachIndex(pool, values.size(), [&](const size_t i) {
+        keyed[i] = Keyed<T>{key(i), values[i]};
+    });
+
+    if (pool) {
+        Parallel::RadixSort(*pool, keyed.begin(), keyed.end(),
+                            [](const Keyed<T>& x) { return x.first; });
+    } else {
+        kx::radix_sort(keyed.begin(), keyed.end(), KeyedRadixTraits<T>());
+    }
+
+    ForEachIndex(pool, values.size(), [&](const size_t i) { values[i] = keyed[i].second; });
+}
+
+// MakeLexSmallerHashed on 'bit', returning the hash of the kept kmer
+uint64_t MakeLexSmallerHashed(DnaBit& bit)
+{
+    const uint64_t rc = ReverseComp64(bit.mer, bit.msize);
+    const uint64_t hash = Mix64Masked(bit.mer, bit.msize);
+    const uint64_t rcHash = Mix64Masked(rc, bit.msize);
+    if (rcHash <= hash) {
+        bit.mer = rc;
+        bit.strand = !bit.strand;
+        return rcHash;
+    }
+    return hash;
+}
+
+void SortHashed(std::vector<DnaBit>& bits, Parallel::ThreadPool* pool)
+{
+    SortByKey(bits, [&](const size_t i) { return Mix64Masked(bits[i].mer, bits[i].msize); }, pool);
+}
+
+void SortHashed(std::vector<Kmer>& kmers, const uint8_t kmerSize, Parallel::ThreadPool* pool)
+{
+    SortByKey(kmers, [&](const size_t i) { return Mix64Masked(kmers[i].mer, kmerSize); }, pool);
+}
+
+void CanonicalSortHashed(std::vector<DnaBit>& bits, Parallel::ThreadPool* pool)
+{
+    SortByKey(bits, [&](const size_t i) { return MakeLexSmallerHashed(bits[i]); }, pool);
+}
+
+}  // namespace
+
+void SortHashed(std::vector<DnaBit>& bits) { SortHashed(bits, nullptr); }
+
+void SortHashed(std::vector<DnaBit>& bits, Parallel::ThreadPool& pool) { SortHashed(bits, &pool); }
+
+void SortHashed(std::vector<Kmer>& kmers, const uint8_t kmerSize)
+{
+    SortHashed(kmers, kmerSize, nullptr);
+}
+
+void SortHashed(std::vector<Kmer>& kmers, const uint8_t kmerSize, Parallel::ThreadPool& pool)
+{
+    SortHashed(kmers, kmerSize, &pool);
+}
+
+void CanonicalSortHashed(std::vector<DnaBit>& bits) { CanonicalSortHashed(bits, nullptr); }
+
+void CanonicalSortHashed(std::vector<DnaBit>& bits, Parallel::ThreadPool& pool)
+{
+    CanonicalSortHashed(bits, &pool);
+}
+
+void MakeLexSmallerHashed(std::vector<DnaBit>& bits)
+{
+    for (auto& bit : bits) {
+        MakeLexSmallerHashed(bit);
+    }
+}
+
+void MakeLexSmallerHashed(std::vector<DnaBit>& bits, Parallel::ThreadPool& pool)
+{
+    Parallel::For(pool, 0, bits.size(), 0, [&](const size_t i) { MakeLexSmallerHashed(bits[i]); });
+}
+
+void MakeLexSmaller(std::vector<DnaBit>& bits)
+{
+    for (auto& bit : bits) {
+        bit.MakeLexSmaller();
+    }
+}
+
+void MakeLexSmaller(std::vector<DnaBit>& bits, Parallel::ThreadPool& pool)
+{
+    Parallel::For(pool, 0, bits.size(), 0, [&](const size_t i) { bits[i].MakeLexSmaller(); });
+}
+
+}  // namespace Pbmer
+}  // namespace PacBio
@@ -0,0 +1,286 @@
+#include <pbcopper/pbmer/KmerCounter.h>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include <pbcopper/parallel/For.h>
+#include <pbcopper/pbmer/internal/BaseEncoding.h>
+#include <pbcopper/third-party/robin_hood/robin_hood.h>
+
+namespace PacBio {
+namespace Pbmer {
+namespace {
+
+constexpr uint64_t EmptySlot = ~uint64_t{0};
+constexpr size_t MinTableSize = 256;
+
+constexpr char KmerCountsMagic[8] = {'P', 'B', 'M', 'E', 'R', 'K', 'M', 'C'};
+constexpr uint32_t KmerCountsVersion = 1;
+
+uint8_t CheckedKmerSize(const uint8_t kmerSize)
+{
+    if (kmerSize < 1 || kmerSize > 32) {
+        throw std::invalid_argument{
+            "[pbmer] kmer counter ERROR: kmer size must be in [1, 32], got " +
+            std::to_string(kmerSize)};
+    }
+    return kmerSize;
+}
+
+int PartitionBits(const size_t numPartitions)
+{
+    int bits = 0;
+    while ((size_t{1} << bits) < numPartitions) {
+        ++bits;
+    }
+    return bits;
+}
+
+uint64_t Hash(const uint64_t kmer) { return robin_hood::hash_int(kmer); }
+
+// Calls 'f(canonical)' for every kmer of 'dna'
+template <typename F>
+void ForEachCanonical(const std::string& dna, const uint8_t kmerSize, F&& f)
+{
+    internal::ForEachKmer(
+        dna.data(), dna.size(), kmerSize,
+        [&](const uint64_t forward, const uint64_t reverse) { f(std::min(forward, reverse)); },
+        []() {});
+}
+
+}  // namespace
+
+// -------------------------------------------
+// KmerCounter::Partition
+
+void KmerCounter::Partition::Add(const uint64_t kmer, const uint64_t hash, const uint32_t n)
+{
+    // keep the load factor under 3/4
+    if (4 * (size_ + 1) > 3 * kmers_.size()) {
+        Grow();
+    }
+
+    const size_t mask = kmers_.size() - 1;
+    size_t slot = hash & mask;
+    while (kmers_[slot] != kmer) {
+        if (kmers_[slot] == EmptySlot) {
+            kmers_[slot] = kmer;
+            ++size_;
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    counts_[slot] += std::min(n, std::numeric_limits<uint32_t>::max() - counts_[slot]);
+}
+
+uint32_t KmerCounter::Partition::Count(const uint64_t kmer, const uint64_t hash) const
+{
+    if (kmers_.empty()) {
+        return 0;
+    }
+    const size_t mask = kmers_.size() - 1;
+    for (size_t slot = hash & mask; kmers_[slot] != EmptySlot; slot = (slot + 1) & mask) {
+        if (kmers_[slot] == kmer) {
+            return counts_[slot];
+        }
+    }
+    return 0;
+}
+
+void KmerCounter::Partition::Grow()
+{
+    std::vector<uint64_t> kmers(std::max(MinTableSize, 2 * kmers_.size()), EmptySlot);
+    std::vector<uint32_t> counts(kmers.size(), 0);
+    kmers.swap(kmers_);
+    counts.swap(counts_);
+
+    const size_t mask = kmers_.size() - 1;
+    for (size_t i = 0; i < kmers.size(); ++i) {
+        if (kmers[i] == EmptySlot) {
+            continue;
+        }
+        size_t slot = Hash(kmers[i]) & mask;
+        while (kmers_[slot] != EmptySlot) {
+            slot = (slot + 1) & mask;
+        }
+        kmers_[slot] = kmers[i];
+        counts_[slot] = counts[i];
+    }
+}
+
+size_t KmerCounter::Partition::Size() const { return size_; }
+
+size_t KmerCounter::Partition::MemoryUsage() const
+{
+    return kmers_.capacity() * sizeof(uint64_t) + counts_.capacity() * sizeof(uint32_t);
+}
+
+// -------------------------------------------
+// KmerCounter
+
+KmerCounter::KmerCounter(const uint8_t kmerSize, const size_t numPartitions)
+    : kmerSize_{CheckedKmerSize(kmerSize)}
+    , partitionBits_{PartitionBits(numPartitions)}
+    , partitions_(size_t{1} << partitionBits_)
+{
+}
+
+size_t KmerCounter::PartitionOf(const uint64_t hash) const
+{
+    // high bits, the table slots use the low ones
+    return (partitionBits_ == 0) ? 0 : (hash >> (64 - partitionBits_));
+}
+
+void KmerCounter::AddRead(const std::string& dna)
+{
+    ForEachCanonical(dna, kmerSize_, [&](const uint64_t kmer) {
+        const uint64_t hash = Hash(kmer);
+        partitions_[PartitionOf(hash)].Add(kmer, hash);
+    });
+}
+
+void KmerCounter::AddReads(const std::vector<std::string>& reads, Parallel::ThreadPool& pool,
+                           const size_t basesPerRound)
+{
+    // One bucket per partition, per batch of reads. Buckets keep their
+    // capacity from round to round, bounded by the bases of a round.
+    const size_t numBatches = 4 * (pool.NumThreads() + 1);
+    std::vector<std::vector<std::vector<uint64_t>>> buckets(
+        numBatches, std::vector<std::vector<uint64_t>>(partitions_.size()));
+
+    for (size_t first = 0; first < reads.size();) {
+        // at least one read per round, however long
+        size_t last = first + 1;
+        size_t bases = reads[first].size();
+        while (last < reads.size() && bases + reads[last].size() <= basesPerRound) {
+            bases += reads[last].size();
+            ++last;
+        }
+
+        // split the reads of the round into buckets
+        const size_t numReads = last - first;
+        const size_t roundBatches = std::min(numReads, numBatches);
+        Parallel::For(pool, 0, roundBatches, 1, [&](const size_t batch) {
+            const size_t begin = first + batch * numReads / roundBatches;
+            const size_t end = first + (batch + 1) * numReads / roundBatches;
+            for (size_t i = begin; i < end; ++i) {
+                ForEachCanonical(reads[i], kmerSize_, [&](const uint64_t kmer) {
+                    buckets[batch][PartitionOf(Hash(kmer))].push_back(kmer);
+                });
+            }
+        });
+
+        // then count each partition on one task
+        Parallel::For(pool, 0, partitions_.size(), 1, [&](const size_t p) {
+            for (size_t batch = 0; batch < roundBatches; ++batch) {
+                for (const uint64_t kmer : buckets[batch][p]) {
+                    partitions_[p].Add(kmer, Hash(kmer));
+                }
+                buckets[batch][p].clear();
+            }
+        });
+
+        first = last;
+    }
+}
+
+uint8_t KmerCounter::KmerSize() const { return kmerSize_; }
+
+size_t KmerCounter::NumDistinct() const
+{
+    size_t result = 0;
+    for (const auto& partition : partitions_) {
+        result += partition.Size();
+    }
+    return result;
+}
+
+uint64_t KmerCounter::NumTotal() const
+{
+    uint64_t result = 0;
+    for (const auto& partition : partitions_) {
+        partition.ForEach([&](uint64_t, const uint32_t count) { result += count; });
+    }
+    return result;
+}
+
+uint32_t KmerCounter::Count(const uint64_t kmer) const
+{
+    const uint64_t hash = Hash(kmer);
+    return partitions_[PartitionOf(hash)].Count(kmer, hash);
+}
+
+std::vector<uint64_t> KmerCounter::Histogram(const uint32_t maxCount) const
+{
+    if (maxCount == 0) {
+        throw std::invalid_argument{"[pbmer] kmer counter ERROR: histogram maxCount must be > 0"};
+    }
+
+    // sized by the largest count seen, so that a huge maxCount costs nothing
+    uint32_t largest = 0;
+    for (const auto& partition : partitions_) {
+        partition.ForEach(
+            [&](uint64_t, const uint32_t count) { largest = std::max(largest, count); });
+    }
+
+    std::vector<uint64_t> result(size_t{std::min(largest, maxCount)} + 1, 0);
+    for (const auto& partition : partitions_) {
+        partition.ForEach(
+            [&](uint64_t, const uint32_t count) { ++result[std::min(count, maxCount)]; });
+    }
+    return result;
+}
+
+std::vector<std::pair<uint64_t, uint32_t>> KmerCounter::SortedCounts(const uint32_t minCount) const
+{
+    std::vector<std::pair<uint64_t, uint32_t>> result;
+    for (const auto& partition : partitions_) {
+        partition.ForEach([&](const uint64_t kmer, const uint32_t count) {
+            if (count >= minCount) {
+                result.emplace_back(kmer, count);
+            }
+        });
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void KmerCounter::WriteSorted(const std::string& fn, const uint32_t minCount) const
+{
+    const auto counts = SortedCounts(minCount);
+
+    std::ofstream out{fn, std::ios::binary};
+    if (!out) {
+        throw std::runtime_error{"[pbmer] kmer counter ERROR: could not open file for writing: " +
+                                 fn};
+    }
+    const uint32_t kmerSize = kmerSize_;
+    const uint64_t numKmers = counts.size();
+    out.write(KmerCountsMagic, sizeof(KmerCountsMagic));
+    out.write(reinterpret_cast<const char*>(&KmerCountsVersion), sizeof(KmerCountsVersion));
+    out.write(reinterpret_cast<const char*>(&kmerSize), sizeof(kmerSize));
+    out.write(reinterpret_cast<const char*>(&numKmers), sizeof(numKmers));
+    for (const auto& kc : counts) {
+        out.write(reinterpret_cast<const char*>(&kc.first), sizeof(kc.first));
+    }
+    for (const auto& kc : counts) {
+        out.write(reinterpret_cast<const char*>(&kc.second), sizeof(kc.second));
+    }
+    if (!out) {
+        throw std::runtime_error{"[pbmer] kmer counter ERROR: could not write file: " + fn};
+    }
+}
+
+size_t KmerCounter::MemoryUsage() const
+{
+    size_t result = 0;
+    for (const auto& partition : partitions_) {
+        result += partition.MemoryUsage();
+    }
+    return result;
+}
+
+}  // namespace Pbmer
+}  // namespace PacBio
@@ -0,0 +1,117 @@
+#include <pbcopper/pbmer/KmerSketch.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include <pbcopper/pbmer/DnaBit.h>
+
+namespace PacBio {
+namespace Pbmer {
+namespace {
+
+constexpr int MaxDepth = 8;
+
+int CheckedDepth(const int depth)
+{
+    if (depth < 1 || depth > MaxDepth) {
+        throw std::invalid_argument{"[pbmer] kmer sketch ERROR: depth must be in [1, " +
+                                    std::to_string(MaxDepth) + "], got " + std::to_string(depth)};
+    }
+    return depth;
+}
+
+size_t RowWidth(const size_t memoryBytes, const int depth)
+{
+    size_t width = 64;
+    while (width * 2 * depth <= memoryBytes) {
+        width *= 2;
+    }
+    return width;
+}
+
+// splitmix64 finalizer
+uint64_t Mix(uint64_t x)
+{
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+}  // namespace
+
+constexpr uint8_t KmerSketch::MaxCount;
+
+KmerSketch::KmerSketch(const size_t memoryBytes, const int depth)
+    : width_{RowWidth(memoryBytes, CheckedDepth(depth))}, depth_{depth}, counts_(width_ * depth_, 0)
+{
+}
+
+void KmerSketch::Slots(const uint64_t kmer, size_t* slots) const
+{
+    // double hashing: row i uses h1 + i * h2, h2 odd so rows differ
+    const uint64_t h1 = Mix(kmer);
+    const uint64_t h2 = Mix(kmer ^ 0x9E3779B97F4A7C15ULL) | 1;
+    for (int i = 0; i < depth_; ++i) {
+        slots[i] = i * width_ + ((h1 + i * h2) & (width_ - 1));
+    }
+}
+
+void KmerSketch::Add(const uint64_t kmer)
+{
+    size_t slots[MaxDepth];
+    Slots(kmer, slots);
+
+    uint8_t count = MaxCount;
+    for (int i = 0; i < depth_; ++i) {
+        count = std::min(count, counts_[slots[i]]);
+    }
+    if (count == MaxCount) {
+        return;
+    }
+    for (int i = 0; i < depth_; ++i) {
+        if (counts_[slots[i]] == count) {
+            ++counts_[slots[i]];
+        }
+    }
+}
+
+void KmerSketch::AddKmers(const Mers& m)
+{
+    for (const auto& x : m.forward) {
+        Add(std::min(x.mer, ReverseComp64(x.mer, m.kmerSize)));
+    }
+}
+
+uint8_t KmerSketch::Count(const uint64_t kmer) const
+{
+    size_t slots[MaxDepth];
+    Slots(kmer, slots);
+
+    uint8_t count = MaxCount;
+    for (int i = 0; i < depth_; ++i) {
+        count = std::min(count, counts_[slots[i]]);
+    }
+    return count;
+}
+
+void KmerSketch::Merge(const KmerSketch& other)
+{
+    if (width_ != other.width_ || depth_ != other.depth_) {
+        throw std::invalid_argument{"[pbmer] kmer sketch ERROR: sketch shapes differ"};
+    }
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        counts_[i] = std::min<int>(MaxCount, counts_[i] + other.counts_[i]);
+    }
+}
+
+void KmerSketch::Clear() { std::fill(counts_.begin(), counts_.end(), 0); }
+
+size_t KmerSketch::Width() const { return width_; }
+
+int KmerSketch::Depth() const { return depth_; }
+
+size_t KmerSketch::MemoryUsage() const { return counts_.size(); }
+
+}  // namespace Pbmer
+}  // namespace PacBio
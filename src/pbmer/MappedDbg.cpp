@@ -0,0 +1,178 @@
+#include <pbcopper/pbmer/MappedDbg.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include <pbcopper/pbmer/DbgNode.h>
+#include <pbcopper/pbmer/internal/DbgFile.h>
+
+namespace PacBio {
+namespace Pbmer {
+
+constexpr uint32_t MappedDbg::NoNode;
+constexpr uint32_t MappedDbg::Version;
+
+MappedDbg::MappedDbg(const std::string& fn)
+{
+    const auto fail = [&](const std::string& msg) {
+        Unmap();
+        throw std::runtime_error{"[pbmer] mapped graph ERROR: " + msg + ": " + fn};
+    };
+
+    const int fd = open(fn.c_str(), O_RDONLY);
+    if (fd < 0) {
+        fail("could not open file");
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        fail("could not stat file");
+    }
+    size_ = st.st_size;
+    if (size_ >= sizeof(internal::DbgFileHeader)) {
+        data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data_ == MAP_FAILED) {
+            data_ = nullptr;
+        }
+    }
+    close(fd);
+    if (!data_) {
+        fail("could not map file");
+    }
+
+    internal::DbgFileHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    if (std::memcmp(header.magic, internal::DbgFileMagic, sizeof(header.magic)) != 0) {
+        fail("not a graph file");
+    }
+    if (header.version != Version) {
+        fail("unsupported graph file version " + std::to_string(header.version));
+    }
+    if (header.kmerSize < 1 || header.kmerSize > 32) {
+        fail("invalid kmer size " + std::to_string(header.kmerSize));
+    }
+    // a node takes at least 18 bytes and a read index 4, which bounds both
+    // counts before they are used to compute offsets
+    if (header.nNodes >= NoNode || header.nNodes > size_ / 18 || header.nReadIds > size_ / 4) {
+        fail("truncated or corrupt graph file");
+    }
+    const internal::DbgFileSections sections{header.nNodes, header.nReadIds};
+    if (sections.size != size_) {
+        fail("truncated or corrupt graph file");
+    }
+
+    kmerSize_ = header.kmerSize;
+    nReads_ = header.nReads;
+    nNodes_ = header.nNodes;
+
+    const char* base = static_cast<const char*>(data_);
+    kmers_ = reinterpret_cast<const uint64_t*>(base + sections.kmers);
+    readOffsets_ = reinterpret_cast<const uint64_t*>(base + sections.readOffsets);
+    readIds_ = reinterpret_cast<const uint32_t*>(base + sections.readIds);
+    edges_ = reinterpret_cast<const uint8_t*>(base + sections.edges);
+    strands_ = reinterpret_cast<const uint8_t*>(base + sections.strands);
+
+    // ReadIds trusts the offsets, check them once
+    if (readOffsets_[0] != 0 || readOffsets_[nNodes_] != header.nReadIds) {
+        fail("truncated or corrupt graph file");
+    }
+    for (uint64_t i = 0; i < nNodes_; ++i) {
+        if (readOffsets_[i] > readOffsets_[i + 1]) {
+            fail("corrupt read offsets in graph file");
+        }
+    }
+}
+
+MappedDbg::MappedDbg(MappedDbg&& other) noexcept { *this = std::move(other); }
+
+MappedDbg& MappedDbg::operator=(MappedDbg&& other) noexcept
+{
+    if (this != &other) {
+        Unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        kmerSize_ = other.kmerSize_;
+        nReads_ = other.nReads_;
+        nNodes_ = std::exchange(other.nNodes_, 0);
+        kmers_ = other.kmers_;
+        readOffsets_ = other.readOffsets_;
+        readIds_ = other.readIds_;
+        edges_ = other.edges_;
+        strands_ = other.strands_;
+    }
+    return *this;
+}
+
+MappedDbg::~MappedDbg() { Unmap(); }
+
+void MappedDbg::Unmap()
+{
+    if (data_) {
+        munmap(data_, size_);
+        data_ = nullptr;
+    }
+}
+
+size_t MappedDbg::NNodes() const { return nNodes_; }
+
+size_t MappedDbg::NEdges() const
+{
+    size_t result = 0;
+    for (uint64_t i = 0; i < nNodes_; ++i) {
+        result += __builtin_popcount(edges_[i]);
+    }
+    return result;
+}
+
+uint8_t MappedDbg::KmerSize() const { return kmerSize_; }
+
+uint32_t MappedDbg::NReads() const { return nReads_; }
+
+uint32_t MappedDbg::Id(const uint64_t kmer) const
+{
+    const uint64_t* last = kmers_ + nNodes_;
+    const uint64_t* it = std::lower_bound(kmers_, last, kmer);
+    return (it == last || *it != kmer) ? NoNode : static_cast<uint32_t>(it - kmers_);
+}
+
+uint64_t MappedDbg::Kmer(const uint32_t id) const { return kmers_[id]; }
+
+DnaBit MappedDbg::Dna(const uint32_t id) const
+{
+    return DnaBit{kmers_[id], strands_[id], kmerSize_};
+}
+
+uint8_t MappedDbg::Edges(const uint32_t id) const { return edges_[id]; }
+
+int MappedDbg::Degree(const uint32_t id) const { return __builtin_popcount(edges_[id]); }
+
+int MappedDbg::Neighbors(const uint32_t id, std::array<uint64_t, 8>& neighbors) const
+{
+    int n = 0;
+    const DbgNode node{Dna(id), edges_[id]};
+    for (const auto& y : node) {
+        neighbors[n++] = y.mer;
+    }
+    return n;
+}
+
+MappedDbg::ReadIdRange MappedDbg::ReadIds(const uint32_t id) const
+{
+    return ReadIdRange{readIds_ + readOffsets_[id], readIds_ + readOffsets_[id + 1]};
+}
+
+uint32_t MappedDbg::ReadCount(const uint32_t id) const
+{
+    return readOffsets_[id + 1] - readOffsets_[id];
+}
+
+}  // namespace Pbmer
+}  // namespace PacBio
@@ -8,6 +8,8 @@
 #include <limits>
 #include <stdexcept>
 
+#include <pbcopper/pbmer/MinimizerScanner.h>
+
 namespace PacBio {
 namespace Pbmer {
 
@@ -102,26 +104,11 @@ std::vector<Kmer> Mers::BuildNMPs() const
 
     if (kmerSize > 16) throw std::runtime_error{"[pbmer] Mers ERROR: Kmer must be <= 16 bp."};
 
-    // no mask because we are merging to minimizers up to 32 bits.
-    const uint64_t mask = ~uint64_t(0);
-
     std::vector<Kmer> nmps;
 
-    uint64_t minA;
-    uint64_t minB;
-
     for (size_t i = 1; i < minimizers.size(); ++i) {
-        Kmer nm{minimizers[i].mer, 0, Data::Strand::FORWARD};
-        minA = minimizers[i - 1].mer;
-        minB = nm.mer;
-        if (minA <= minB) {
-            nm.mer = (minA << 32) | minB;
-        } else {
-            nm.mer = (minB << 32) | minA;
-        }
-        nm.mer = Mix64Masked(nm.mer, mask);
-
-        nmps.push_back(nm);
+        nmps.emplace_back(MinimizerScanner::NmpHash(minimizers[i - 1].mer, minimizers[i].mer), 0,
+                          Data::Strand::FORWARD);
     }
 
     return nmps;
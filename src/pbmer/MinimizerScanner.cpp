@@ -0,0 +1,32 @@
+#include <pbcopper/pbmer/MinimizerScanner.h>
+
+namespace PacBio {
+namespace Pbmer {
+
+MinimizerScanner::MinimizerScanner(const uint8_t kmerSize, const unsigned int winSize)
+    : kmerSize_{kmerSize}, winSize_{winSize}
+{
+    if (kmerSize_ == 0 || kmerSize_ > 32)
+        throw std::runtime_error{"[pbmer] minimizer ERROR: kmer size must be in [1, 32]."};
+    if (winSize_ == 0)
+        throw std::runtime_error{"[pbmer] minimizer ERROR: window size must be at least 1."};
+}
+
+uint8_t MinimizerScanner::KmerSize() const { return kmerSize_; }
+
+unsigned int MinimizerScanner::WindowSize() const { return winSize_; }
+
+void MinimizerScanner::Minimizers(const std::string& dna, std::vector<Kmer>& minimizers) const
+{
+    ForEachMinimizer(dna, [&minimizers](const Kmer& kmer) { minimizers.push_back(kmer); });
+}
+
+std::vector<Kmer> MinimizerScanner::Minimizers(const std::string& dna) const
+{
+    std::vector<Kmer> minimizers;
+    Minimizers(dna, minimizers);
+    return minimizers;
+}
+
+}  // namespace Pbmer
+}  // namespace PacBio
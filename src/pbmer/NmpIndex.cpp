@@ -0,0 +1,205 @@
+#include <pbcopper/pbmer/NmpIndex.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+
+#include <pbcopper/parallel/For.h>
+#include <pbcopper/parallel/Sort.h>
+
+namespace PacBio {
+namespace Pbmer {
+namespace {
+
+uint8_t CheckedKmerSize(const uint8_t kmerSize)
+{
+    if (kmerSize > 16) {
+        throw std::runtime_error{"[pbmer] NMP index ERROR: kmer size must be <= 16 bp."};
+    }
+    return kmerSize;
+}
+
+struct Hit
+{
+    uint32_t readId;
+    Data::Strand strand;
+    int64_t diagonal;
+};
+
+}  // namespace
+
+constexpr uint32_t NmpIndex::NoRead;
+
+bool operator==(const NmpCandidate& lhs, const NmpCandidate& rhs)
+{
+    return std::tie(lhs.readId, lhs.strand, lhs.count, lhs.diagonal) ==
+           std::tie(rhs.readId, rhs.strand, rhs.count, rhs.diagonal);
+}
+
+NmpIndex::NmpIndex(const uint8_t kmerSize, const unsigned int winSize)
+    : scanner_{CheckedKmerSize(kmerSize), winSize}
+{
+}
+
+template <typename F>
+void NmpIndex::ForEachNmp(const std::string& dna, F&& f) const
+{
+    if (dna.size() < scanner_.KmerSize()) {
+        return;
+    }
+
+    // Pairs hashed as Mers::BuildNMPs, located by the sum of both minimizer
+    // positions and oriented by the strand of the smaller one, so that a pair
+    // and its reverse complement agree on the hash and disagree on the strand
+    scanner_.ForEachNmp(dna, [&](const Kmer& nmp, const Kmer& previous, const Kmer& current) {
+        const Kmer& lower = (previous.mer <= current.mer) ? previous : current;
+        const uint32_t pos = previous.pos + current.pos;
+        f(nmp.mer, (pos << 1) | (lower.strand == Data::Strand::REVERSE));
+    });
+}
+
+void NmpIndex::AddRead(const uint32_t readId, const std::string& dna)
+{
+    ForEachNmp(dna, [&](const uint64_t hash, const uint32_t posStrand) {
+        pending_.emplace_back(hash, Posting{readId, posStrand});
+    });
+}
+
+void NmpIndex::AddReads(const std::vector<std::string>& reads, Parallel::ThreadPool& pool,
+                        const uint32_t firstReadId)
+{
+    std::vector<std::vector<Entry>> perRead(reads.size());
+    Parallel::For(pool, 0, reads.size(), 0, [&](const size_t i) {
+        const uint32_t readId = firstReadId + i;
+        ForEachNmp(reads[i], [&](const uint64_t hash, const uint32_t posStrand) {
+            perRead[i].emplace_back(hash, Posting{readId, posStrand});
+        });
+    });
+
+    size_t total = pending_.size();
+    for (const auto& entries : perRead) {
+        total += entries.size();
+    }
+    pending_.reserve(total);
+    for (auto& entries : perRead) {
+        pending_.insert(pending_.end(), entries.cbegin(), entries.cend());
+        std::vector<Entry>{}.swap(entries);
+    }
+}
+
+void NmpIndex::Build() { Build(nullptr); }
+
+void NmpIndex::Build(Parallel::ThreadPool& pool) { Build(&pool); }
+
+void NmpIndex::Build(Parallel::ThreadPool* pool)
+{
+    if (pending_.empty()) {
+        return;
+    }
+
+    // Put the current postings back in front of the new ones, so that the
+    // stable sort keeps them first
+    std::vector<Entry> entries;
+    entries.reserve(postings_.size() + pending_.size());
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        for (uint64_t j = offsets_[i]; j < offsets_[i + 1]; ++j) {
+            entries.emplace_back(keys_[i], postings_[j]);
+        }
+    }
+    entries.insert(entries.end(), pending_.cbegin(), pending_.cend());
+    std::vector<Entry>{}.swap(pending_);
+
+    if (pool) {
+        Parallel::RadixSort(*pool, entries.begin(), entries.end(),
+                            [](const Entry& x) { return x.first; });
+    } else {
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const Entry& lhs, const Entry& rhs) { return lhs.first < rhs.first; });
+    }
+
+    keys_.clear();
+    offsets_.clear();
+    postings_.clear();
+    postings_.reserve(entries.size());
+    for (const auto& entry : entries) {
+        if (keys_.empty() || keys_.back() != entry.first) {
+            keys_.push_back(entry.first);
+            offsets_.push_back(postings_.size());
+        }
+        postings_.push_back(entry.second);
+    }
+    offsets_.push_back(postings_.size());
+    keys_.shrink_to_fit();
+    offsets_.shrink_to_fit();
+}
+
+std::vector<NmpCandidate> NmpIndex::Query(const std::string& dna, const uint32_t minShared,
+                                          const uint32_t selfId, const size_t maxOccurrences) const
+{
+    std::vector<Hit> hits;
+    ForEachNmp(dna, [&](const uint64_t hash, const uint32_t posStrand) {
+        const auto it = std::lower_bound(keys_.cbegin(), keys_.cend(), hash);
+        if (it == keys_.cend() || *it != hash) {
+            return;
+        }
+        const size_t key = std::distance(keys_.cbegin(), it);
+        const uint64_t first = offsets_[key];
+        const uint64_t last = offsets_[key + 1];
+        if (maxOccurrences > 0 && last - first > maxOccurrences) {
+            return;
+        }
+
+        // positions are sums of both minimizer positions, i.e. twice the midpoint
+        const int64_t queryPos = posStrand >> 1;
+        for (uint64_t i = first; i < last; ++i) {
+            const Posting& posting = postings_[i];
+            if (posting.readId == selfId) {
+                continue;
+            }
+            const int64_t readPos = posting.posStrand >> 1;
+            if ((posting.posStrand & 1) == (posStrand & 1)) {
+                hits.push_back(
+                    Hit{posting.readId, Data::Strand::FORWARD, (queryPos - readPos) / 2});
+            } else {
+                hits.push_back(
+                    Hit{posting.readId, Data::Strand::REVERSE, (queryPos + readPos) / 2});
+            }
+        }
+    });
+
+    std::sort(hits.begin(), hits.end(), [](const Hit& lhs, const Hit& rhs) {
+        return std::tie(lhs.readId, lhs.strand, lhs.diagonal) <
+               std::tie(rhs.readId, rhs.strand, rhs.diagonal);
+    });
+
+    std::vector<NmpCandidate> result;
+    for (size_t first = 0; first < hits.size();) {
+        size_t last = first + 1;
+        while (last < hits.size() && hits[last].readId == hits[first].readId &&
+               hits[last].strand == hits[first].strand) {
+            ++last;
+        }
+        const uint32_t count = last - first;
+        if (count >= minShared) {
+            result.push_back(NmpCandidate{hits[first].readId, hits[first].strand, count,
+                                          hits[first + count / 2].diagonal});
+        }
+        first = last;
+    }
+    return result;
+}
+
+size_t NmpIndex::NumKeys() const { return keys_.size(); }
+
+size_t NmpIndex::NumNmps() const { return postings_.size(); }
+
+size_t NmpIndex::NumPending() const { return pending_.size(); }
+
+size_t NmpIndex::MemoryUsage() const
+{
+    return keys_.capacity() * sizeof(uint64_t) + offsets_.capacity() * sizeof(uint64_t) +
+           postings_.capacity() * sizeof(Posting) + pending_.capacity() * sizeof(Entry);
+}
+
+}  // namespace Pbmer
+}  // namespace PacBio
@@ -0,0 +1,123 @@
+#include <pbcopper/pbmer/ReadIdSet.h>
+
+#include <algorithm>
+#include <iterator>
+
+namespace PacBio {
+namespace Pbmer {
+namespace {
+
+// number of bitmap words covering read indices [0, maxId]
+size_t NumWords(const uint32_t maxId) { return maxId / 32 + 1; }
+
+}  // namespace
+
+bool ReadIdSet::Insert(const uint32_t id)
+{
+    if (dense_) {
+        const size_t w = id / 32;
+        if (w >= data_.size()) data_.resize(w + 1, 0);
+        const uint32_t bit = uint32_t{1} << (id % 32);
+        if ((data_[w] & bit) != 0) return false;
+        data_[w] |= bit;
+        ++count_;
+        return true;
+    }
+
+    // skip the first few reallocations, kmers are rarely covered by one read only
+    if (data_.capacity() == 0) data_.reserve(4);
+
+    // reads are usually added in order, making this an append
+    auto it = (data_.empty() || id > data_.back())
+                  ? data_.end()
+                  : std::lower_bound(data_.begin(), data_.end(), id);
+    if (it != data_.end() && *it == id) return false;
+
+    const uint32_t maxId = data_.empty() ? id : std::max(id, data_.back());
+    if (count_ + 1 > NumWords(maxId)) {
+        MakeDense(maxId);
+        return Insert(id);
+    }
+
+    data_.insert(it, id);
+    ++count_;
+    return true;
+}
+
+bool ReadIdSet::Contains(const uint32_t id) const
+{
+    if (dense_) {
+        const size_t w = id / 32;
+        return w < data_.size() && (data_[w] >> (id % 32) & 1) != 0;
+    }
+    return std::binary_search(data_.cbegin(), data_.cend(), id);
+}
+
+uint32_t ReadIdSet::Count() const { return count_; }
+
+bool ReadIdSet::IsDense() const { return dense_; }
+
+size_t ReadIdSet::MemoryUsage() const { return data_.capacity() * sizeof(uint32_t); }
+
+void ReadIdSet::Clear()
+{
+    std::vector<uint32_t>{}.swap(data_);
+    count_ = 0;
+    dense_ = false;
+}
+
+ReadIdSet& ReadIdSet::operator|=(const ReadIdSet& other)
+{
+    if (other.count_ == 0) return *this;
+
+    if (!dense_ && !other.dense_) {
+        std::vector<uint32_t> merged;
+        merged.reserve(data_.size() + other.data_.size());
+        std::set_union(data_.cbegin(), data_.cend(), other.data_.cbegin(), other.data_.cend(),
+                       std::back_inserter(merged));
+        data_.swap(merged);
+        count_ = data_.size();
+        if (count_ > NumWords(data_.back())) MakeDense(data_.back());
+        return *this;
+    }
+
+    if (!dense_) MakeDense(data_.empty() ? 0 : data_.back());
+
+    if (!other.dense_) {
+        for (const uint32_t id : other.data_) {
+            Insert(id);
+        }
+        return *this;
+    }
+
+    if (data_.size() < other.data_.size()) data_.resize(other.data_.size(), 0);
+    count_ = 0;
+    for (size_t w = 0; w < data_.size(); ++w) {
+        if (w < other.data_.size()) data_[w] |= other.data_[w];
+        count_ += __builtin_popcount(data_[w]);
+    }
+    return *this;
+}
+
+std::vector<uint32_t> ReadIdSet::Ids() const
+{
+    if (!dense_) return data_;
+
+    std::vector<uint32_t> ids;
+    ids.reserve(count_);
+    ForEach([&ids](const uint32_t id) { ids.push_back(id); });
+    return ids;
+}
+
+void ReadIdSet::MakeDense(const uint32_t maxId)
+{
+    std::vector<uint32_t> bitmap(NumWords(maxId), 0);
+    for (const uint32_t id : data_) {
+        bitmap[id / 32] |= uint32_t{1} << (id % 32);
+    }
+    data_.swap(bitmap);
+    dense_ = true;
+}
+
+}  // namespace Pbmer
+}  // namespace PacBio
@@ -0,0 +1,63 @@
+#include <pbcopper/pbmer/UnitigGraph.h>
+
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+namespace PacBio {
+namespace Pbmer {
+
+UnitigGraph::UnitigGraph(const uint8_t kmerSize, std::vector<Unitig> unitigs,
+                         std::vector<UnitigLink> links)
+    : kmerSize_{kmerSize}, unitigs_{std::move(unitigs)}, links_{std::move(links)}
+{
+}
+
+uint8_t UnitigGraph::KmerSize() const { return kmerSize_; }
+
+size_t UnitigGraph::NumUnitigs() const { return unitigs_.size(); }
+
+size_t UnitigGraph::NumKmers(const uint32_t id) const
+{
+    return unitigs_.at(id).sequence.size() - kmerSize_ + 1;
+}
+
+double UnitigGraph::MeanCoverage(const uint32_t id) const
+{
+    return static_cast<double>(unitigs_.at(id).kmerCoverage) / NumKmers(id);
+}
+
+const std::vector<Unitig>& UnitigGraph::Unitigs() const { return unitigs_; }
+
+const std::vector<UnitigLink>& UnitigGraph::Links() const { return links_; }
+
+void UnitigGraph::WriteGfa(std::ostream& out) const
+{
+    out << "H\tVN:Z:1.0\n";
+    for (uint32_t id = 0; id < unitigs_.size(); ++id) {
+        const Unitig& unitig = unitigs_[id];
+        out << "S\t" << id << '\t' << unitig.sequence << "\tLN:i:" << unitig.sequence.size()
+            << "\tKC:i:" << unitig.kmerCoverage << "\tRC:i:" << unitig.readIds.Count()
+            << "\tkm:f:" << MeanCoverage(id) << '\n';
+    }
+
+    const int overlap = kmerSize_ - 1;
+    for (const auto& link : links_) {
+        out << "L\t" << link.from << '\t' << (link.fromReverse ? '-' : '+') << '\t' << link.to
+            << '\t' << (link.toReverse ? '-' : '+') << '\t' << overlap << "M\n";
+    }
+}
+
+void UnitigGraph::WriteGfa(const std::string& fn) const
+{
+    std::ofstream out{fn};
+    if (!out) {
+        throw std::runtime_error{"[pbmer] unitig graph ERROR: could not open file for writing: " +
+                                 fn};
+    }
+    WriteGfa(out);
+}
+
+}  // namespace Pbmer
+}  // namespace PacBio
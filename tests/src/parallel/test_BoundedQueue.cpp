@@ -0,0 +1,112 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/parallel/BoundedQueue.h>
+
+TEST(Parallel_BoundedQueue, capacity_is_rounded_up_to_power_of_two)
+{
+    EXPECT_EQ(2, PacBio::Parallel::BoundedQueue<int>{0}.Capacity());
+    EXPECT_EQ(8, PacBio::Parallel::BoundedQueue<int>{5}.Capacity());
+    EXPECT_EQ(16, PacBio::Parallel::BoundedQueue<int>{16}.Capacity());
+}
+
+TEST(Parallel_BoundedQueue, try_push_and_pop_are_fifo_and_bounded)
+{
+    PacBio::Parallel::BoundedQueue<int> queue{4};
+    for (int i = 0; i < 4; ++i)
+        EXPECT_TRUE(queue.TryPush(i));
+    EXPECT_FALSE(queue.TryPush(4));
+    EXPECT_EQ(4, queue.Size());
+
+    int item = -1;
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.TryPop(item));
+        EXPECT_EQ(i, item);
+    }
+    EXPECT_FALSE(queue.TryPop(item));
+    EXPECT_EQ(0, queue.Size());
+}
+
+TEST(Parallel_BoundedQueue, failed_push_leaves_item_untouched)
+{
+    PacBio::Parallel::BoundedQueue<std::unique_ptr<int>> queue{2};
+    EXPECT_TRUE(queue.TryPush(std::make_unique<int>(1)));
+    EXPECT_TRUE(queue.TryPush(std::make_unique<int>(2)));
+
+    auto item = std::make_unique<int>(3);
+    EXPECT_FALSE(queue.TryPush(std::move(item)));
+    ASSERT_TRUE(item);
+    EXPECT_EQ(3, *item);
+}
+
+TEST(Parallel_BoundedQueue, timed_operations_give_up)
+{
+    PacBio::Parallel::BoundedQueue<int> queue{2};
+    int item = 0;
+    EXPECT_FALSE(queue.TryPopFor(item, std::chrono::milliseconds(5)));
+
+    EXPECT_TRUE(queue.TryPushFor(1, std::chrono::milliseconds(5)));
+    EXPECT_TRUE(queue.TryPushFor(2, std::chrono::milliseconds(5)));
+    EXPECT_FALSE(queue.TryPushFor(3, std::chrono::milliseconds(5)));
+
+    EXPECT_TRUE(queue.TryPopFor(item, std::chrono::milliseconds(5)));
+    EXPECT_EQ(1, item);
+}
+
+TEST(Parallel_BoundedQueue, close_drains_remaining_items)
+{
+    PacBio::Parallel::BoundedQueue<int> queue{4};
+    EXPECT_TRUE(queue.Push(1));
+    queue.Close();
+    EXPECT_FALSE(queue.Push(2));
+
+    int item = 0;
+    EXPECT_TRUE(queue.Pop(item));
+    EXPECT_EQ(1, item);
+    EXPECT_FALSE(queue.Pop(item));
+}
+
+TEST(Parallel_BoundedQueue, many_producers_and_consumers)
+{
+    static const size_t numProducers = 3;
+    static const size_t numConsumers = 3;
+    static const size_t numItems = 20000;
+
+    PacBio::Parallel::BoundedQueue<size_t> queue{16};
+    std::atomic<size_t> sum{0};
+    std::atomic<size_t> count{0};
+
+    std::vector<std::thread> consumers;
+    for (size_t i = 0; i < numConsumers; ++i) {
+        consumers.emplace_back([&]() {
+            size_t item = 0;
+            while (queue.Pop(item)) {
+                sum += item;
+                ++count;
+            }
+        });
+    }
+
+    std::vector<std::thread> producers;
+    for (size_t p = 0; p < numProducers; ++p) {
+        producers.emplace_back([&queue, p]() {
+            for (size_t i = p; i < numItems; i += numProducers)
+                EXPECT_TRUE(queue.Push(i));
+        });
+    }
+
+    for (auto& producer : producers)
+        producer.join();
+    queue.Close();
+    for (auto& consumer : consumers)
+        consumer.join();
+
+    EXPECT_EQ(numItems, count);
+    EXPECT_EQ(numItems * (numItems - 1) / 2, sum);
+}
@@ -1,5 +1,6 @@
 // Author: Armin Töpfer
 
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <memory>
@@ -43,6 +44,22 @@ TEST(Parallel_FireAndForget, strings)
     EXPECT_EQ(vec.size(), numElements);
 }
 
+TEST(Parallel_FireAndForget, produces_with_member_function)
+{
+    struct Counter
+    {
+        std::atomic_int total{0};
+        void Add(const int i) { total += i; }
+    };
+
+    Counter counter;
+    PacBio::Parallel::FireAndForget faf{3};
+    for (int i = 1; i <= 100; ++i)
+        EXPECT_NO_THROW(faf.ProduceWith(&Counter::Add, &counter, i));
+    EXPECT_NO_THROW(faf.Finalize());
+    EXPECT_EQ(5050, counter.total);
+}
+
 TEST(Parallel_FireAndForget, exceptionFinalize)
 {
     static const size_t numThreads = 3;
@@ -92,3 +109,30 @@ TEST(Parallel_FireAndForget, exceptionProduceWith)
 
     EXPECT_EQ(counter, 2);
 }
+
+TEST(Parallel_FireAndForget, shared_pool_respects_concurrency_limit)
+{
+    static const size_t maxConcurrency = 2;
+    PacBio::Parallel::ThreadPool pool{4};
+    PacBio::Parallel::FireAndForget faf{pool, maxConcurrency};
+
+    std::atomic_int running{0};
+    std::atomic_int maxRunning{0};
+    std::atomic_int done{0};
+    auto Submit = [&](int) {
+        const int now = ++running;
+        int prev = maxRunning;
+        while (prev < now && !maxRunning.compare_exchange_weak(prev, now)) {
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        --running;
+        ++done;
+    };
+
+    for (int i = 0; i < 200; ++i)
+        EXPECT_NO_THROW(faf.ProduceWith(Submit, i));
+    EXPECT_NO_THROW(faf.Finalize());
+
+    EXPECT_EQ(200, done);
+    EXPECT_LE(maxRunning, static_cast<int>(maxConcurrency));
+}
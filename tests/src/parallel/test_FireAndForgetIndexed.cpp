@@ -127,3 +127,34 @@ TEST(Parallel_FireAndForgetIndexed, exceptionFinish)
 
     EXPECT_EQ(observed, 3);
 }
+
+TEST(Parallel_FireAndForgetIndexed, shared_pool_indices_are_below_concurrency_limit)
+{
+    static const size_t maxConcurrency = 2;
+    PacBio::Parallel::ThreadPool pool{4};
+
+    std::vector<size_t> perIndex(maxConcurrency, 0);
+    std::vector<size_t> finished(maxConcurrency, 0);
+    std::atomic_bool outOfRange{false};
+    {
+        PacBio::Parallel::FireAndForgetIndexed faf{pool, maxConcurrency, 1,
+                                                   [&](size_t index) { ++finished[index]; }};
+
+        // Tasks with the same index never run at the same time, so the
+        // unsynchronized increment is safe
+        auto Submit = [&](size_t index, size_t) {
+            if (index >= maxConcurrency) {
+                outOfRange = true;
+                return;
+            }
+            ++perIndex[index];
+        };
+        for (size_t i = 0; i < 1000; ++i)
+            EXPECT_NO_THROW(faf.ProduceWith(Submit, i));
+        EXPECT_NO_THROW(faf.Finalize());
+    }
+
+    EXPECT_FALSE(outOfRange);
+    EXPECT_EQ(1000, perIndex[0] + perIndex[1]);
+    EXPECT_EQ(std::vector<size_t>(maxConcurrency, 1), finished);
+}
@@ -0,0 +1,76 @@
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/parallel/For.h>
+
+TEST(Parallel_For, visits_every_index_once)
+{
+    PacBio::Parallel::ThreadPool pool{3};
+    std::vector<std::atomic<int>> visits(10007);
+    for (auto& v : visits)
+        v = 0;
+
+    PacBio::Parallel::For(pool, 0, visits.size(), 0, [&visits](size_t i) { ++visits[i]; });
+    for (const auto& v : visits)
+        EXPECT_EQ(1, v);
+
+    PacBio::Parallel::For(pool, 100, 200, 7, [&visits](size_t i) { ++visits[i]; });
+    EXPECT_EQ(1, visits[99]);
+    EXPECT_EQ(2, visits[100]);
+    EXPECT_EQ(2, visits[199]);
+    EXPECT_EQ(1, visits[200]);
+}
+
+TEST(Parallel_For, nested_loops_do_not_deadlock)
+{
+    // A single worker forces the callers to do the work themselves
+    for (const size_t numThreads : {1, 4}) {
+        PacBio::Parallel::ThreadPool pool{numThreads};
+        std::atomic<size_t> counter{0};
+        PacBio::Parallel::For(pool, 0, 16, 1, [&](size_t) {
+            PacBio::Parallel::For(pool, 0, 100, 3, [&counter](size_t) { ++counter; });
+        });
+        EXPECT_EQ(1600, counter);
+    }
+}
+
+TEST(Parallel_For, rethrows_first_exception)
+{
+    PacBio::Parallel::ThreadPool pool{2};
+    EXPECT_THROW(PacBio::Parallel::For(pool, 0, 1000, 1,
+                                       [](size_t i) {
+                                           if (i == 500) throw std::runtime_error{"for abort"};
+                                       }),
+                 std::runtime_error);
+
+    // The pool is still usable
+    std::atomic<size_t> counter{0};
+    PacBio::Parallel::For(pool, 0, 1000, 0, [&counter](size_t) { ++counter; });
+    EXPECT_EQ(1000, counter);
+}
+
+TEST(Parallel_Reduce, sums_range)
+{
+    PacBio::Parallel::ThreadPool pool{3};
+    const size_t sum =
+        PacBio::Parallel::Reduce(pool, 0, 100001, 0, size_t{0}, [](size_t i) { return i; },
+                                 [](size_t a, size_t b) { return a + b; });
+    EXPECT_EQ(size_t{100000} * 100001 / 2, sum);
+
+    EXPECT_EQ(42, PacBio::Parallel::Reduce(pool, 5, 5, 0, 42, [](size_t) { return 1; },
+                                           [](int a, int b) { return a + b; }));
+}
+
+TEST(Parallel_Reduce, keeps_index_order_for_non_commutative_combine)
+{
+    PacBio::Parallel::ThreadPool pool{4};
+    const std::string result = PacBio::Parallel::Reduce(
+        pool, 0, 26, 2, std::string{}, [](size_t i) { return std::string(1, 'a' + i); },
+        [](std::string a, const std::string& b) { return a + b; });
+    EXPECT_EQ("abcdefghijklmnopqrstuvwxyz", result);
+}
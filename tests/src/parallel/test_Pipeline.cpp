@@ -0,0 +1,148 @@
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/parallel/Pipeline.h>
+#include <pbcopper/parallel/ThreadPool.h>
+
+TEST(Parallel_Pipeline, results_are_emitted_in_input_order)
+{
+    static const size_t numElements = 2000;
+
+    auto pipeline = PacBio::Parallel::Pipeline<size_t>{8, 32}
+                        .Then(4,
+                              [](size_t i) {
+                                  // make a few items much slower than the others
+                                  if (i % 97 == 0)
+                                      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                                  return std::to_string(i);
+                              })
+                        .Then(2, [](std::string s) { return s + "-done"; });
+
+    std::vector<std::string> output;
+    auto consumer = std::async(std::launch::async, [&pipeline, &output]() {
+        while (
+            pipeline.ConsumeWith([&output](std::string s) { output.emplace_back(std::move(s)); }))
+            ;
+    });
+
+    std::vector<std::string> expected;
+    for (size_t i = 0; i < numElements; ++i) {
+        expected.emplace_back(std::to_string(i) + "-done");
+        pipeline.Produce(i);
+    }
+
+    EXPECT_NO_THROW(pipeline.FinalizeWorkers());
+    EXPECT_NO_THROW(consumer.wait());
+    EXPECT_NO_THROW(pipeline.Finalize());
+    EXPECT_EQ(expected, output);
+}
+
+TEST(Parallel_Pipeline, stages_share_a_small_pool)
+{
+    static const size_t numElements = 2000;
+
+    // fewer workers than stage threads, and small queues that fill up
+    for (const size_t numThreads : {1, 2}) {
+        PacBio::Parallel::ThreadPool pool{numThreads};
+        auto pipeline = PacBio::Parallel::Pipeline<size_t>{pool, 2, 8}
+                            .Then(4, [](size_t i) { return std::to_string(i); })
+                            .Then(3, [](std::string s) { return s + "-a"; }, 1)
+                            .Then(2, [](std::string s) { return s + "-b"; });
+
+        std::vector<std::string> output;
+        auto consumer = std::async(std::launch::async, [&pipeline, &output]() {
+            while (pipeline.ConsumeWith(
+                [&output](std::string s) { output.emplace_back(std::move(s)); }))
+                ;
+        });
+
+        std::vector<std::string> expected;
+        for (size_t i = 0; i < numElements; ++i) {
+            expected.emplace_back(std::to_string(i) + "-a-b");
+            pipeline.Produce(i);
+        }
+
+        EXPECT_NO_THROW(pipeline.FinalizeWorkers());
+        EXPECT_NO_THROW(consumer.wait());
+        EXPECT_NO_THROW(pipeline.Finalize());
+        EXPECT_EQ(expected, output);
+    }
+}
+
+TEST(Parallel_Pipeline, without_stages_passes_input_through)
+{
+    PacBio::Parallel::Pipeline<int> pipeline{4};
+    std::vector<int> output;
+    auto consumer = std::async(std::launch::async, [&pipeline, &output]() {
+        while (pipeline.ConsumeWith([&output](int i) { output.push_back(i); }))
+            ;
+    });
+
+    for (int i = 0; i < 100; ++i)
+        pipeline.Produce(i);
+    pipeline.FinalizeWorkers();
+    consumer.wait();
+    pipeline.Finalize();
+
+    ASSERT_EQ(100, output.size());
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(i, output[i]);
+}
+
+TEST(Parallel_Pipeline, exception_in_stage_aborts)
+{
+    auto pipeline = PacBio::Parallel::Pipeline<int>{2}.Then(3, [](int i) {
+        if (i == 5) throw std::runtime_error{"stage abort"};
+        return i;
+    });
+
+    auto consumer = std::async(std::launch::async, [&pipeline]() {
+        while (pipeline.ConsumeWith([](int) {}))
+            ;
+    });
+
+    bool thrown = false;
+    try {
+        for (int i = 0; i < 1000; ++i)
+            pipeline.Produce(i);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    EXPECT_TRUE(thrown);
+
+    pipeline.FinalizeWorkers();
+    EXPECT_NO_THROW(consumer.wait());
+
+    std::string exceptionMsg;
+    try {
+        pipeline.Finalize();
+    } catch (const std::runtime_error& e) {
+        exceptionMsg = e.what();
+    }
+    EXPECT_EQ("stage abort", exceptionMsg);
+}
+
+TEST(Parallel_Pipeline, exception_in_consumer_aborts)
+{
+    auto pipeline = PacBio::Parallel::Pipeline<int>{2}.Then(2, [](int i) { return i * 2; });
+
+    auto consumer = std::async(std::launch::async, [&pipeline]() {
+        while (pipeline.ConsumeWith([](int) { throw std::runtime_error{"consumer abort"}; }))
+            ;
+    });
+
+    EXPECT_ANY_THROW({
+        for (int i = 0; i < 1000; ++i)
+            pipeline.Produce(i);
+    });
+    pipeline.FinalizeWorkers();
+    consumer.wait();
+    EXPECT_ANY_THROW(pipeline.Finalize());
+}
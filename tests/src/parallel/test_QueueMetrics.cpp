@@ -0,0 +1,195 @@
+#include <pbcopper/parallel/QueueMetrics.h>
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/parallel/FireAndForget.h>
+#include <pbcopper/parallel/FireAndForgetIndexed.h>
+#include <pbcopper/parallel/WorkQueue.h>
+
+using namespace PacBio;
+
+TEST(Parallel_QueueMetrics, starts_empty)
+{
+    const Parallel::QueueMetrics metrics{2};
+    EXPECT_EQ(2, metrics.NumWorkers());
+    EXPECT_EQ(0, metrics.NumTasks());
+    EXPECT_EQ(0, metrics.BusyTime(1).count());
+    EXPECT_EQ(0, metrics.ProducerBlockedTime().count());
+    EXPECT_EQ(0, metrics.ConsumerBlockedTime().count());
+    EXPECT_EQ(0, metrics.LatencyPercentile(50).count());
+    EXPECT_EQ(std::vector<uint64_t>(Parallel::QueueMetrics::NumDepthBuckets, 0),
+              metrics.DepthHistogram());
+}
+
+TEST(Parallel_QueueMetrics, counts_tasks_and_busy_time_per_worker)
+{
+    Parallel::QueueMetrics metrics{2};
+    metrics.TaskFinished(0, std::chrono::microseconds{10}, std::chrono::microseconds{3});
+    metrics.TaskFinished(0, std::chrono::microseconds{10}, std::chrono::microseconds{4});
+    metrics.TaskFinished(1, std::chrono::microseconds{10}, std::chrono::microseconds{5});
+
+    EXPECT_EQ(3, metrics.NumTasks());
+    EXPECT_EQ(2, metrics.NumTasks(0));
+    EXPECT_EQ(1, metrics.NumTasks(1));
+    EXPECT_EQ(7000, metrics.BusyTime(0).count());
+    EXPECT_EQ(5000, metrics.BusyTime(1).count());
+    EXPECT_LE(metrics.IdleTime(0), metrics.Elapsed());
+}
+
+TEST(Parallel_QueueMetrics, latency_percentiles_are_within_bucket_precision)
+{
+    Parallel::QueueMetrics metrics{1};
+    for (int i = 1; i <= 100; ++i)
+        metrics.TaskFinished(0, std::chrono::microseconds{i}, std::chrono::nanoseconds{0});
+
+    const auto ExpectNear = [&metrics](const double percentile, const double expectedNs) {
+        const double actual = metrics.LatencyPercentile(percentile).count();
+        EXPECT_GE(actual, expectedNs);
+        EXPECT_LE(actual, expectedNs * 1.125);
+    };
+    ExpectNear(50, 50000);
+    ExpectNear(90, 90000);
+    ExpectNear(99, 99000);
+    ExpectNear(100, 100000);
+    ExpectNear(0, 1000);
+}
+
+TEST(Parallel_QueueMetrics, small_latencies_are_exact)
+{
+    Parallel::QueueMetrics metrics{1};
+    metrics.TaskFinished(0, std::chrono::nanoseconds{5}, std::chrono::nanoseconds{0});
+    EXPECT_EQ(5, metrics.LatencyPercentile(100).count());
+}
+
+TEST(Parallel_QueueMetrics, depth_histogram_uses_power_of_two_buckets)
+{
+    Parallel::QueueMetrics metrics{1};
+    for (const size_t depth : {0, 1, 2, 3, 4, 7, 8, 1000})
+        metrics.Queued(depth);
+
+    const auto histogram = metrics.DepthHistogram();
+    EXPECT_EQ(1, histogram[0]);
+    EXPECT_EQ(1, histogram[1]);
+    EXPECT_EQ(2, histogram[2]);
+    EXPECT_EQ(2, histogram[3]);
+    EXPECT_EQ(1, histogram[4]);
+    EXPECT_EQ(1, histogram[10]);
+}
+
+TEST(Parallel_QueueMetrics, can_export_report)
+{
+    Parallel::QueueMetrics metrics{3};
+    metrics.TaskFinished(2, std::chrono::milliseconds{2}, std::chrono::milliseconds{1});
+    metrics.Queued(5);
+    metrics.ProducerBlocked(std::chrono::milliseconds{250});
+
+    const auto report = metrics.ToReport("ccs_queue");
+    EXPECT_EQ("ccs_queue", report.Id());
+
+    const auto& attributes = report.Attributes();
+    ASSERT_EQ(9, attributes.size());
+    EXPECT_EQ("num_workers", attributes[0].Id());
+    EXPECT_EQ(3u, static_cast<unsigned int>(attributes[0]));
+    EXPECT_EQ(1u, static_cast<unsigned int>(attributes[1]));
+    EXPECT_EQ("producer_blocked", attributes[3].Id());
+    EXPECT_DOUBLE_EQ(0.25, static_cast<double>(attributes[3]));
+
+    const auto& tables = report.Tables();
+    ASSERT_EQ(2, tables.size());
+    EXPECT_EQ("workers", tables[0].Id());
+    ASSERT_EQ(4, tables[0].Columns().size());
+    EXPECT_EQ(3, tables[0].Columns()[1].Values().size());
+    EXPECT_EQ("queue_depth", tables[1].Id());
+    // buckets 0, 1, 2-3 and 4-7
+    EXPECT_EQ(4, tables[1].Columns()[0].Values().size());
+
+    std::ostringstream out;
+    EXPECT_NO_THROW(report.Print(out));
+}
+
+TEST(Parallel_QueueMetrics, queues_have_no_metrics_unless_enabled)
+{
+    Parallel::WorkQueue<int> wq{2};
+    Parallel::FireAndForget faf{2};
+    EXPECT_EQ(nullptr, wq.Metrics());
+    EXPECT_EQ(nullptr, faf.Metrics());
+    wq.Finalize();
+    faf.Finalize();
+}
+
+TEST(Parallel_QueueMetrics, work_queue_records_tasks)
+{
+    static const int numTasks = 200;
+    Parallel::WorkQueue<int> wq{3, 1};
+    const auto& metrics = wq.EnableMetrics();
+    EXPECT_EQ(3, metrics.NumWorkers());
+    EXPECT_EQ(&metrics, wq.Metrics());
+
+    int sum = 0;
+    std::thread consumer{[&]() {
+        while (wq.ConsumeWith([&sum](int x) { sum += x; })) {
+        }
+    }};
+    auto Task = [](int x) {
+        std::this_thread::sleep_for(std::chrono::microseconds{50});
+        return x;
+    };
+    for (int i = 0; i < numTasks; ++i)
+        wq.ProduceWith(Task, 1);
+    wq.FinalizeWorkers();
+    consumer.join();
+    wq.Finalize();
+
+    EXPECT_EQ(numTasks, sum);
+    EXPECT_EQ(numTasks, metrics.NumTasks());
+    EXPECT_GE(metrics.LatencyPercentile(50), std::chrono::microseconds{50});
+
+    uint64_t pushes = 0;
+    for (const auto n : metrics.DepthHistogram())
+        pushes += n;
+    EXPECT_EQ(numTasks, pushes);
+
+    std::chrono::nanoseconds busy{0};
+    for (size_t i = 0; i < metrics.NumWorkers(); ++i)
+        busy += metrics.BusyTime(i);
+    EXPECT_GE(busy, std::chrono::microseconds{50 * numTasks});
+}
+
+TEST(Parallel_QueueMetrics, fire_and_forget_records_blocked_producer)
+{
+    static const int numTasks = 20;
+    Parallel::FireAndForget faf{1, 1};
+    const auto& metrics = faf.EnableMetrics();
+
+    // With one task in flight, every ProduceWith waits for the previous task
+    auto Task = []() { std::this_thread::sleep_for(std::chrono::milliseconds{1}); };
+    for (int i = 0; i < numTasks; ++i)
+        faf.ProduceWith(Task);
+    faf.Finalize();
+
+    EXPECT_EQ(numTasks, metrics.NumTasks());
+    EXPECT_GE(metrics.ProducerBlockedTime(), std::chrono::milliseconds{numTasks / 2});
+}
+
+TEST(Parallel_QueueMetrics, fire_and_forget_indexed_records_per_index)
+{
+    static const size_t numThreads = 2;
+    Parallel::FireAndForgetIndexed faf{numThreads};
+    const auto& metrics = faf.EnableMetrics();
+
+    std::vector<uint64_t> perIndex(numThreads, 0);
+    auto Task = [&perIndex](size_t index) { ++perIndex[index]; };
+    for (int i = 0; i < 500; ++i)
+        faf.ProduceWith(Task);
+    faf.Finalize();
+
+    EXPECT_EQ(500, metrics.NumTasks());
+    for (size_t i = 0; i < numThreads; ++i)
+        EXPECT_EQ(perIndex[i], metrics.NumTasks(i));
+}
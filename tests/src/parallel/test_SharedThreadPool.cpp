@@ -0,0 +1,36 @@
+#include <atomic>
+#include <cstddef>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/parallel/FireAndForget.h>
+#include <pbcopper/parallel/SharedThreadPool.h>
+
+TEST(Parallel_SharedThreadPool, is_a_single_instance)
+{
+    auto& pool = PacBio::Parallel::SharedThreadPool();
+    EXPECT_EQ(&pool, &PacBio::Parallel::SharedThreadPool());
+    EXPECT_GE(pool.NumThreads(), 1);
+
+    // Once started, the size cannot be changed anymore
+    EXPECT_TRUE(PacBio::Parallel::SetSharedThreadPoolSize(pool.NumThreads()));
+    EXPECT_FALSE(PacBio::Parallel::SetSharedThreadPoolSize(pool.NumThreads() + 1));
+    EXPECT_EQ(&pool, &PacBio::Parallel::SharedThreadPool());
+}
+
+TEST(Parallel_SharedThreadPool, is_shared_by_several_queues)
+{
+    auto& pool = PacBio::Parallel::SharedThreadPool();
+    std::atomic<size_t> counter{0};
+    {
+        PacBio::Parallel::FireAndForget first{pool, 2};
+        PacBio::Parallel::FireAndForget second{pool, 2};
+        for (size_t i = 0; i < 1000; ++i) {
+            first.ProduceWith([&counter]() { ++counter; });
+            second.ProduceWith([&counter]() { ++counter; });
+        }
+        first.Finalize();
+        second.Finalize();
+    }
+    EXPECT_EQ(2000, counter);
+}
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/parallel/Sort.h>
+
+TEST(Parallel_Sort, sorts_like_std_sort)
+{
+    PacBio::Parallel::ThreadPool pool{3};
+    std::mt19937_64 rng{42};
+
+    for (const size_t size : {0, 1, 1000, 200000}) {
+        std::vector<uint64_t> values(size);
+        for (auto& v : values)
+            v = rng() % 100000;
+
+        auto expected = values;
+        std::sort(expected.begin(), expected.end());
+
+        PacBio::Parallel::Sort(pool, values.begin(), values.end());
+        EXPECT_EQ(expected, values);
+    }
+}
+
+TEST(Parallel_Sort, uses_custom_comparison)
+{
+    PacBio::Parallel::ThreadPool pool{4};
+    std::vector<int> values(100000);
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = static_cast<int>(i);
+
+    PacBio::Parallel::Sort(pool, values.begin(), values.end(), std::greater<int>{});
+    EXPECT_TRUE(std::is_sorted(values.begin(), values.end(), std::greater<int>{}));
+    EXPECT_EQ(99999, values.front());
+}
+
+TEST(Parallel_Sort, radix_sort_is_stable_by_key)
+{
+    PacBio::Parallel::ThreadPool pool{3};
+    std::mt19937_64 rng{7};
+
+    for (const size_t size : {0, 1, 1000, 300000}) {
+        // key in the first member, input position in the second
+        std::vector<std::pair<uint64_t, size_t>> values(size);
+        for (size_t i = 0; i < size; ++i)
+            values[i] = {rng() % 5000 + (uint64_t{rng() % 3} << 56), i};
+
+        auto expected = values;
+        std::stable_sort(expected.begin(), expected.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        PacBio::Parallel::RadixSort(pool, values.begin(), values.end(),
+                                    [](const std::pair<uint64_t, size_t>& v) { return v.first; });
+        EXPECT_EQ(expected, values);
+    }
+}
+
+TEST(Parallel_Sort, radix_sort_on_pool_without_workers)
+{
+    PacBio::Parallel::ThreadPool pool{0};
+    std::mt19937 rng{1};
+    std::vector<uint32_t> values(100000);
+    for (auto& v : values)
+        v = rng();
+
+    auto expected = values;
+    std::sort(expected.begin(), expected.end());
+
+    PacBio::Parallel::RadixSort(pool, values.begin(), values.end(),
+                                [](const uint32_t v) { return v; });
+    EXPECT_EQ(expected, values);
+}
@@ -0,0 +1,91 @@
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/parallel/Task.h>
+
+TEST(Parallel_Task, small_callables_are_stored_inline)
+{
+    using TTask = PacBio::Parallel::Task<int()>;
+
+    int i = 42;
+    auto small = [&i]() { return i; };
+    std::array<char, 256> buffer{};
+    auto large = [i, buffer]() { return i + buffer[0]; };
+    EXPECT_TRUE(TTask::IsStoredInline<decltype(small)>());
+    EXPECT_FALSE(TTask::IsStoredInline<decltype(large)>());
+
+    TTask task{small};
+    ASSERT_TRUE(static_cast<bool>(task));
+    EXPECT_EQ(42, task());
+}
+
+TEST(Parallel_Task, large_callables_are_stored_on_the_heap)
+{
+    std::array<int, 64> values;
+    values.fill(1);
+    PacBio::Parallel::Task<int()> task{[values]() {
+        int sum = 0;
+        for (const int v : values)
+            sum += v;
+        return sum;
+    }};
+
+    PacBio::Parallel::Task<int()> moved{std::move(task)};
+    EXPECT_FALSE(static_cast<bool>(task));
+    EXPECT_EQ(64, moved());
+}
+
+TEST(Parallel_Task, accepts_move_only_callables)
+{
+    auto ptr = std::make_unique<std::string>("move-only");
+    auto f = [p = std::move(ptr)]() { return *p; };
+    PacBio::Parallel::Task<std::string()> task{std::move(f)};
+
+    PacBio::Parallel::Task<std::string()> other;
+    EXPECT_FALSE(static_cast<bool>(other));
+    other = std::move(task);
+    EXPECT_EQ("move-only", other());
+
+    other = nullptr;
+    EXPECT_FALSE(static_cast<bool>(other));
+}
+
+TEST(Parallel_Task, bind_passes_leading_arguments_first)
+{
+    auto call = PacBio::Parallel::internal::Bind(
+        [](size_t index, const std::string& s, int i) { return s + std::to_string(index + i); },
+        std::string{"sum="}, 2);
+
+    PacBio::Parallel::Task<std::string(size_t)> task{std::move(call)};
+    EXPECT_EQ("sum=5", task(3));
+}
+
+TEST(Parallel_Task, bind_calls_like_std_bind)
+{
+    using namespace std::placeholders;
+
+    struct Counter
+    {
+        int total = 0;
+        void Add(int i) { total += i; }
+    };
+    Counter counter;
+    auto add = PacBio::Parallel::internal::Bind(&Counter::Add, &counter, 2);
+    add();
+    add();
+    EXPECT_EQ(4, counter.total);
+
+    std::string s{"ref"};
+    auto append = PacBio::Parallel::internal::Bind([](auto& str) { str += "-done"; }, std::ref(s));
+    append();
+    EXPECT_EQ("ref-done", s);
+
+    auto swapped = PacBio::Parallel::internal::Bind(
+        [](size_t index, int i, size_t again) { return index * 100 + i * 10 + again; }, 7, _1);
+    EXPECT_EQ(373, swapped(size_t{3}));
+}
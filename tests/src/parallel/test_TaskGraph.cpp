@@ -0,0 +1,178 @@
+#include <pbcopper/parallel/TaskGraph.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/parallel/For.h>
+#include <pbcopper/parallel/ThreadPool.h>
+
+using namespace PacBio;
+
+TEST(Parallel_TaskGraph, runs_independent_tasks)
+{
+    std::atomic<int> count{0};
+    Parallel::TaskGraph graph{4};
+    for (int i = 0; i < 1000; ++i)
+        graph.Add([&count]() { ++count; });
+    graph.Wait();
+    EXPECT_EQ(1000, count);
+}
+
+TEST(Parallel_TaskGraph, runs_tasks_after_their_dependencies)
+{
+    std::mutex m;
+    std::vector<int> order;
+    auto Record = [&m, &order](int x) {
+        return [&m, &order, x]() {
+            std::this_thread::sleep_for(std::chrono::microseconds{100 * (5 - x)});
+            std::lock_guard<std::mutex> g(m);
+            order.push_back(x);
+        };
+    };
+
+    // diamond: 0 -> {1, 2} -> 3, and 4 -> 3
+    Parallel::TaskGraph graph{3};
+    const auto a = graph.Add(Record(0));
+    const auto b = graph.Add(Record(1), {a});
+    const auto c = graph.Add(Record(2), {a});
+    const auto e = graph.Add(Record(4));
+    graph.Add(Record(3), {b, c, e});
+    graph.Wait();
+
+    ASSERT_EQ(5, order.size());
+    const auto Position = [&order](int x) {
+        return std::find(order.cbegin(), order.cend(), x) - order.cbegin();
+    };
+    EXPECT_LT(Position(0), Position(1));
+    EXPECT_LT(Position(0), Position(2));
+    EXPECT_EQ(4, Position(3));
+}
+
+TEST(Parallel_TaskGraph, depending_on_finished_task_starts_immediately)
+{
+    Parallel::TaskGraph graph{2};
+    int x = 0;
+    const auto first = graph.Add([&x]() { x = 1; });
+    graph.Wait();
+    graph.Add([&x]() { x *= 5; }, {first});
+    graph.Wait();
+    EXPECT_EQ(5, x);
+}
+
+TEST(Parallel_TaskGraph, depending_on_released_tasks_starts_immediately)
+{
+    Parallel::TaskGraph graph{2};
+    std::atomic<int> count{0};
+    std::vector<Parallel::TaskGraph::Id> ids;
+    for (int round = 0; round < 100; ++round) {
+        // finished tasks are released, their ids stay valid dependencies
+        ids.push_back(graph.Add([&count]() { ++count; }, ids));
+        graph.Wait();
+    }
+    EXPECT_EQ(100, count);
+    EXPECT_EQ(99, ids.back());
+    EXPECT_THROW(graph.Add([]() {}, {100}), std::invalid_argument);
+}
+
+TEST(Parallel_TaskGraph, chain_on_single_thread_runs_in_order)
+{
+    static const int numTasks = 200;
+    std::vector<int> order;
+    Parallel::ThreadPool pool{1};
+    Parallel::TaskGraph graph{pool};
+
+    Parallel::TaskGraph::Id previous = graph.Add([&order]() { order.push_back(0); });
+    for (int i = 1; i < numTasks; ++i)
+        previous = graph.Add([&order, i]() { order.push_back(i); }, {previous});
+    graph.Wait();
+
+    ASSERT_EQ(numTasks, order.size());
+    for (int i = 0; i < numTasks; ++i)
+        EXPECT_EQ(i, order[i]);
+}
+
+TEST(Parallel_TaskGraph, tasks_can_add_tasks)
+{
+    std::atomic<int> count{0};
+    Parallel::ThreadPool pool{2};
+    Parallel::TaskGraph graph{pool};
+
+    for (int i = 0; i < 10; ++i) {
+        const auto parent = graph.Add([&count]() { ++count; });
+        graph.Add(
+            [&graph, &count, parent]() {
+                for (int j = 0; j < 10; ++j)
+                    graph.Add([&count]() { ++count; }, {parent});
+            },
+            {parent});
+    }
+    graph.Wait();
+    EXPECT_EQ(110, count);
+}
+
+TEST(Parallel_TaskGraph, nested_graph_and_for_on_one_thread_do_not_deadlock)
+{
+    Parallel::ThreadPool pool{1};
+    Parallel::TaskGraph outer{pool};
+    std::atomic<int> count{0};
+
+    for (int i = 0; i < 4; ++i) {
+        outer.Add([&pool, &count]() {
+            Parallel::TaskGraph inner{pool};
+            const auto first = inner.Add([&count]() { ++count; });
+            inner.Add(
+                [&pool, &count]() {
+                    Parallel::For(pool, 0, 100, 10, [&count](size_t) { ++count; });
+                },
+                {first});
+            inner.Wait();
+        });
+    }
+    outer.Wait();
+    EXPECT_EQ(404, count);
+}
+
+TEST(Parallel_TaskGraph, exception_skips_pending_tasks_and_is_rethrown)
+{
+    std::atomic<int> count{0};
+    Parallel::TaskGraph graph{2};
+    const auto failing = graph.Add([]() { throw std::runtime_error{"abc"}; });
+    for (int i = 0; i < 10; ++i)
+        graph.Add([&count]() { ++count; }, {failing});
+
+    EXPECT_THROW(graph.Wait(), std::runtime_error);
+    EXPECT_EQ(0, count);
+    EXPECT_THROW(graph.Add([]() {}), std::runtime_error);
+}
+
+TEST(Parallel_TaskGraph, throws_on_unknown_dependency)
+{
+    Parallel::TaskGraph graph{1};
+    EXPECT_THROW(graph.Add([]() {}, {0}), std::invalid_argument);
+    const auto id = graph.Add([]() {});
+    EXPECT_NO_THROW(graph.Add([]() {}, {id}));
+    EXPECT_THROW(graph.Add([]() {}, {id + 5}), std::invalid_argument);
+    graph.Wait();
+}
+
+TEST(Parallel_TaskGraph, destructor_waits_for_tasks)
+{
+    std::atomic<int> count{0};
+    Parallel::ThreadPool pool{2};
+    {
+        Parallel::TaskGraph graph{pool};
+        const auto first = graph.Add([&count]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+            ++count;
+        });
+        graph.Add([&count]() { ++count; }, {first});
+    }
+    EXPECT_EQ(2, count);
+}
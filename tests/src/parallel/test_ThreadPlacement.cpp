@@ -0,0 +1,142 @@
+#include <pbcopper/parallel/ThreadPlacement.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/parallel/FireAndForgetIndexed.h>
+#include <pbcopper/parallel/ThreadPool.h>
+
+using namespace PacBio;
+
+namespace ThreadPlacementTests {
+
+// 2 NUMA nodes with 2 cores each, 2 hardware threads per core
+std::vector<Parallel::CpuInfo> TwoSocketTopology()
+{
+    std::vector<Parallel::CpuInfo> topology;
+    for (int id = 0; id < 8; ++id) {
+        Parallel::CpuInfo cpu;
+        cpu.id = id;
+        cpu.core = id % 4;
+        cpu.package = (id % 4) / 2;
+        cpu.node = cpu.package;
+        topology.push_back(cpu);
+    }
+    return topology;
+}
+
+}  // namespace ThreadPlacementTests
+
+TEST(Parallel_ThreadPlacement, can_parse_cpu_list)
+{
+    EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 8, 10, 11}),
+              Parallel::internal::ParseCpuList("0-3,8,10-11"));
+    EXPECT_EQ((std::vector<int>{5}), Parallel::internal::ParseCpuList("5\n"));
+    EXPECT_TRUE(Parallel::internal::ParseCpuList("").empty());
+    EXPECT_EQ((std::vector<int>{1}), Parallel::internal::ParseCpuList("x,1"));
+}
+
+TEST(Parallel_ThreadPlacement, none_does_not_pin)
+{
+    const auto cpus =
+        Parallel::ThreadPlacement::None().CpusFor(4, ThreadPlacementTests::TwoSocketTopology());
+    EXPECT_EQ(std::vector<int>(4, -1), cpus);
+    EXPECT_EQ(Parallel::ThreadPlacement::Policy::NONE, Parallel::ThreadPlacement{}.GetPolicy());
+}
+
+TEST(Parallel_ThreadPlacement, compact_fills_one_node_first)
+{
+    const auto cpus =
+        Parallel::ThreadPlacement::Compact().CpusFor(10, ThreadPlacementTests::TwoSocketTopology());
+    EXPECT_EQ((std::vector<int>{0, 4, 1, 5, 2, 6, 3, 7, 0, 4}), cpus);
+}
+
+TEST(Parallel_ThreadPlacement, scatter_alternates_nodes_and_prefers_distinct_cores)
+{
+    const auto cpus =
+        Parallel::ThreadPlacement::Scatter().CpusFor(8, ThreadPlacementTests::TwoSocketTopology());
+    EXPECT_EQ((std::vector<int>{0, 2, 1, 3, 4, 6, 5, 7}), cpus);
+}
+
+TEST(Parallel_ThreadPlacement, explicit_cpus_are_repeated)
+{
+    const auto cpus = Parallel::ThreadPlacement::Explicit({3, 1}).CpusFor(
+        5, ThreadPlacementTests::TwoSocketTopology());
+    EXPECT_EQ((std::vector<int>{3, 1, 3, 1, 3}), cpus);
+}
+
+TEST(Parallel_ThreadPlacement, only_allowed_cpus_are_used)
+{
+    // e.g. a cpuset of one core of each node
+    const auto topology =
+        Parallel::RestrictCpuTopology(ThreadPlacementTests::TwoSocketTopology(), {0, 2, 4, 6, 9});
+    ASSERT_EQ(4, topology.size());
+
+    EXPECT_EQ((std::vector<int>{0, 4, 2, 6, 0}),
+              Parallel::ThreadPlacement::Compact().CpusFor(5, topology));
+    EXPECT_EQ((std::vector<int>{0, 2, 4, 6, 0}),
+              Parallel::ThreadPlacement::Scatter().CpusFor(5, topology));
+
+    EXPECT_EQ(8,
+              Parallel::RestrictCpuTopology(ThreadPlacementTests::TwoSocketTopology(), {}).size());
+    EXPECT_EQ(std::vector<int>(3, -1), Parallel::ThreadPlacement::Compact().CpusFor(
+                                           3, Parallel::RestrictCpuTopology(
+                                                  ThreadPlacementTests::TwoSocketTopology(), {9})));
+}
+
+TEST(Parallel_ThreadPlacement, compact_and_scatter_pick_allowed_cpus_of_this_machine)
+{
+    const auto allowed = Parallel::AllowedCpus();
+    if (allowed.empty()) return;  // unknown on this platform
+
+    for (const auto& placement :
+         {Parallel::ThreadPlacement::Compact(), Parallel::ThreadPlacement::Scatter()}) {
+        for (const int cpu : placement.CpusFor(4))
+            EXPECT_NE(allowed.cend(), std::find(allowed.cbegin(), allowed.cend(), cpu));
+    }
+}
+
+TEST(Parallel_ThreadPlacement, topology_falls_back_without_sysfs)
+{
+    const auto topology = Parallel::ReadCpuTopology("/this/path/does/not/exist");
+    ASSERT_FALSE(topology.empty());
+    for (const auto& cpu : topology)
+        EXPECT_EQ(0, cpu.node);
+}
+
+TEST(Parallel_ThreadPlacement, topology_of_this_machine_is_not_empty)
+{
+    const auto topology = Parallel::ReadCpuTopology();
+    EXPECT_FALSE(topology.empty());
+}
+
+TEST(Parallel_ThreadPlacement, pool_calls_on_start_for_every_worker_before_returning)
+{
+    std::atomic<int> started{0};
+    Parallel::ThreadPool pool{3, Parallel::ThreadPlacement::Compact(),
+                              [&started](size_t) { ++started; }};
+    EXPECT_EQ(3, started);
+}
+
+TEST(Parallel_ThreadPlacement, indexed_tasks_stay_on_their_initialized_worker)
+{
+    static const size_t numThreads = 3;
+    std::vector<std::thread::id> owner(numThreads);
+    std::atomic_bool mismatch{false};
+
+    Parallel::FireAndForgetIndexed faf{
+        numThreads, Parallel::ThreadPlacement::Scatter(),
+        [&owner](size_t index) { owner[index] = std::this_thread::get_id(); }};
+    auto Submit = [&](size_t index) {
+        if (owner[index] != std::this_thread::get_id()) mismatch = true;
+    };
+    for (size_t i = 0; i < 1000; ++i)
+        faf.ProduceWith(Submit);
+    faf.Finalize();
+
+    EXPECT_FALSE(mismatch);
+}
@@ -0,0 +1,102 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/parallel/ThreadPool.h>
+
+TEST(Parallel_ThreadPool, runs_all_tasks)
+{
+    static const size_t numThreads = 4;
+    static const size_t numTasks = 10000;
+
+    std::atomic<size_t> counter{0};
+    {
+        PacBio::Parallel::ThreadPool pool{numThreads};
+        EXPECT_EQ(numThreads, pool.NumThreads());
+        for (size_t i = 0; i < numTasks; ++i)
+            pool.Submit([&counter]() { ++counter; });
+    }
+    EXPECT_EQ(numTasks, counter);
+}
+
+TEST(Parallel_ThreadPool, worker_index_is_stable_and_in_range)
+{
+    static const size_t numThreads = 3;
+    PacBio::Parallel::ThreadPool pool{numThreads};
+
+    // not a worker
+    EXPECT_EQ(numThreads, pool.CurrentWorkerIndex());
+
+    std::vector<std::atomic<size_t>> seen(numThreads + 1);
+    for (auto& s : seen)
+        s = 0;
+    std::atomic<size_t> done{0};
+    for (size_t i = 0; i < 1000; ++i) {
+        pool.Submit([&]() {
+            ++seen[pool.CurrentWorkerIndex()];
+            ++done;
+        });
+    }
+    while (done != 1000)
+        std::this_thread::yield();
+
+    EXPECT_EQ(0, seen[numThreads]);
+    size_t total = 0;
+    for (size_t i = 0; i < numThreads; ++i)
+        total += seen[i];
+    EXPECT_EQ(1000, total);
+}
+
+TEST(Parallel_ThreadPool, idle_workers_steal_from_busy_ones)
+{
+    static const size_t numThreads = 4;
+    PacBio::Parallel::ThreadPool pool{numThreads};
+
+    std::atomic<size_t> done{0};
+    std::vector<std::atomic_bool> used(numThreads);
+    for (auto& u : used)
+        u = false;
+
+    // one task spawns all children onto its own deque, others have to steal them
+    pool.Submit([&]() {
+        for (size_t i = 0; i < 64; ++i) {
+            pool.Submit([&]() {
+                used[pool.CurrentWorkerIndex()] = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                ++done;
+            });
+        }
+    });
+    while (done != 64)
+        std::this_thread::yield();
+
+    size_t nUsed = 0;
+    for (const auto& u : used)
+        nUsed += u;
+    EXPECT_GT(nUsed, 1);
+}
+
+TEST(Parallel_ThreadPool, try_run_one_helps_from_outside)
+{
+    PacBio::Parallel::ThreadPool pool{1};
+
+    std::atomic_bool release{false};
+    std::atomic<size_t> done{0};
+    // block the only worker
+    pool.Submit([&release]() {
+        while (!release)
+            std::this_thread::yield();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pool.Submit([&done]() { ++done; });
+
+    EXPECT_TRUE(pool.TryRunOne());
+    EXPECT_EQ(1, done);
+    EXPECT_FALSE(pool.TryRunOne());
+    release = true;
+}
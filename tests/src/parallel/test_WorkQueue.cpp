@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <future>
 #include <string>
 #include <thread>
 #include <vector>
@@ -162,3 +163,89 @@ TEST(Parallel_WorkQueue, exceptionConsumer)
     const std::string expectedError{"consumer abort"};
     EXPECT_EQ(expectedError, exceptionMsg);
 }
+
+TEST(Parallel_WorkQueue, batch_strings)
+{
+    static const size_t numThreads = 3;
+    static const size_t numElements = 10000;
+    static const size_t batchSize = 100;
+    PacBio::Parallel::WorkQueue<std::string> workQueue{numThreads};
+
+    std::vector<std::string> output;
+    output.reserve(numElements);
+    std::future<void> workerThread =
+        std::async(std::launch::async, WorkerThread, std::ref(workQueue), &output);
+
+    auto Submit = [](std::string& input) {
+        input += "-done";
+        return input;
+    };
+
+    std::vector<std::string> expected;
+    expected.reserve(numElements);
+    std::vector<std::string> batch;
+    for (size_t i = 0; i < numElements; ++i) {
+        std::string tmp = std::to_string(i);
+        expected.emplace_back(tmp + "-done");
+        batch.emplace_back(std::move(tmp));
+        if (batch.size() == batchSize) {
+            workQueue.ProduceBatchWith(Submit, std::move(batch));
+            batch.clear();
+        }
+    }
+
+    EXPECT_NO_THROW(workQueue.Finalize());
+    EXPECT_NO_THROW(workerThread.wait());
+
+    EXPECT_EQ(numElements, output.size());
+    EXPECT_EQ(expected, output);
+}
+
+TEST(Parallel_WorkQueue, batch_exceptionProduceWith)
+{
+    static const size_t numThreads = 3;
+    PacBio::Parallel::WorkQueue<std::string> workQueue{numThreads, 1};
+    std::vector<std::string> output;
+    std::future<void> workerThread =
+        std::async(std::launch::async, WorkerThreadException, std::ref(workQueue), &output);
+
+    // Only the last task of the batch throws, so that the batch is
+    // completely queued before the queue aborts
+    auto SubmitExc = [](std::string& input) {
+        if (input != "a") throw std::runtime_error{"faf abort"};
+        input += "-done";
+        return input;
+    };
+
+    EXPECT_NO_THROW(workQueue.ProduceBatchWith(SubmitExc, std::vector<std::string>{"a", "b"}));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_ANY_THROW(workQueue.ProduceBatchWith(SubmitExc, std::vector<std::string>{"c"}));
+
+    EXPECT_NO_THROW(workQueue.FinalizeWorkers());
+    EXPECT_NO_THROW(workerThread.wait());
+    EXPECT_ANY_THROW(workQueue.Finalize());
+}
+
+TEST(Parallel_WorkQueue, shared_pool_strings)
+{
+    static const size_t numElements = 10000;
+    PacBio::Parallel::ThreadPool pool{4};
+    PacBio::Parallel::WorkQueue<std::string> workQueue{pool, 2};
+
+    std::vector<std::string> output;
+    std::future<void> workerThread =
+        std::async(std::launch::async, WorkerThread, std::ref(workQueue), &output);
+
+    auto Submit = [](std::string& input) { return input + "-done"; };
+
+    std::vector<std::string> expected;
+    for (size_t i = 0; i < numElements; ++i) {
+        expected.emplace_back(std::to_string(i) + "-done");
+        workQueue.ProduceWith(Submit, std::to_string(i));
+    }
+
+    EXPECT_NO_THROW(workQueue.FinalizeWorkers());
+    EXPECT_NO_THROW(workerThread.wait());
+    EXPECT_NO_THROW(workQueue.Finalize());
+    EXPECT_EQ(expected, output);
+}
@@ -0,0 +1,88 @@
+#ifndef PBCOPPER_TEST_PBMERTESTUTILS_H
+#define PBCOPPER_TEST_PBMERTESTUTILS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <pbcopper/pbmer/Dbg.h>
+#include <pbcopper/pbmer/Parser.h>
+
+// Shared helpers of the pbmer tests
+namespace PbmerTestUtils {
+
+// random sequence of 'size' bases drawn from 'alphabet'
+inline std::string RandomDna(const size_t size, const unsigned int seed,
+                             const std::string& alphabet = "ACGT")
+{
+    std::mt19937 rng{seed};
+    std::string dna(size, 'A');
+    for (auto& c : dna)
+        c = alphabet[rng() % alphabet.size()];
+    return dna;
+}
+
+inline std::string ReverseComplement(std::string dna)
+{
+    std::reverse(dna.begin(), dna.end());
+    for (auto& c : dna)
+        c = (c == 'A') ? 'T' : (c == 'C') ? 'G' : (c == 'G') ? 'C' : 'A';
+    return dna;
+}
+
+// reads sampled from a random genome, each with one substitution drawn from
+// 'errorBases', alternating strands if 'bothStrands'
+inline std::vector<std::string> RandomReads(const size_t numReads, const unsigned int seed,
+                                            const size_t genomeSize = 2000,
+                                            const size_t readLength = 200,
+                                            const bool bothStrands = false,
+                                            const std::string& errorBases = "ACGT")
+{
+    std::mt19937 rng{seed};
+    std::string genome(genomeSize, 'A');
+    for (auto& c : genome)
+        c = "ACGT"[rng() % 4];
+
+    std::vector<std::string> reads;
+    for (size_t i = 0; i < numReads; ++i) {
+        std::string read = genome.substr(rng() % (genomeSize - readLength), readLength);
+        read[rng() % read.size()] = errorBases[rng() % errorBases.size()];
+        if (bothStrands && i % 2 == 1) read = ReverseComplement(read);
+        reads.push_back(read);
+    }
+    return reads;
+}
+
+// graph of RandomReads, with read ids from 1 and edges built
+inline PacBio::Pbmer::Dbg MakeGraph(const uint8_t kmerSize, const uint32_t numReads,
+                                    const unsigned int seed, const size_t genomeSize = 2000)
+{
+    const PacBio::Pbmer::Parser parser{kmerSize};
+    PacBio::Pbmer::Dbg dg{kmerSize, numReads};
+    const auto reads = RandomReads(numReads, seed, genomeSize);
+    for (uint32_t rid = 1; rid <= numReads; ++rid)
+        dg.AddKmers(parser.Parse(reads[rid - 1]), rid);
+    dg.BuildEdges();
+    return dg;
+}
+
+// dot output does not depend on the node order of the graph
+inline std::vector<std::string> SortedDotLines(PacBio::Pbmer::Dbg& dg)
+{
+    std::vector<std::string> lines;
+    std::istringstream in{dg.Graph2StringDot()};
+    std::string line;
+    while (std::getline(in, line))
+        lines.push_back(line);
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+}  // namespace PbmerTestUtils
+
+#endif  // PBCOPPER_TEST_PBMERTESTUTILS_H
@@ -1,7 +1,24 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include <gtest/gtest.h>
 
+#include <pbcopper/parallel/ThreadPool.h>
 #include <pbcopper/pbmer/Dbg.h>
 
+#include "PbmerTestUtils.h"
+
+namespace DbgTests {
+
+// reads sampled from both strands of a random genome, with a few errors
+std::vector<std::string> RandomReads(const size_t numReads)
+{
+    return PbmerTestUtils::RandomReads(numReads, 44, 3000, 250, true);
+}
+
+}  // namespace DbgTests
+
 TEST(Pbmer_Dbg, add_kmers_throws_if_kmer_too_big)
 {
     const PacBio::Pbmer::Parser parser{32};
@@ -690,3 +707,276 @@ TEST(Pbmer_Dbg, GetBubbles_complex_snv)
 
     EXPECT_EQ(bubbles.size(), 2);
 }
+
+TEST(Pbmer_Dbg, parallel_add_kmers_matches_serial)
+{
+    const auto reads = DbgTests::RandomReads(60);
+    const PacBio::Pbmer::Parser parser{21};
+    std::vector<PacBio::Pbmer::Mers> mers;
+    for (const auto& read : reads)
+        mers.push_back(parser.Parse(read));
+
+    PacBio::Pbmer::Dbg serial{21, 60};
+    for (size_t i = 0; i < mers.size(); ++i)
+        serial.AddKmers(mers[i], i + 1);
+    serial.BuildEdges();
+
+    for (const size_t numThreads : {1, 3, 8}) {
+        PacBio::Parallel::ThreadPool pool{numThreads};
+        PacBio::Pbmer::Dbg parallel{21, 60};
+        EXPECT_EQ(1, parallel.AddKmers(mers, pool));
+        parallel.BuildEdges();
+
+        EXPECT_EQ(serial.NNodes(), parallel.NNodes());
+        EXPECT_EQ(serial.NEdges(), parallel.NEdges());
+        EXPECT_TRUE(parallel.ValidateLoad());
+        EXPECT_EQ(PbmerTestUtils::SortedDotLines(serial), PbmerTestUtils::SortedDotLines(parallel));
+
+        // same read ids per node
+        PacBio::Pbmer::Dbg filtered = serial;
+        filtered.FrequencyFilterNodes(4);
+        parallel.FrequencyFilterNodes(4);
+        EXPECT_EQ(filtered.NNodes(), parallel.NNodes());
+    }
+}
+
+TEST(Pbmer_Dbg, parallel_add_kmers_merges_into_existing_graph)
+{
+    const auto reads = DbgTests::RandomReads(40);
+    const PacBio::Pbmer::Parser parser{15};
+    std::vector<PacBio::Pbmer::Mers> mers;
+    for (const auto& read : reads)
+        mers.push_back(parser.Parse(read));
+
+    PacBio::Pbmer::Dbg serial{15, 40};
+    for (size_t i = 0; i < mers.size(); ++i)
+        serial.AddKmers(mers[i], i + 1);
+    serial.FrequencyFilterNodes(2);
+
+    PacBio::Parallel::ThreadPool pool{4};
+    PacBio::Pbmer::Dbg parallel{15, 40};
+    for (size_t i = 0; i < 10; ++i)
+        parallel.AddKmers(mers[i], i + 1);
+    const std::vector<PacBio::Pbmer::Mers> rest{mers.begin() + 10, mers.end()};
+    EXPECT_EQ(1, parallel.AddKmers(rest, pool, 11));
+    parallel.FrequencyFilterNodes(2);
+
+    EXPECT_EQ(serial.NNodes(), parallel.NNodes());
+    EXPECT_EQ(PbmerTestUtils::SortedDotLines(serial), PbmerTestUtils::SortedDotLines(parallel));
+}
+
+TEST(Pbmer_Dbg, parallel_add_verified_kmer_pairs_matches_serial)
+{
+    const auto reads = DbgTests::RandomReads(30);
+    const PacBio::Pbmer::Parser parser{17};
+
+    PacBio::Pbmer::Dbg serial{17, 30};
+    std::vector<std::vector<PacBio::Pbmer::DnaBit>> bits;
+    for (size_t i = 0; i < reads.size(); ++i) {
+        bits.push_back(parser.ParseDnaBit(reads[i]));
+        auto copy = bits.back();
+        serial.AddVerifedKmerPairs(copy, i + 1);
+    }
+
+    PacBio::Parallel::ThreadPool pool{4};
+    PacBio::Pbmer::Dbg parallel{17, 30};
+    EXPECT_EQ(1, parallel.AddVerifedKmerPairs(bits, pool));
+
+    EXPECT_EQ(serial.NNodes(), parallel.NNodes());
+    EXPECT_EQ(serial.NEdges(), parallel.NEdges());
+    EXPECT_EQ(PbmerTestUtils::SortedDotLines(serial), PbmerTestUtils::SortedDotLines(parallel));
+}
+
+TEST(Pbmer_Dbg, parallel_add_kmers_checks_input)
+{
+    PacBio::Parallel::ThreadPool pool{2};
+    const std::string dna{"ACGACCCTGAGCCCCCAGAGTCATCTAAAAAAATTCTCTCCTCT"};
+
+    PacBio::Pbmer::Dbg even{16, 2};
+    const std::vector<PacBio::Pbmer::Mers> evenMers{PacBio::Pbmer::Parser{16}.Parse(dna)};
+    EXPECT_EQ(-2, even.AddKmers(evenMers, pool));
+
+    PacBio::Pbmer::Dbg dg{15, 2};
+    const std::vector<PacBio::Pbmer::Mers> mers(3, PacBio::Pbmer::Parser{15}.Parse(dna));
+    EXPECT_EQ(-3, dg.AddKmers(mers, pool));
+    EXPECT_EQ(-3, dg.AddKmers({mers.front()}, pool, 0));
+    EXPECT_EQ(0, dg.NNodes());
+    EXPECT_EQ(1, dg.AddKmers({mers.front(), mers.back()}, pool));
+    EXPECT_TRUE(dg.ValidateLoad());
+}
+
+TEST(Pbmer_Dbg, parallel_add_packed_kmers_matches_serial)
+{
+    const auto reads = DbgTests::RandomReads(50);
+    const PacBio::Pbmer::Parser parser{21};
+    std::vector<PacBio::Pbmer::BI> kmers;
+    for (size_t i = 0; i < reads.size(); ++i) {
+        for (const auto& niby : parser.ParseDnaBit(reads[i])) {
+            kmers.push_back(niby.LexSmallerEq().DnaBit2Bin() | (i + 1));
+        }
+    }
+
+    for (const uint32_t minFreqCutoff : {0, 3}) {
+        auto serialKmers = kmers;
+        PacBio::Pbmer::Dbg serial{21, 50};
+        serial.AddKmers(serialKmers, minFreqCutoff);
+        serial.BuildEdges();
+
+        auto parallelKmers = kmers;
+        PacBio::Parallel::ThreadPool pool{3};
+        PacBio::Pbmer::Dbg parallel{21, 50};
+        parallel.AddKmers(parallelKmers, minFreqCutoff, pool);
+        parallel.BuildEdges();
+
+        EXPECT_GT(parallel.NNodes(), 0);
+        EXPECT_EQ(serial.NNodes(), parallel.NNodes());
+        EXPECT_EQ(serial.NEdges(), parallel.NEdges());
+        EXPECT_TRUE(parallel.ValidateLoad());
+
+        // node strands follow the first kmer of a run, which the serial sort
+        // does not keep stable, so only compare the edges
+        auto edges = [](PacBio::Pbmer::Dbg& dg) {
+            auto lines = PbmerTestUtils::SortedDotLines(dg);
+            lines.erase(std::remove_if(lines.begin(), lines.end(),
+                                       [](const std::string& line) {
+                                           return line.find("->") == std::string::npos;
+                                       }),
+                        lines.end());
+            return lines;
+        };
+        EXPECT_EQ(edges(serial), edges(parallel));
+
+        serial.FrequencyFilterNodes(5);
+        parallel.FrequencyFilterNodes(5);
+        EXPECT_EQ(serial.NNodes(), parallel.NNodes());
+    }
+}
+
+TEST(Pbmer_Dbg, parallel_add_packed_kmers_keeps_first_strand)
+{
+    const PacBio::Pbmer::Parser parser{3};
+    std::vector<PacBio::Pbmer::DnaBit> m1 = parser.ParseDnaBit("CATAG");
+    std::vector<PacBio::Pbmer::BI> kmers;
+    for (auto& niby : m1) {
+        kmers.push_back(niby.LexSmallerEq().DnaBit2Bin() | 1);
+    }
+
+    PacBio::Parallel::ThreadPool pool{2};
+    PacBio::Pbmer::Dbg dg{3, 1};
+    dg.AddKmers(kmers, 0, pool);
+    dg.BuildEdges();
+
+    // same graph as test_topo_three_kmers_add_many
+    const std::vector<std::string> expected{
+        "    ATA -> ATG;",
+        "    ATA -> CTA;",
+        "    ATA [fillcolor=grey, style=\"rounded,filled\", shape=ellipse]",
+        "    ATG -> ATA;",
+        "    ATG [fillcolor=red, style=\"rounded,filled\", shape=diamond]",
+        "    CTA -> ATA;",
+        "    CTA [fillcolor=red, style=\"rounded,filled\", shape=diamond]",
+        "digraph DBGraph {",
+        "}"};
+    EXPECT_EQ(expected, PbmerTestUtils::SortedDotLines(dg));
+}
+
+TEST(Pbmer_Dbg, sketch_filtered_add_kmers_keeps_solid_kmers)
+{
+    const auto reads = DbgTests::RandomReads(60);
+    const PacBio::Pbmer::Parser parser{21};
+    std::vector<PacBio::Pbmer::Mers> mers;
+    PacBio::Pbmer::KmerSketch sketch{1 << 16};
+    for (const auto& read : reads) {
+        mers.push_back(parser.Parse(read));
+        sketch.AddKmers(mers.back());
+    }
+
+    const uint8_t minFreq = 3;
+    PacBio::Pbmer::Dbg expected{21, 60};
+    PacBio::Pbmer::Dbg serial{21, 60};
+    for (size_t i = 0; i < mers.size(); ++i) {
+        expected.AddKmers(mers[i], i + 1);
+        EXPECT_EQ(1, serial.AddKmers(mers[i], i + 1, sketch, minFreq));
+    }
+    PacBio::Parallel::ThreadPool pool{3};
+    PacBio::Pbmer::Dbg parallel{21, 60};
+    EXPECT_EQ(1, parallel.AddKmers(mers, pool, sketch, minFreq));
+
+    // the singletons from read errors are never loaded
+    EXPECT_LT(serial.NNodes(), expected.NNodes());
+    EXPECT_EQ(serial.NNodes(), parallel.NNodes());
+
+    // and no solid kmer is lost
+    for (auto* dg : {&expected, &serial, &parallel}) {
+        dg->FrequencyFilterNodes(minFreq);
+        dg->BuildEdges();
+    }
+    EXPECT_EQ(PbmerTestUtils::SortedDotLines(expected), PbmerTestUtils::SortedDotLines(serial));
+    EXPECT_EQ(PbmerTestUtils::SortedDotLines(expected), PbmerTestUtils::SortedDotLines(parallel));
+    EXPECT_EQ(expected.GetBubbles(), serial.GetBubbles());
+}
+
+TEST(Pbmer_Dbg, parallel_build_edges_matches_serial)
+{
+    const auto reads = DbgTests::RandomReads(30);
+    const PacBio::Pbmer::Parser parser{17};
+    PacBio::Pbmer::Dbg serial{17, 30};
+    for (size_t i = 0; i < reads.size(); ++i)
+        serial.AddKmers(parser.Parse(reads[i]), i + 1);
+    PacBio::Pbmer::Dbg unbuilt = serial;
+    serial.BuildEdges();
+
+    for (const size_t numThreads : {1, 3, 8}) {
+        PacBio::Parallel::ThreadPool pool{numThreads};
+        PacBio::Pbmer::Dbg parallel = unbuilt;
+        parallel.BuildEdges(pool);
+        EXPECT_EQ(serial.NEdges(), parallel.NEdges());
+        EXPECT_EQ(PbmerTestUtils::SortedDotLines(serial), PbmerTestUtils::SortedDotLines(parallel));
+    }
+}
+
+TEST(Pbmer_Dbg, frequency_filter_keeping_edges_matches_rebuild)
+{
+    const auto reads = DbgTests::RandomReads(40);
+    const PacBio::Pbmer::Parser parser{15};
+    PacBio::Pbmer::Dbg rebuilt{15, 40};
+    for (size_t i = 0; i < reads.size(); ++i)
+        rebuilt.AddKmers(parser.Parse(reads[i]), i + 1);
+    rebuilt.BuildEdges();
+    PacBio::Pbmer::Dbg incremental = rebuilt;
+
+    rebuilt.FrequencyFilterNodes(3);
+    rebuilt.BuildEdges();
+    incremental.FrequencyFilterNodes2(3);
+
+    EXPECT_TRUE(incremental.ValidateEdges());
+    EXPECT_EQ(rebuilt.NNodes(), incremental.NNodes());
+    EXPECT_EQ(rebuilt.NEdges(), incremental.NEdges());
+    EXPECT_EQ(PbmerTestUtils::SortedDotLines(rebuilt), PbmerTestUtils::SortedDotLines(incremental));
+}
+
+TEST(Pbmer_Dbg, trim_spurs_matches_repeated_remove_spurs)
+{
+    const auto reads = DbgTests::RandomReads(40);
+    for (const uint8_t kmerSize : {11, 15, 21}) {
+        const PacBio::Pbmer::Parser parser{kmerSize};
+        PacBio::Pbmer::Dbg repeated{kmerSize, 40};
+        for (size_t i = 0; i < reads.size(); ++i)
+            repeated.AddKmers(parser.Parse(reads[i]), i + 1);
+        repeated.FrequencyFilterNodes(2);
+        repeated.BuildEdges();
+        PacBio::Pbmer::Dbg trimmed = repeated;
+
+        int rounds = 0;
+        while (repeated.RemoveSpurs(10) > 0)
+            ++rounds;
+        EXPECT_GT(rounds, 0);
+
+        EXPECT_GT(trimmed.TrimSpurs(10), 0);
+        EXPECT_TRUE(trimmed.ValidateEdges());
+        EXPECT_EQ(repeated.NNodes(), trimmed.NNodes());
+        EXPECT_EQ(PbmerTestUtils::SortedDotLines(repeated),
+                  PbmerTestUtils::SortedDotLines(trimmed));
+        EXPECT_EQ(0, trimmed.TrimSpurs(10));
+    }
+}
@@ -0,0 +1,135 @@
+#include <pbcopper/pbmer/FixedDnaBit.h>
+
+#include <cstdint>
+
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "PbmerTestUtils.h"
+
+using namespace PacBio;
+
+namespace FixedDnaBitTests {
+
+template <int K>
+void CheckMatchesDnaBit()
+{
+    std::mt19937_64 rng{K};
+    const uint64_t mask = (uint64_t{1} << (2 * K)) - 1;
+    for (int i = 0; i < 200; ++i) {
+        const Pbmer::DnaBit bit{rng() & mask, static_cast<uint8_t>(i % 2), K};
+        const Pbmer::FixedDnaBit<K> fixed{bit};
+        EXPECT_EQ(bit, fixed.ToDnaBit());
+        EXPECT_EQ(Pbmer::Mix64Masked(bit.mer, K), fixed.HashValue());
+        EXPECT_EQ(bit.KmerToStr(), fixed.KmerToStr());
+        EXPECT_EQ(bit.GetFirstBaseIdx(), fixed.GetFirstBaseIdx());
+        EXPECT_EQ(bit.GetLastBaseIdx(), fixed.GetLastBaseIdx());
+
+        auto expected = bit;
+        auto actual = fixed;
+        expected.ReverseComp();
+        actual.ReverseComp();
+        EXPECT_EQ(expected, actual.ToDnaBit());
+
+        expected = bit;
+        actual = fixed;
+        expected.MakeLexSmaller();
+        actual.MakeLexSmaller();
+        EXPECT_EQ(expected, actual.ToDnaBit());
+
+        expected = bit;
+        actual = fixed;
+        expected.MakeLexSmallerHashed();
+        actual.MakeLexSmallerHashed();
+        EXPECT_EQ(expected, actual.ToDnaBit());
+
+        expected = bit;
+        actual = fixed;
+        expected.AppendBase('G');
+        actual.AppendBase('G');
+        EXPECT_EQ(expected, actual.ToDnaBit());
+        expected.PrependBase(uint8_t{1});
+        actual.PrependBase(uint8_t{1});
+        EXPECT_EQ(expected, actual.ToDnaBit());
+
+        const Pbmer::DnaBit other{rng() & mask, 0, K};
+        EXPECT_EQ(bit < other, fixed < Pbmer::FixedDnaBit<K>{other});
+    }
+}
+
+template <int K>
+Pbmer::FixedDnaBit<K> FromString(const std::string& dna)
+{
+    Pbmer::FixedDnaBit<K> bit;
+    for (const char c : dna)
+        bit.AppendBase(c);
+    return bit;
+}
+
+}  // namespace FixedDnaBitTests
+
+TEST(Pbmer_FixedDnaBit, storage_fits_kmer_size)
+{
+    EXPECT_EQ(8, sizeof(Pbmer::FixedDnaBit<15>));
+    EXPECT_EQ(2 * sizeof(Pbmer::FixedDnaBit<16>), sizeof(Pbmer::DnaBit));
+    EXPECT_EQ(sizeof(Pbmer::DnaBit), sizeof(Pbmer::FixedDnaBit<31>));
+    EXPECT_EQ(32, sizeof(Pbmer::FixedDnaBit<63>));
+
+    EXPECT_EQ(0xFFFFFFFFu, Pbmer::FixedDnaBit<16>::Mask());
+    EXPECT_EQ(uint64_t{0x3FFFFFFFFFF}, Pbmer::FixedDnaBit<21>::Mask());
+}
+
+TEST(Pbmer_FixedDnaBit, matches_dna_bit)
+{
+    FixedDnaBitTests::CheckMatchesDnaBit<1>();
+    FixedDnaBitTests::CheckMatchesDnaBit<5>();
+    FixedDnaBitTests::CheckMatchesDnaBit<15>();
+    FixedDnaBitTests::CheckMatchesDnaBit<16>();
+    FixedDnaBitTests::CheckMatchesDnaBit<21>();
+    FixedDnaBitTests::CheckMatchesDnaBit<31>();
+}
+
+TEST(Pbmer_FixedDnaBit, handles_long_kmers)
+{
+    for (const unsigned int seed : {1, 2, 3}) {
+        const std::string dna = PbmerTestUtils::RandomDna(63, seed);
+        auto bit = FixedDnaBitTests::FromString<63>(dna);
+        EXPECT_EQ(dna, bit.KmerToStr());
+        EXPECT_EQ(dna[0], "ACGT"[bit.GetFirstBaseIdx()]);
+
+        const auto rc = FixedDnaBitTests::FromString<63>(PbmerTestUtils::ReverseComplement(dna));
+        bit.ReverseComp();
+        EXPECT_EQ(rc.mer, bit.mer);
+        EXPECT_EQ(1, bit.strand);
+
+        const std::string shorter = dna.substr(0, 40);
+        auto bit40 = FixedDnaBitTests::FromString<40>(shorter);
+        EXPECT_EQ(shorter, bit40.KmerToStr());
+        bit40.AppendBase('T');
+        EXPECT_EQ(shorter.substr(1) + "T", bit40.KmerToStr());
+        bit40.PrependBase('C');
+        EXPECT_EQ("C" + shorter.substr(1, 39), bit40.KmerToStr());
+
+        // the hash is a bijection of the kmer halves
+        const auto other = FixedDnaBitTests::FromString<40>(dna.substr(1, 40));
+        EXPECT_NE(bit40.HashValue(), other.HashValue());
+        EXPECT_EQ(static_cast<uint64_t>(bit40.HashValue() >> 64),
+                  Pbmer::Mix64Masked(static_cast<uint64_t>(bit40.mer >> 64), 8));
+    }
+}
+
+TEST(Pbmer_FixedDnaBit, dispatches_runtime_kmer_sizes)
+{
+    for (uint8_t k = 11; k <= 31; k += 2) {
+        ASSERT_TRUE(Pbmer::IsDispatchedKmerSize(k));
+        EXPECT_EQ(k, Pbmer::DispatchKmerSize(k, [](auto fixedK) {
+                      return Pbmer::FixedDnaBit<decltype(fixedK)::value>::KmerSize();
+                  }));
+    }
+    EXPECT_FALSE(Pbmer::IsDispatchedKmerSize(12));
+    EXPECT_THROW(Pbmer::DispatchKmerSize(12, [](auto) { return 0; }), std::invalid_argument);
+    EXPECT_THROW(Pbmer::FixedDnaBit<15>(Pbmer::DnaBit{0, 0, 17}), std::invalid_argument);
+}
@@ -0,0 +1,64 @@
+#include <pbcopper/pbmer/FixedParser.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/pbmer/Parser.h>
+
+#include "PbmerTestUtils.h"
+
+using namespace PacBio;
+
+namespace FixedParserTests {
+
+template <int K>
+void CheckMatchesParser(const std::string& dna)
+{
+    const auto expected = Pbmer::Parser{K}.ParseDnaBit(dna);
+    const auto actual = Pbmer::FixedParser<K>{}.ParseDnaBit(dna);
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+        EXPECT_EQ(expected[i], actual[i].ToDnaBit());
+}
+
+}  // namespace FixedParserTests
+
+TEST(Pbmer_FixedParser, matches_parser)
+{
+    // mostly ACGT, with a few unknown bases
+    std::string dna = PbmerTestUtils::RandomDna(500, 7, "ACGTN");
+    for (size_t i = 0; i < dna.size(); ++i)
+        if (dna[i] == 'N' && i % 10 != 0) dna[i] = 'C';
+
+    FixedParserTests::CheckMatchesParser<3>(dna);
+    FixedParserTests::CheckMatchesParser<15>(dna);
+    FixedParserTests::CheckMatchesParser<16>(dna);
+    FixedParserTests::CheckMatchesParser<21>(dna);
+    FixedParserTests::CheckMatchesParser<32>(dna);
+}
+
+TEST(Pbmer_FixedParser, parses_long_kmers_on_both_strands)
+{
+    const std::string dna =
+        "ACGTTGCAAGGCTTAACCGGTTAAGCTAGCATCGATCGGATCCTAGGACTAGTCATGCATGCNACGT"
+        "ACGTTGCAAGGCTTAACCGGTTAAGCTAGCATCGATCGGATCCTAGGACTAGTCATGCATGC";
+    std::vector<std::string> expected;
+    for (size_t i = 0; i + 45 <= dna.size(); ++i) {
+        const std::string kmer = dna.substr(i, 45);
+        if (kmer.find('N') == std::string::npos) expected.push_back(kmer);
+    }
+
+    std::vector<std::string> actual;
+    Pbmer::FixedParser<45>{}.ForEachKmer(dna, [&](auto forward, auto reverse) {
+        actual.push_back(forward.KmerToStr());
+        reverse.ReverseComp();
+        EXPECT_EQ(forward, reverse);
+    });
+    EXPECT_EQ(expected, actual);
+    EXPECT_EQ(expected.size(), Pbmer::FixedParser<45>{}.ParseDnaBit(dna).size());
+
+    EXPECT_THROW(Pbmer::FixedParser<45>{}.ParseDnaBit("ACGT"), std::runtime_error);
+}
@@ -0,0 +1,139 @@
+#include <pbcopper/pbmer/FrozenDbg.h>
+
+#include <cstdint>
+
+#include <algorithm>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/parallel/ThreadPool.h>
+#include <pbcopper/pbmer/Dbg.h>
+
+#include "PbmerTestUtils.h"
+
+using namespace PacBio;
+
+namespace FrozenDbgTests {
+
+// reads from a random genome with a few errors, giving bubbles and spurs
+Pbmer::Dbg MakeGraph(const uint8_t kmerSize)
+{
+    return PbmerTestUtils::MakeGraph(kmerSize, 20, 17, 1500);
+}
+
+}  // namespace FrozenDbgTests
+
+TEST(Pbmer_FrozenDbg, has_same_nodes_and_edges)
+{
+    const auto dg = FrozenDbgTests::MakeGraph(15);
+    const auto frozen = dg.Freeze();
+
+    EXPECT_EQ(15, frozen.KmerSize());
+    EXPECT_EQ(dg.NNodes(), frozen.NNodes());
+    EXPECT_EQ(dg.NEdges(), frozen.NEdges());
+
+    for (uint32_t id = 0; id < frozen.NNodes(); ++id) {
+        EXPECT_EQ(id, frozen.Id(frozen.Kmer(id)));
+        EXPECT_EQ(frozen.Kmer(id), frozen.Dna(id).LexSmallerEq64());
+        EXPECT_EQ(frozen.ReadIds(id).Count(), frozen.ReadCount(id));
+        EXPECT_GT(frozen.ReadCount(id), 0);
+
+        // edges go both ways
+        for (const uint32_t neighbor : frozen.Neighbors(id)) {
+            bool back = false;
+            for (const uint32_t n : frozen.Neighbors(neighbor))
+                back |= (n == id);
+            EXPECT_TRUE(back);
+        }
+    }
+    EXPECT_EQ(Pbmer::FrozenDbg::NoNode, frozen.Id(~uint64_t{0}));
+}
+
+TEST(Pbmer_FrozenDbg, linear_paths_match_dbg)
+{
+    const auto dg = FrozenDbgTests::MakeGraph(17);
+    const auto frozen = dg.Freeze();
+
+    for (uint32_t id = 0; id < frozen.NNodes(); ++id) {
+        const auto expected = dg.GetLinearPath(frozen.Kmer(id));
+        const auto path = frozen.GetLinearPath(id);
+        ASSERT_EQ(expected.size(), path.size());
+        for (size_t i = 0; i < path.size(); ++i)
+            EXPECT_EQ(expected[i], frozen.Dna(path[i]));
+    }
+}
+
+TEST(Pbmer_FrozenDbg, intermediate_nodes_match_dbg)
+{
+    const auto dg = FrozenDbgTests::MakeGraph(11);
+    const auto frozen = dg.Freeze();
+
+    const uint32_t n = std::min<uint32_t>(frozen.NNodes(), 300);
+    for (uint32_t a = 0; a < n; ++a) {
+        for (uint32_t b = 0; b < n; ++b) {
+            uint64_t expectedShared = 0;
+            uint32_t shared = 0;
+            const bool expected =
+                dg.OneIntermediateNode(frozen.Kmer(a), frozen.Kmer(b), &expectedShared);
+            ASSERT_EQ(expected, frozen.OneIntermediateNode(a, b, &shared));
+            if (expected) {
+                EXPECT_EQ(expectedShared, frozen.Kmer(shared));
+            }
+        }
+    }
+}
+
+TEST(Pbmer_FrozenDbg, finds_bubbles_and_spurs)
+{
+    const PacBio::Pbmer::Parser parser{7};
+    const std::string td1{"CATACCAGCTTCCACAGACGGACGACAGATTGCAT"};
+    const std::string td2{"CATACCAGCTTCCACAGTCGGACGACAGATTGCAT"};
+    Pbmer::Dbg dg{7, 2};
+    dg.AddKmers(parser.Parse(td1), 1);
+    dg.AddKmers(parser.Parse(td2), 2);
+    dg.BuildEdges();
+
+    const auto frozen = dg.Freeze();
+    const auto bubbles = frozen.GetBubbles();
+    EXPECT_EQ(dg.GetBubbles(), bubbles);
+    EXPECT_EQ(2, bubbles.size());
+
+    // both ends of the reads are tips of linear paths
+    const auto spurs = frozen.GetSpurs(100);
+    EXPECT_EQ(2, spurs.size());
+    for (const auto& spur : spurs)
+        EXPECT_EQ(1, frozen.Degree(spur.front()));
+}
+
+TEST(Pbmer_FrozenDbg, parallel_bubbles_match_string_keyed_bubbles)
+{
+    const auto dg = FrozenDbgTests::MakeGraph(13);
+    const auto frozen = dg.Freeze();
+
+    const auto bubbles = frozen.FindBubbles();
+    ASSERT_FALSE(bubbles.empty());
+    for (size_t i = 1; i < bubbles.size(); ++i) {
+        const auto& a = bubbles[i - 1];
+        const auto& b = bubbles[i];
+        EXPECT_TRUE(std::tie(a.head, a.side, a.readId) < std::tie(b.head, b.side, b.readId));
+    }
+
+    // same content as the string keyed bubbles
+    Pbmer::BubbleInfo info;
+    for (const auto& support : bubbles) {
+        Pbmer::DnaBit head{support.head, 0, 13};
+        const char side = (support.side == Pbmer::BubbleSide::LEFT) ? 'L' : 'R';
+        info[head.KmerToStr() + side].emplace_back(support.readId, support.kmerCount,
+                                                   support.pathLength);
+    }
+    EXPECT_EQ(dg.GetBubbles(), info);
+
+    for (const size_t numThreads : {1, 3, 8}) {
+        Parallel::ThreadPool pool{numThreads};
+        EXPECT_EQ(bubbles, frozen.FindBubbles(pool));
+        EXPECT_EQ(bubbles, dg.FindBubbles(pool));
+    }
+}
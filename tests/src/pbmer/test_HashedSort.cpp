@@ -0,0 +1,135 @@
+#include <pbcopper/pbmer/HashedSort.h>
+
+#include <cstdint>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/parallel/ThreadPool.h>
+
+using namespace PacBio;
+
+namespace HashedSortTests {
+
+std::vector<Pbmer::DnaBit> RandomBits(const size_t n, const uint8_t kmerSize)
+{
+    std::mt19937_64 rng{23};
+    const uint64_t mask = (uint64_t{1} << (2 * kmerSize)) - 1;
+    std::vector<Pbmer::DnaBit> bits;
+    for (size_t i = 0; i < n; ++i) {
+        // some repeated kmers
+        const uint64_t mer = (i % 5 == 0 && i > 0) ? bits[i / 2].mer : (rng() & mask);
+        bits.emplace_back(mer, static_cast<uint8_t>(rng() % 2), kmerSize);
+    }
+    return bits;
+}
+
+std::vector<uint64_t> Mers(const std::vector<Pbmer::DnaBit>& bits)
+{
+    std::vector<uint64_t> result;
+    for (const auto& b : bits)
+        result.push_back(b.mer);
+    return result;
+}
+
+}  // namespace HashedSortTests
+
+TEST(Pbmer_HashedSort, sorts_dna_bits_as_std_sort)
+{
+    for (const uint8_t kmerSize : {5, 15, 31}) {
+        const auto bits = HashedSortTests::RandomBits(5000, kmerSize);
+        auto expected = bits;
+        std::sort(expected.begin(), expected.end());
+
+        auto serial = bits;
+        Pbmer::SortHashed(serial);
+        EXPECT_EQ(HashedSortTests::Mers(expected), HashedSortTests::Mers(serial));
+        EXPECT_TRUE(std::is_permutation(bits.begin(), bits.end(), serial.begin()));
+
+        for (const size_t numThreads : {1, 4}) {
+            Parallel::ThreadPool pool{numThreads};
+            auto parallel = bits;
+            Pbmer::SortHashed(parallel, pool);
+            EXPECT_EQ(HashedSortTests::Mers(expected), HashedSortTests::Mers(parallel));
+            EXPECT_TRUE(std::is_permutation(bits.begin(), bits.end(), parallel.begin()));
+        }
+    }
+}
+
+TEST(Pbmer_HashedSort, sorts_kmers_by_hash)
+{
+    const uint8_t kmerSize = 21;
+    std::vector<Pbmer::Kmer> kmers;
+    for (const auto& b : HashedSortTests::RandomBits(3000, kmerSize))
+        kmers.emplace_back(b.mer, static_cast<uint32_t>(kmers.size()), Data::Strand::FORWARD);
+
+    auto expected = kmers;
+    std::sort(expected.begin(), expected.end(), [&](const auto& a, const auto& b) {
+        return Pbmer::Mix64Masked(a.mer, kmerSize) < Pbmer::Mix64Masked(b.mer, kmerSize);
+    });
+    const auto mers = [](const std::vector<Pbmer::Kmer>& v) {
+        std::vector<uint64_t> result;
+        for (const auto& k : v)
+            result.push_back(k.mer);
+        return result;
+    };
+
+    auto serial = kmers;
+    Pbmer::SortHashed(serial, kmerSize);
+    EXPECT_EQ(mers(expected), mers(serial));
+
+    Parallel::ThreadPool pool{3};
+    auto parallel = kmers;
+    Pbmer::SortHashed(parallel, kmerSize, pool);
+    EXPECT_EQ(mers(expected), mers(parallel));
+    EXPECT_TRUE(std::is_permutation(kmers.begin(), kmers.end(), parallel.begin()));
+}
+
+TEST(Pbmer_HashedSort, canonicalizes_whole_vectors)
+{
+    const auto bits = HashedSortTests::RandomBits(2000, 17);
+    Parallel::ThreadPool pool{3};
+
+    auto expected = bits;
+    for (auto& b : expected)
+        b.MakeLexSmallerHashed();
+    auto serial = bits;
+    Pbmer::MakeLexSmallerHashed(serial);
+    EXPECT_EQ(expected, serial);
+    auto parallel = bits;
+    Pbmer::MakeLexSmallerHashed(parallel, pool);
+    EXPECT_EQ(expected, parallel);
+
+    auto expectedLex = bits;
+    for (auto& b : expectedLex)
+        b.MakeLexSmaller();
+    auto lex = bits;
+    Pbmer::MakeLexSmaller(lex);
+    EXPECT_EQ(expectedLex, lex);
+    lex = bits;
+    Pbmer::MakeLexSmaller(lex, pool);
+    EXPECT_EQ(expectedLex, lex);
+
+    // canonicalize and sort in one go
+    Pbmer::SortHashed(expected);
+    auto sorted = bits;
+    Pbmer::CanonicalSortHashed(sorted);
+    EXPECT_EQ(HashedSortTests::Mers(expected), HashedSortTests::Mers(sorted));
+    EXPECT_TRUE(std::is_permutation(expected.begin(), expected.end(), sorted.begin()));
+    sorted = bits;
+    Pbmer::CanonicalSortHashed(sorted, pool);
+    EXPECT_EQ(HashedSortTests::Mers(expected), HashedSortTests::Mers(sorted));
+}
+
+TEST(Pbmer_HashedSort, handles_empty_vectors)
+{
+    std::vector<Pbmer::DnaBit> bits;
+    Parallel::ThreadPool pool{2};
+    Pbmer::SortHashed(bits);
+    Pbmer::SortHashed(bits, pool);
+    Pbmer::CanonicalSortHashed(bits, pool);
+    EXPECT_TRUE(bits.empty());
+}
@@ -0,0 +1,172 @@
+#include <pbcopper/pbmer/KmerCounter.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/parallel/ThreadPool.h>
+#include <pbcopper/pbmer/Dbg.h>
+#include <pbcopper/pbmer/DnaBit.h>
+#include <pbcopper/pbmer/Parser.h>
+
+#include "PbmerTestUtils.h"
+
+using namespace PacBio;
+
+namespace KmerCounterTests {
+
+// reads with a few unknown bases
+std::vector<std::string> RandomReads(const size_t numReads)
+{
+    return PbmerTestUtils::RandomReads(numReads, 22, 2000, 200, false, "ACGTN");
+}
+
+std::map<uint64_t, uint32_t> NaiveCounts(const std::vector<std::string>& reads,
+                                         const uint8_t kmerSize)
+{
+    const Pbmer::Parser parser{kmerSize};
+    std::map<uint64_t, uint32_t> counts;
+    for (const auto& read : reads) {
+        for (const auto& x : parser.Parse(read).forward)
+            ++counts[std::min(x.mer, Pbmer::ReverseComp64(x.mer, kmerSize))];
+    }
+    return counts;
+}
+
+}  // namespace KmerCounterTests
+
+TEST(Pbmer_KmerCounter, counts_canonical_kmers)
+{
+    const auto reads = KmerCounterTests::RandomReads(50);
+    for (const uint8_t kmerSize : {1, 12, 21, 32}) {
+        const auto expected = KmerCounterTests::NaiveCounts(reads, kmerSize);
+
+        Pbmer::KmerCounter counter{kmerSize, 4};
+        for (const auto& read : reads)
+            counter.AddRead(read);
+
+        EXPECT_EQ(kmerSize, counter.KmerSize());
+        EXPECT_EQ(expected.size(), counter.NumDistinct());
+        uint64_t total = 0;
+        for (const auto& kv : expected) {
+            EXPECT_EQ(kv.second, counter.Count(kv.first));
+            total += kv.second;
+        }
+        EXPECT_EQ(total, counter.NumTotal());
+
+        const auto sorted = counter.SortedCounts();
+        EXPECT_EQ((std::vector<std::pair<uint64_t, uint32_t>>{expected.begin(), expected.end()}),
+                  sorted);
+    }
+}
+
+TEST(Pbmer_KmerCounter, parallel_counts_match_serial)
+{
+    const auto reads = KmerCounterTests::RandomReads(80);
+    Pbmer::KmerCounter serial{17};
+    for (const auto& read : reads)
+        serial.AddRead(read);
+
+    for (const size_t numThreads : {1, 3, 8}) {
+        Parallel::ThreadPool pool{numThreads};
+        Pbmer::KmerCounter parallel{17};
+        // two batches, the second adding to the counts of the first
+        parallel.AddReads({reads.begin(), reads.begin() + 30}, pool);
+        parallel.AddReads({reads.begin() + 30, reads.end()}, pool);
+        parallel.AddReads({}, pool);
+        EXPECT_EQ(serial.SortedCounts(), parallel.SortedCounts());
+
+        // rounds smaller than a read still count every read once
+        Pbmer::KmerCounter rounds{17};
+        rounds.AddReads(reads, pool, 1000);
+        EXPECT_EQ(serial.SortedCounts(), rounds.SortedCounts());
+    }
+}
+
+TEST(Pbmer_KmerCounter, matches_dbg_nodes)
+{
+    const auto reads = KmerCounterTests::RandomReads(40);
+    const Pbmer::Parser parser{21};
+    Pbmer::Dbg dg{21, 40};
+    Pbmer::KmerCounter counter{21};
+    for (size_t i = 0; i < reads.size(); ++i) {
+        dg.AddKmers(parser.Parse(reads[i]), i + 1);
+        counter.AddRead(reads[i]);
+    }
+    EXPECT_EQ(dg.NNodes(), counter.NumDistinct());
+}
+
+TEST(Pbmer_KmerCounter, computes_histogram)
+{
+    Pbmer::KmerCounter counter{3, 1};
+    counter.AddRead("AAAAAA");  // AAA x4
+    counter.AddRead("ACGT");    // ACG, CGT -> ACG x2
+    counter.AddRead("CCC");     // CCC x1
+
+    EXPECT_EQ((std::vector<uint64_t>{0, 1, 1, 0, 1}), counter.Histogram(4));
+    EXPECT_EQ((std::vector<uint64_t>{0, 1, 2}), counter.Histogram(2));
+    EXPECT_EQ(counter.Histogram(4), counter.Histogram(UINT32_MAX));
+    EXPECT_EQ(std::vector<uint64_t>{0}, Pbmer::KmerCounter{3}.Histogram());
+    EXPECT_THROW(counter.Histogram(0), std::invalid_argument);
+    EXPECT_EQ(3, counter.NumDistinct());
+    EXPECT_EQ(4, counter.Count(0));
+    EXPECT_EQ(0, counter.Count(63));
+
+    const auto solid = counter.SortedCounts(2);
+    ASSERT_EQ(2, solid.size());
+    EXPECT_EQ(0, solid[0].first);
+    EXPECT_EQ(4, solid[0].second);
+}
+
+TEST(Pbmer_KmerCounter, writes_sorted_counts)
+{
+    const std::string fn{"/tmp/pbcopper.pbmer.kmer-counts.bin"};
+    const auto reads = KmerCounterTests::RandomReads(20);
+    Pbmer::KmerCounter counter{15};
+    for (const auto& read : reads)
+        counter.AddRead(read);
+    counter.WriteSorted(fn, 2);
+
+    std::ifstream in{fn, std::ios::binary};
+    const std::string bytes{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+    std::remove(fn.c_str());
+
+    const auto expected = counter.SortedCounts(2);
+    ASSERT_EQ(24 + 12 * expected.size(), bytes.size());
+    EXPECT_EQ("PBMERKMC", bytes.substr(0, 8));
+    uint32_t version;
+    uint32_t kmerSize;
+    uint64_t numKmers;
+    std::memcpy(&version, bytes.data() + 8, 4);
+    std::memcpy(&kmerSize, bytes.data() + 12, 4);
+    std::memcpy(&numKmers, bytes.data() + 16, 8);
+    EXPECT_EQ(1, version);
+    EXPECT_EQ(15, kmerSize);
+    ASSERT_EQ(expected.size(), numKmers);
+    for (size_t i = 0; i < numKmers; ++i) {
+        uint64_t kmer;
+        uint32_t count;
+        std::memcpy(&kmer, bytes.data() + 24 + 8 * i, 8);
+        std::memcpy(&count, bytes.data() + 24 + 8 * numKmers + 4 * i, 4);
+        EXPECT_EQ(expected[i].first, kmer);
+        EXPECT_EQ(expected[i].second, count);
+    }
+
+    EXPECT_THROW(counter.WriteSorted("/nonexistent/dir/counts.bin"), std::runtime_error);
+}
+
+TEST(Pbmer_KmerCounter, throws_on_invalid_kmer_size)
+{
+    EXPECT_THROW(Pbmer::KmerCounter{0}, std::invalid_argument);
+    EXPECT_THROW(Pbmer::KmerCounter{33}, std::invalid_argument);
+}
@@ -0,0 +1,108 @@
+#include <pbcopper/pbmer/KmerSketch.h>
+
+#include <cstdint>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/pbmer/DnaBit.h>
+#include <pbcopper/pbmer/Parser.h>
+
+using namespace PacBio;
+
+TEST(Pbmer_KmerSketch, sizes_rows_to_memory)
+{
+    const Pbmer::KmerSketch sketch{1000, 2};
+    EXPECT_EQ(256, sketch.Width());
+    EXPECT_EQ(2, sketch.Depth());
+    EXPECT_EQ(512, sketch.MemoryUsage());
+
+    const Pbmer::KmerSketch tiny{0, 4};
+    EXPECT_EQ(64, tiny.Width());
+
+    EXPECT_THROW(Pbmer::KmerSketch(1000, 0), std::invalid_argument);
+    EXPECT_THROW(Pbmer::KmerSketch(1000, 9), std::invalid_argument);
+}
+
+TEST(Pbmer_KmerSketch, never_underestimates)
+{
+    // small sketch, for many collisions
+    Pbmer::KmerSketch sketch{4096, 4};
+    std::unordered_map<uint64_t, int> counts;
+    std::mt19937_64 rng{19};
+    for (int i = 0; i < 20000; ++i) {
+        const uint64_t kmer = rng() % 5000;
+        sketch.Add(kmer);
+        ++counts[kmer];
+    }
+
+    int exact = 0;
+    for (const auto& kv : counts) {
+        const int expected = std::min(kv.second, int{Pbmer::KmerSketch::MaxCount});
+        EXPECT_GE(sketch.Count(kv.first), expected);
+        exact += (sketch.Count(kv.first) == expected);
+    }
+    EXPECT_GT(exact, 0);
+}
+
+TEST(Pbmer_KmerSketch, counts_exactly_without_collisions)
+{
+    Pbmer::KmerSketch sketch{1 << 20};
+    for (uint64_t kmer = 0; kmer < 100; ++kmer) {
+        for (uint64_t n = 0; n < kmer % 7; ++n)
+            sketch.Add(kmer * 0x1234567);
+    }
+    for (uint64_t kmer = 0; kmer < 100; ++kmer)
+        EXPECT_EQ(kmer % 7, sketch.Count(kmer * 0x1234567));
+
+    sketch.Clear();
+    EXPECT_EQ(0, sketch.Count(6 * 0x1234567));
+}
+
+TEST(Pbmer_KmerSketch, saturates)
+{
+    Pbmer::KmerSketch sketch{1024};
+    for (int i = 0; i < 1000; ++i)
+        sketch.Add(42);
+    EXPECT_EQ(Pbmer::KmerSketch::MaxCount, sketch.Count(42));
+
+    Pbmer::KmerSketch other{1024};
+    other.Add(42);
+    sketch.Merge(other);
+    EXPECT_EQ(Pbmer::KmerSketch::MaxCount, sketch.Count(42));
+}
+
+TEST(Pbmer_KmerSketch, merges_counts)
+{
+    Pbmer::KmerSketch a{1 << 16};
+    Pbmer::KmerSketch b{1 << 16};
+    a.Add(1);
+    a.Add(2);
+    b.Add(2);
+    b.Add(3);
+    a.Merge(b);
+    EXPECT_EQ(1, a.Count(1));
+    EXPECT_EQ(2, a.Count(2));
+    EXPECT_EQ(1, a.Count(3));
+
+    const Pbmer::KmerSketch shallow{1 << 16, 2};
+    EXPECT_THROW(a.Merge(shallow), std::invalid_argument);
+}
+
+TEST(Pbmer_KmerSketch, counts_kmers_on_both_strands_together)
+{
+    const Pbmer::Parser parser{11};
+    Pbmer::KmerSketch sketch{1 << 16};
+    sketch.AddKmers(parser.Parse("ACGTTGCATGTCGCATGATGCATGAGAGCT"));
+    sketch.AddKmers(parser.Parse("AGCTCTCATGCATCATGCGACATGCAACGT"));
+
+    const auto m = parser.Parse("ACGTTGCATGTCGCATGATGCATGAGAGCT");
+    for (const auto& x : m.forward) {
+        const uint64_t canonical = std::min(x.mer, Pbmer::ReverseComp64(x.mer, 11));
+        EXPECT_EQ(2, sketch.Count(canonical));
+    }
+}
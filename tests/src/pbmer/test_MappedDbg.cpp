@@ -0,0 +1,152 @@
+#include <pbcopper/pbmer/MappedDbg.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/pbmer/Dbg.h>
+
+#include "PbmerTestUtils.h"
+
+using namespace PacBio;
+
+namespace MappedDbgTests {
+
+const std::string GraphFn{"/tmp/pbcopper.pbmer.mapped-dbg.bin"};
+
+Pbmer::Dbg MakeGraph(const uint8_t kmerSize, const uint32_t nReads)
+{
+    return PbmerTestUtils::MakeGraph(kmerSize, nReads, 18);
+}
+
+}  // namespace MappedDbgTests
+
+TEST(Pbmer_MappedDbg, maps_graph_written_by_dbg)
+{
+    // enough reads for some dense read id sets
+    const auto dg = MappedDbgTests::MakeGraph(15, 200);
+    dg.WriteBinary(MappedDbgTests::GraphFn);
+    const Pbmer::MappedDbg mapped{MappedDbgTests::GraphFn};
+    const auto frozen = dg.Freeze();
+
+    EXPECT_EQ(15, mapped.KmerSize());
+    EXPECT_EQ(200, mapped.NReads());
+    EXPECT_EQ(dg.NNodes(), mapped.NNodes());
+    EXPECT_EQ(dg.NEdges(), mapped.NEdges());
+
+    for (uint32_t fid = 0; fid < frozen.NNodes(); ++fid) {
+        const uint32_t id = mapped.Id(frozen.Kmer(fid));
+        ASSERT_NE(Pbmer::MappedDbg::NoNode, id);
+        EXPECT_EQ(frozen.Kmer(fid), mapped.Kmer(id));
+        EXPECT_EQ(frozen.Dna(fid), mapped.Dna(id));
+        EXPECT_EQ(frozen.Degree(fid), mapped.Degree(id));
+
+        const auto readIds = mapped.ReadIds(id);
+        EXPECT_EQ(frozen.ReadIds(fid).Ids(), std::vector<uint32_t>(readIds.begin(), readIds.end()));
+        EXPECT_EQ(frozen.ReadCount(fid), mapped.ReadCount(id));
+
+        std::array<uint64_t, 8> neighbors;
+        const int n = mapped.Neighbors(id, neighbors);
+        ASSERT_EQ(frozen.Degree(fid), n);
+        int i = 0;
+        for (const uint32_t y : frozen.Neighbors(fid))
+            EXPECT_EQ(frozen.Kmer(y), neighbors[i++]);
+    }
+
+    for (uint32_t id = 1; id < mapped.NNodes(); ++id)
+        EXPECT_LT(mapped.Kmer(id - 1), mapped.Kmer(id));
+    EXPECT_EQ(Pbmer::MappedDbg::NoNode, mapped.Id(~uint64_t{0}));
+
+    std::remove(MappedDbgTests::GraphFn.c_str());
+}
+
+TEST(Pbmer_MappedDbg, loads_back_into_dbg)
+{
+    auto dg = MappedDbgTests::MakeGraph(21, 20);
+    dg.WriteBinary(MappedDbgTests::GraphFn);
+
+    Pbmer::MappedDbg mapped{MappedDbgTests::GraphFn};
+    const Pbmer::MappedDbg moved{std::move(mapped)};
+    Pbmer::Dbg loaded{moved};
+    std::remove(MappedDbgTests::GraphFn.c_str());
+
+    EXPECT_EQ(dg.NNodes(), loaded.NNodes());
+    EXPECT_EQ(dg.NEdges(), loaded.NEdges());
+    EXPECT_TRUE(loaded.ValidateLoad());
+    EXPECT_TRUE(loaded.ValidateEdges());
+    EXPECT_EQ(PbmerTestUtils::SortedDotLines(dg), PbmerTestUtils::SortedDotLines(loaded));
+    EXPECT_EQ(dg.GetBubbles(), loaded.GetBubbles());
+}
+
+TEST(Pbmer_MappedDbg, maps_empty_graph)
+{
+    const Pbmer::Dbg dg{11, 0};
+    dg.WriteBinary(MappedDbgTests::GraphFn);
+    const Pbmer::MappedDbg mapped{MappedDbgTests::GraphFn};
+    std::remove(MappedDbgTests::GraphFn.c_str());
+
+    EXPECT_EQ(0, mapped.NNodes());
+    EXPECT_EQ(0, mapped.NEdges());
+    EXPECT_EQ(Pbmer::MappedDbg::NoNode, mapped.Id(0));
+}
+
+TEST(Pbmer_MappedDbg, throws_on_invalid_file)
+{
+    EXPECT_THROW(Pbmer::MappedDbg{"/nonexistent/dir/graph.bin"}, std::runtime_error);
+
+    {
+        std::ofstream out{MappedDbgTests::GraphFn};
+        out << std::string(64, 'x');
+    }
+    EXPECT_THROW(Pbmer::MappedDbg{MappedDbgTests::GraphFn}, std::runtime_error);
+
+    // truncated
+    MappedDbgTests::MakeGraph(11, 5).WriteBinary(MappedDbgTests::GraphFn);
+    std::string bytes;
+    {
+        std::ifstream in{MappedDbgTests::GraphFn, std::ios::binary};
+        bytes.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+    }
+    {
+        std::ofstream out{MappedDbgTests::GraphFn, std::ios::binary};
+        out.write(bytes.data(), bytes.size() - 8);
+    }
+    EXPECT_THROW(Pbmer::MappedDbg{MappedDbgTests::GraphFn}, std::runtime_error);
+
+    // corrupt header fields and read offsets, at the right file size
+    uint64_t nNodes = 0;
+    uint64_t nReadIds = 0;
+    std::memcpy(&nNodes, bytes.data() + 24, sizeof(nNodes));
+    std::memcpy(&nReadIds, bytes.data() + 32, sizeof(nReadIds));
+    ASSERT_GT(nNodes, 2);
+    const auto expectCorrupt = [&](const size_t offset, const auto value) {
+        std::string corrupt = bytes;
+        std::memcpy(&corrupt[offset], &value, sizeof(value));
+        {
+            std::ofstream out{MappedDbgTests::GraphFn, std::ios::binary};
+            out.write(corrupt.data(), corrupt.size());
+        }
+        EXPECT_THROW(Pbmer::MappedDbg{MappedDbgTests::GraphFn}, std::runtime_error);
+    };
+    expectCorrupt(12, uint32_t{0});
+    expectCorrupt(12, uint32_t{33});
+    expectCorrupt(24, uint64_t{1} << 61);
+    expectCorrupt(32, ~uint64_t{0} / 4 + 1);
+    const size_t readOffsets = 40 + 8 * nNodes;
+    expectCorrupt(readOffsets, uint64_t{1});
+    expectCorrupt(readOffsets + 8, nReadIds + 1000);
+    std::remove(MappedDbgTests::GraphFn.c_str());
+
+    const Pbmer::Dbg dg{11, 0};
+    EXPECT_THROW(dg.WriteBinary("/nonexistent/dir/graph.bin"), std::runtime_error);
+}
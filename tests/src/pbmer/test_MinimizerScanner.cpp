@@ -0,0 +1,102 @@
+#include <pbcopper/pbmer/MinimizerScanner.h>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/pbmer/Mers.h>
+#include <pbcopper/pbmer/Parser.h>
+
+using namespace PacBio;
+
+namespace MinimizerScannerTests {
+
+Pbmer::Mers ThreePassMinimizers(const std::string& dna, const uint8_t k, const unsigned int w)
+{
+    Pbmer::Mers mers = Pbmer::Parser{k}.Parse(dna);
+    mers.HashKmers();
+    mers.WindowMin(w);
+    return mers;
+}
+
+std::string RandomDna(std::mt19937& rng, const size_t size, const std::string& alphabet)
+{
+    std::uniform_int_distribution<size_t> dist{0, alphabet.size() - 1};
+    std::string dna(size, 'A');
+    for (auto& c : dna)
+        c = alphabet[dist(rng)];
+    return dna;
+}
+
+}  // namespace MinimizerScannerTests
+
+TEST(Pbmer_MinimizerScanner, matches_parse_hash_and_window_min)
+{
+    std::mt19937 rng{11};
+    // low-complexity alphabets produce many ties and palindromes
+    for (const std::string alphabet : {"ACGT", "ACGTACGTACGTN", "AT", "AAAAAAAC"}) {
+        for (const uint8_t k : {3, 6, 15, 21}) {
+            for (const unsigned int w : {1, 2, 3, 7, 10, 50}) {
+                for (const size_t size : {21, 60, 200, 1500}) {
+                    if (size < k) continue;
+                    const std::string dna = MinimizerScannerTests::RandomDna(rng, size, alphabet);
+                    const auto expected = MinimizerScannerTests::ThreePassMinimizers(dna, k, w);
+                    const auto actual = Pbmer::MinimizerScanner{k, w}.Minimizers(dna);
+                    EXPECT_EQ(expected.minimizers, actual) << "k=" << int{k} << " w=" << w
+                                                           << " dna=" << dna;
+                }
+            }
+        }
+    }
+}
+
+TEST(Pbmer_MinimizerScanner, window_larger_than_sequence_gives_global_minima)
+{
+    const std::string dna{"ACGACCCTGAGCCCCCAGAGTCATCTAAAAAAATTCTCTCAACGCTCTCT"};
+    const auto expected = MinimizerScannerTests::ThreePassMinimizers(dna, 16, 100);
+    EXPECT_EQ(expected.minimizers, Pbmer::MinimizerScanner(16, 100).Minimizers(dna));
+}
+
+TEST(Pbmer_MinimizerScanner, nmps_match_build_nmps)
+{
+    std::mt19937 rng{5};
+    for (const unsigned int w : {1, 5, 12}) {
+        const std::string dna = MinimizerScannerTests::RandomDna(rng, 2000, "ACGTACGTN");
+        const auto expected = MinimizerScannerTests::ThreePassMinimizers(dna, 15, w).BuildNMPs();
+
+        std::vector<Pbmer::Kmer> actual;
+        Pbmer::MinimizerScanner{15, w}.ForEachNmp(
+            dna, [&actual](const Pbmer::Kmer& nmp, const Pbmer::Kmer&, const Pbmer::Kmer&) {
+                actual.push_back(nmp);
+            });
+        EXPECT_EQ(expected, actual);
+    }
+}
+
+TEST(Pbmer_MinimizerScanner, appends_to_buffer)
+{
+    const Pbmer::MinimizerScanner scanner{6, 3};
+    const std::string dna{"ACGACCCTGAGCACTAC"};
+    const auto once = scanner.Minimizers(dna);
+
+    std::vector<Pbmer::Kmer> buffer;
+    scanner.Minimizers(dna, buffer);
+    scanner.Minimizers(dna, buffer);
+    ASSERT_EQ(2 * once.size(), buffer.size());
+    EXPECT_TRUE(std::equal(once.cbegin(), once.cend(), buffer.cbegin() + once.size()));
+}
+
+TEST(Pbmer_MinimizerScanner, throws_on_invalid_input)
+{
+    EXPECT_THROW(Pbmer::MinimizerScanner(16, 0), std::runtime_error);
+    EXPECT_THROW(Pbmer::MinimizerScanner(0, 5), std::runtime_error);
+    EXPECT_THROW(Pbmer::MinimizerScanner(16, 5).Minimizers("ACGT"), std::runtime_error);
+    EXPECT_THROW(Pbmer::MinimizerScanner(17, 5).ForEachNmp(
+                     std::string(100, 'A'),
+                     [](const Pbmer::Kmer&, const Pbmer::Kmer&, const Pbmer::Kmer&) {}),
+                 std::runtime_error);
+}
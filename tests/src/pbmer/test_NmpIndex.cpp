@@ -0,0 +1,118 @@
+#include <pbcopper/pbmer/NmpIndex.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/pbmer/MinimizerScanner.h>
+
+#include "PbmerTestUtils.h"
+
+using namespace PacBio;
+
+namespace NmpIndexTests {
+
+// read 1 overlaps read 0 by 1000 bp, read 2 is the reverse complement of
+// its middle, read 3 is unrelated
+std::vector<std::string> Reads()
+{
+    const std::string genome = PbmerTestUtils::RandomDna(3000, 24);
+    return {genome.substr(0, 2000), genome.substr(1000, 2000),
+            PbmerTestUtils::ReverseComplement(genome.substr(500, 2000)),
+            PbmerTestUtils::RandomDna(2000, 25)};
+}
+
+}  // namespace NmpIndexTests
+
+TEST(Pbmer_NmpIndex, finds_overlapping_reads_on_both_strands)
+{
+    const auto reads = NmpIndexTests::Reads();
+    Pbmer::NmpIndex index{15, 10};
+    for (size_t i = 0; i < reads.size(); ++i)
+        index.AddRead(i, reads[i]);
+    EXPECT_EQ(0, index.NumNmps());
+    index.Build();
+    EXPECT_EQ(0, index.NumPending());
+
+    size_t numNmps = 0;
+    for (const auto& read : reads)
+        Pbmer::MinimizerScanner{15, 10}.ForEachNmp(
+            read, [&](const Pbmer::Kmer&, const Pbmer::Kmer&, const Pbmer::Kmer&) { ++numNmps; });
+    EXPECT_EQ(numNmps, index.NumNmps());
+    EXPECT_LE(index.NumKeys(), index.NumNmps());
+
+    const auto candidates = index.Query(reads[0], 5, 0);
+    ASSERT_EQ(2, candidates.size());
+
+    EXPECT_EQ(1, candidates[0].readId);
+    EXPECT_EQ(Data::Strand::FORWARD, candidates[0].strand);
+    EXPECT_EQ(1000, candidates[0].diagonal);
+    EXPECT_GT(candidates[0].count, 50);
+
+    // kmer at genome offset x is at 1-based x + 1 in read 0, and at
+    // 2000 - (x - 500) - 15 + 1 in read 2
+    EXPECT_EQ(2, candidates[1].readId);
+    EXPECT_EQ(Data::Strand::REVERSE, candidates[1].strand);
+    EXPECT_EQ(2487, candidates[1].diagonal);
+    EXPECT_GT(candidates[1].count, 100);
+
+    // self hits are kept unless excluded
+    const auto withSelf = index.Query(reads[0], 5);
+    ASSERT_EQ(3, withSelf.size());
+    EXPECT_EQ(0, withSelf[0].readId);
+    EXPECT_EQ(0, withSelf[0].diagonal);
+
+    EXPECT_TRUE(index.Query(reads[3], 5, 3).empty());
+    EXPECT_TRUE(index.Query("ACGT", 1).empty());
+}
+
+TEST(Pbmer_NmpIndex, parallel_and_incremental_builds_match_serial)
+{
+    const auto reads = NmpIndexTests::Reads();
+    Pbmer::NmpIndex serial{13, 8};
+    for (size_t i = 0; i < reads.size(); ++i)
+        serial.AddRead(i, reads[i]);
+    serial.Build();
+
+    Parallel::ThreadPool pool{3};
+    Pbmer::NmpIndex parallel{13, 8};
+    parallel.AddReads(reads, pool);
+    parallel.Build(pool);
+
+    Pbmer::NmpIndex incremental{13, 8};
+    incremental.AddReads({reads[0], reads[1]}, pool);
+    incremental.Build();
+    incremental.AddReads({reads[2], reads[3]}, pool, 2);
+    EXPECT_LT(0, incremental.NumPending());
+    incremental.Build(pool);
+
+    EXPECT_EQ(serial.NumKeys(), parallel.NumKeys());
+    EXPECT_EQ(serial.NumNmps(), incremental.NumNmps());
+    for (size_t i = 0; i < reads.size(); ++i) {
+        const auto expected = serial.Query(reads[i], 1, i);
+        EXPECT_EQ(expected, parallel.Query(reads[i], 1, i));
+        EXPECT_EQ(expected, incremental.Query(reads[i], 1, i));
+    }
+}
+
+TEST(Pbmer_NmpIndex, skips_repeated_nmps)
+{
+    const std::string read = PbmerTestUtils::RandomDna(1000, 26);
+    Pbmer::NmpIndex index{15, 10};
+    for (uint32_t i = 0; i < 5; ++i)
+        index.AddRead(i, read);
+    index.Build();
+
+    EXPECT_EQ(5 * index.NumKeys(), index.NumNmps());
+    EXPECT_EQ(4, index.Query(read, 1, 0, 0).size());
+    EXPECT_EQ(4, index.Query(read, 1, 0, 5).size());
+    EXPECT_TRUE(index.Query(read, 1, 0, 4).empty());
+}
+
+TEST(Pbmer_NmpIndex, throws_on_large_kmer_size)
+{
+    EXPECT_THROW(Pbmer::NmpIndex(17, 10), std::runtime_error);
+    EXPECT_THROW(Pbmer::NmpIndex(15, 0), std::runtime_error);
+}
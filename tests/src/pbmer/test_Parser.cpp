@@ -1,4 +1,8 @@
+#include <cctype>
 #include <iostream>
+#include <random>
+#include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -41,6 +45,101 @@ TEST(Pbmer_Parser, compare_dnabit_parser)
     }
 }
 
+namespace ParserTests {
+
+// One base at a time, as the parser originally did
+PacBio::Pbmer::Mers ReferenceParse(const std::string& dna, const uint8_t k)
+{
+    const uint64_t mask = (1ull << 2 * k) - 1;
+    PacBio::Pbmer::Mers kms{k};
+    PacBio::Pbmer::Kmer forward{PacBio::Data::Strand::FORWARD};
+    PacBio::Pbmer::Kmer reverse{PacBio::Data::Strand::REVERSE};
+    int lk = 0;
+    for (const auto d : dna) {
+        const uint8_t c = PacBio::Pbmer::AsciiToDna[static_cast<unsigned char>(d)];
+        if (c < 4) {
+            forward.mer = (forward.mer << 2 | c) & mask;
+            reverse.mer = (reverse.mer >> 2) | (3ull ^ c) << 2 * (k - 1);
+            ++lk;
+        } else {
+            lk = 0;
+            forward.mer = 0;
+            reverse.mer = 0;
+            forward.pos += k;
+            reverse.pos += k;
+        }
+        if (lk >= k) {
+            kms.AddKmer(forward);
+            kms.AddKmer(reverse);
+            ++forward.pos;
+            ++reverse.pos;
+        }
+    }
+    return kms;
+}
+
+std::string RandomDna(std::mt19937& rng, const size_t size)
+{
+    // mostly ACGT, some lower case, unknown and raw 0-3 bases
+    static const std::string alphabet{"ACGTACGTACGTACGTACGTACGTacgtNn-\x02"};
+    std::uniform_int_distribution<size_t> dist{0, alphabet.size() - 1};
+    std::string dna(size, 'A');
+    for (auto& c : dna)
+        c = alphabet[dist(rng)];
+    return dna;
+}
+
+}  // namespace ParserTests
+
+TEST(Pbmer_Parser, bulk_parse_matches_base_by_base_parse)
+{
+    std::mt19937 rng{7};
+    for (const uint8_t k : {1, 5, 11, 16, 21, 31}) {
+        const PacBio::Pbmer::Parser parser{k};
+        for (const size_t size : {31, 63, 64, 65, 127, 128, 200, 1000}) {
+            if (size < k) continue;
+            const std::string dna = ParserTests::RandomDna(rng, size);
+            const auto expected = ParserTests::ReferenceParse(dna, k);
+            const auto mers = parser.Parse(dna);
+            EXPECT_EQ(expected.forward, mers.forward) << "k=" << int{k} << " dna=" << dna;
+            EXPECT_EQ(expected.reverse, mers.reverse) << "k=" << int{k} << " dna=" << dna;
+
+            const auto dnaBits = parser.ParseDnaBit(dna);
+            ASSERT_EQ(expected.forward.size(), dnaBits.size());
+            for (size_t i = 0; i < dnaBits.size(); ++i) {
+                EXPECT_EQ(expected.forward[i].mer, dnaBits[i].mer);
+                EXPECT_EQ(k, dnaBits[i].msize);
+            }
+        }
+    }
+}
+
+TEST(Pbmer_Parser, lower_case_and_upper_case_give_same_kmers)
+{
+    const PacBio::Pbmer::Parser parser{15};
+    std::string upper;
+    for (int i = 0; i < 40; ++i)
+        upper += "ACGTTGCA";
+    std::string lower = upper;
+    for (auto& c : lower)
+        c = static_cast<char>(std::tolower(c));
+
+    const auto expected = parser.ParseDnaBit(upper);
+    const auto actual = parser.ParseDnaBit(lower);
+    ASSERT_EQ(upper.size() - 15 + 1, actual.size());
+    for (size_t i = 0; i < actual.size(); ++i)
+        EXPECT_EQ(expected[i].mer, actual[i].mer);
+}
+
+TEST(Pbmer_Parser, parse_dnabit_appends_to_vector)
+{
+    const PacBio::Pbmer::Parser parser{4};
+    std::vector<PacBio::Pbmer::DnaBit> kms;
+    parser.ParseDnaBit("ACGTA", kms);
+    parser.ParseDnaBit("ACGNACGT", kms);
+    EXPECT_EQ(3, kms.size());
+}
+
 TEST(Pbmer_Parser, test_RLE_size_a)
 {
     const PacBio::Pbmer::Parser parser{16};
@@ -0,0 +1,104 @@
+#include <pbcopper/pbmer/ReadIdSet.h>
+
+#include <cstdint>
+
+#include <random>
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace PacBio;
+
+namespace ReadIdSetTests {
+
+std::vector<uint32_t> RandomIds(std::mt19937& rng, const size_t n, const uint32_t maxId)
+{
+    std::uniform_int_distribution<uint32_t> dist{0, maxId};
+    std::vector<uint32_t> ids(n);
+    for (auto& id : ids)
+        id = dist(rng);
+    return ids;
+}
+
+}  // namespace ReadIdSetTests
+
+TEST(Pbmer_ReadIdSet, empty_set)
+{
+    const Pbmer::ReadIdSet set;
+    EXPECT_EQ(0, set.Count());
+    EXPECT_FALSE(set.Contains(0));
+    EXPECT_FALSE(set.IsDense());
+    EXPECT_TRUE(set.Ids().empty());
+}
+
+TEST(Pbmer_ReadIdSet, insert_matches_std_set)
+{
+    std::mt19937 rng{3};
+    for (const size_t n : {1, 10, 100, 2000, 20000}) {
+        Pbmer::ReadIdSet set;
+        std::set<uint32_t> expected;
+        for (const uint32_t id : ReadIdSetTests::RandomIds(rng, n, 5000))
+            EXPECT_EQ(expected.insert(id).second, set.Insert(id));
+
+        EXPECT_EQ(expected.size(), set.Count());
+        EXPECT_EQ(std::vector<uint32_t>(expected.cbegin(), expected.cend()), set.Ids());
+        for (uint32_t id = 0; id <= 5100; ++id)
+            EXPECT_EQ(expected.count(id) == 1, set.Contains(id));
+    }
+}
+
+TEST(Pbmer_ReadIdSet, stays_sparse_for_few_reads)
+{
+    Pbmer::ReadIdSet set;
+    for (const uint32_t id : {49999u, 7u, 12000u, 30000u})
+        set.Insert(id);
+    EXPECT_FALSE(set.IsDense());
+    EXPECT_EQ(4, set.Count());
+    EXPECT_EQ((std::vector<uint32_t>{7, 12000, 30000, 49999}), set.Ids());
+    EXPECT_LT(set.MemoryUsage(), 64);
+}
+
+TEST(Pbmer_ReadIdSet, becomes_dense_for_many_reads)
+{
+    Pbmer::ReadIdSet set;
+    for (uint32_t id = 0; id < 50000; id += 2)
+        set.Insert(id);
+    EXPECT_TRUE(set.IsDense());
+    EXPECT_EQ(25000, set.Count());
+    EXPECT_LE(set.MemoryUsage(), 2 * 50000 / 8);
+    EXPECT_TRUE(set.Contains(49998));
+    EXPECT_FALSE(set.Contains(49999));
+
+    set.Clear();
+    EXPECT_EQ(0, set.Count());
+    EXPECT_FALSE(set.IsDense());
+    EXPECT_EQ(0, set.MemoryUsage());
+}
+
+TEST(Pbmer_ReadIdSet, union_of_sparse_and_dense_sets)
+{
+    std::mt19937 rng{7};
+    for (const size_t lhsSize : {0, 5, 3000}) {
+        for (const size_t rhsSize : {0, 5, 3000}) {
+            const auto lhsIds = ReadIdSetTests::RandomIds(rng, lhsSize, 10000);
+            const auto rhsIds = ReadIdSetTests::RandomIds(rng, rhsSize, 20000);
+
+            Pbmer::ReadIdSet lhs;
+            Pbmer::ReadIdSet rhs;
+            std::set<uint32_t> expected;
+            for (const uint32_t id : lhsIds) {
+                lhs.Insert(id);
+                expected.insert(id);
+            }
+            for (const uint32_t id : rhsIds) {
+                rhs.Insert(id);
+                expected.insert(id);
+            }
+
+            lhs |= rhs;
+            EXPECT_EQ(expected.size(), lhs.Count());
+            EXPECT_EQ(std::vector<uint32_t>(expected.cbegin(), expected.cend()), lhs.Ids());
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#include <pbcopper/pbmer/UnitigGraph.h>
+
+#include <cstdint>
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pbcopper/pbmer/Dbg.h>
+
+#include "PbmerTestUtils.h"
+
+using namespace PacBio;
+
+namespace UnitigGraphTests {
+
+Pbmer::UnitigGraph Compact(const std::vector<std::string>& reads, const uint8_t kmerSize)
+{
+    const Pbmer::Parser parser{kmerSize};
+    Pbmer::Dbg dg{kmerSize, static_cast<uint32_t>(reads.size())};
+    for (size_t i = 0; i < reads.size(); ++i)
+        dg.AddKmers(parser.Parse(reads[i]), i + 1);
+    dg.BuildEdges();
+    return dg.Compact();
+}
+
+size_t TotalKmers(const Pbmer::UnitigGraph& graph)
+{
+    size_t total = 0;
+    for (uint32_t id = 0; id < graph.NumUnitigs(); ++id)
+        total += graph.NumKmers(id);
+    return total;
+}
+
+}  // namespace UnitigGraphTests
+
+TEST(Pbmer_UnitigGraph, linear_read_is_one_unitig)
+{
+    const std::string read = PbmerTestUtils::RandomDna(300, 1);
+    const auto graph =
+        UnitigGraphTests::Compact({read, PbmerTestUtils::ReverseComplement(read)}, 21);
+
+    ASSERT_EQ(1, graph.NumUnitigs());
+    EXPECT_TRUE(graph.Links().empty());
+
+    const auto& unitig = graph.Unitigs().front();
+    EXPECT_TRUE(unitig.sequence == read ||
+                unitig.sequence == PbmerTestUtils::ReverseComplement(read));
+    EXPECT_EQ(280, graph.NumKmers(0));
+    EXPECT_EQ(2 * 280, unitig.kmerCoverage);
+    EXPECT_DOUBLE_EQ(2.0, graph.MeanCoverage(0));
+    EXPECT_EQ((std::vector<uint32_t>{0, 1}), unitig.readIds.Ids());
+}
+
+TEST(Pbmer_UnitigGraph, snp_gives_bubble_of_four_unitigs)
+{
+    const std::string ref = PbmerTestUtils::RandomDna(201, 2);
+    std::string alt = ref;
+    alt[100] = (ref[100] == 'A') ? 'C' : 'A';
+
+    const uint8_t k = 15;
+    const auto graph = UnitigGraphTests::Compact({ref, ref, alt}, k);
+    ASSERT_EQ(4, graph.NumUnitigs());
+    EXPECT_EQ(4, graph.Links().size());
+
+    std::vector<size_t> lengths;
+    for (const auto& unitig : graph.Unitigs())
+        lengths.push_back(unitig.sequence.size());
+    std::sort(lengths.begin(), lengths.end());
+    // both branches span the k kmers overlapping the SNP, the flanks the
+    // 100 bases on either side
+    EXPECT_EQ((std::vector<size_t>{2 * k - 1, 2 * k - 1, 100, 100}), lengths);
+
+    std::vector<uint32_t> support;
+    for (const auto& unitig : graph.Unitigs())
+        support.push_back(unitig.readIds.Count());
+    std::sort(support.begin(), support.end());
+    EXPECT_EQ((std::vector<uint32_t>{1, 2, 3, 3}), support);
+
+    // every link joins a branch to a flank
+    for (const auto& link : graph.Links()) {
+        const bool fromBranch = graph.NumKmers(link.from) == k;
+        const bool toBranch = graph.NumKmers(link.to) == k;
+        EXPECT_NE(fromBranch, toBranch);
+    }
+}
+
+TEST(Pbmer_UnitigGraph, every_kmer_is_in_one_unitig)
+{
+    const std::string genome = PbmerTestUtils::RandomDna(2000, 3);
+    std::vector<std::string> reads;
+    std::mt19937 rng{4};
+    for (int i = 0; i < 30; ++i) {
+        std::string read = genome.substr(rng() % 1700, 300);
+        read[rng() % read.size()] = "ACGT"[rng() % 4];
+        reads.push_back((i % 2 == 0) ? read : PbmerTestUtils::ReverseComplement(read));
+    }
+
+    const Pbmer::Parser parser{17};
+    Pbmer::Dbg dg{17, 30};
+    for (size_t i = 0; i < reads.size(); ++i)
+        dg.AddKmers(parser.Parse(reads[i]), i + 1);
+    dg.BuildEdges();
+    const auto graph = dg.Compact();
+
+    EXPECT_EQ(dg.NNodes(), UnitigGraphTests::TotalKmers(graph));
+    EXPECT_LT(graph.NumUnitigs(), dg.NNodes() / 10);
+    for (uint32_t id = 0; id < graph.NumUnitigs(); ++id)
+        EXPECT_GT(graph.MeanCoverage(id), 0.0);
+}
+
+TEST(Pbmer_UnitigGraph, cycle_is_one_unitig)
+{
+    const std::string circle = PbmerTestUtils::RandomDna(100, 5);
+    const std::string read = circle + circle.substr(0, 20);
+    const auto graph = UnitigGraphTests::Compact({read}, 21);
+
+    ASSERT_EQ(1, graph.NumUnitigs());
+    EXPECT_EQ(100, graph.NumKmers(0));
+    ASSERT_EQ(1, graph.Links().size());
+    EXPECT_EQ(0, graph.Links().front().from);
+    EXPECT_EQ(0, graph.Links().front().to);
+}
+
+TEST(Pbmer_UnitigGraph, writes_gfa)
+{
+    const std::string ref = PbmerTestUtils::RandomDna(101, 6);
+    std::string alt = ref;
+    alt[50] = (ref[50] == 'G') ? 'T' : 'G';
+    const auto graph = UnitigGraphTests::Compact({ref, alt}, 11);
+
+    std::ostringstream out;
+    graph.WriteGfa(out);
+
+    std::istringstream in{out.str()};
+    std::string line;
+    std::getline(in, line);
+    EXPECT_EQ("H\tVN:Z:1.0", line);
+
+    size_t numSegments = 0;
+    size_t numLinks = 0;
+    while (std::getline(in, line)) {
+        if (line.front() == 'S') {
+            const auto& unitig = graph.Unitigs().at(numSegments);
+            const std::string expected = "S\t" + std::to_string(numSegments) + '\t' +
+                                         unitig.sequence + "\tLN:i:" +
+                                         std::to_string(unitig.sequence.size());
+            EXPECT_EQ(0, line.find(expected));
+            ++numSegments;
+        } else {
+            EXPECT_EQ('L', line.front());
+            EXPECT_EQ("10M", line.substr(line.rfind('\t') + 1));
+            ++numLinks;
+        }
+    }
+    EXPECT_EQ(graph.NumUnitigs(), numSegments);
+    EXPECT_EQ(graph.Links().size(), numLinks);
+
+    EXPECT_THROW(graph.WriteGfa("/nonexistent/dir/graph.gfa"), std::runtime_error);
+}